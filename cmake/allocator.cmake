@@ -0,0 +1,96 @@
+# Runs the headless benchmark and the bridge benchmark with every allocator a Lua backend can allocate through.
+#
+# cmake -DGIRAFFE=<executable> -DBACKEND=<SCRIPT> -DGIRAFFES=10000 -DFRAMES=600 -DWARMUP=120 -DCALLS=100000 -DOUTPUT_DIR=<dir> -DRESULTS_DIR=<dir> -P allocator.cmake
+#
+# Lua 5.1 and Luau are run with the slab allocator and with the foundation allocator, LuaJIT with its own allocator.
+# The results are written to allocators.csv and allocators-bridge.csv in RESULTS_DIR, replacing the rows BACKEND had
+# there and keeping the other backends', so running it from a build of every backend puts them all in one table.
+
+foreach(variable GIRAFFE BACKEND GIRAFFES FRAMES WARMUP CALLS OUTPUT_DIR RESULTS_DIR)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "allocator.cmake needs -D${variable}")
+    endif()
+endforeach()
+
+if(BACKEND STREQUAL "LUAJIT")
+    set(allocators luajit)
+elseif(BACKEND STREQUAL "LUA51" OR BACKEND STREQUAL "LUAU")
+    set(allocators slab foundation)
+else()
+    message(FATAL_ERROR "allocator.cmake needs a Lua backend, got ${BACKEND}")
+endif()
+
+# Writes a table with the rows other backends had in it, and the new rows of BACKEND.
+function(replace_rows path header rows)
+    set(csv "${header}\n")
+    if(EXISTS "${path}")
+        file(STRINGS "${path}" lines)
+        foreach(line IN LISTS lines)
+            if(NOT line STREQUAL header AND NOT line MATCHES "^${BACKEND},")
+                string(APPEND csv "${line}\n")
+            endif()
+        endforeach()
+    endif()
+    string(APPEND csv "${rows}")
+    file(WRITE "${path}" "${csv}")
+endfunction()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+file(MAKE_DIRECTORY "${RESULTS_DIR}")
+
+set(frame_fields ns_per_frame p50_ns p99_ns allocations_per_frame bytes_per_frame peak_memory_bytes)
+set(frame_rows "")
+set(bridge_rows "")
+
+foreach(allocator IN LISTS allocators)
+    set(allocator_args "")
+    if(NOT allocator STREQUAL "luajit")
+        set(allocator_args --lua-allocator ${allocator})
+    endif()
+
+    set(report "${OUTPUT_DIR}/allocator-${BACKEND}-${allocator}.json")
+    message(STATUS "Allocator ${BACKEND}: ${allocator}, ${GIRAFFES} giraffes")
+    execute_process(
+        COMMAND "${GIRAFFE}" --headless ${allocator_args} --giraffes ${GIRAFFES} --frames ${FRAMES} --warmup ${WARMUP} --report "${report}"
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Allocator ${BACKEND}: ${allocator} failed with ${result}")
+    endif()
+
+    file(READ "${report}" run)
+    set(row "${BACKEND},${allocator},${GIRAFFES}")
+    foreach(field IN LISTS frame_fields)
+        string(JSON value GET "${run}" ${field})
+        string(APPEND row ",${value}")
+    endforeach()
+    string(APPEND frame_rows "${row}\n")
+
+    string(JSON p50_ns GET "${run}" p50_ns)
+    string(JSON allocations_per_frame GET "${run}" allocations_per_frame)
+    message(STATUS "Allocator ${BACKEND}: ${allocator} p50 ${p50_ns} ns, ${allocations_per_frame} allocations per frame")
+
+    set(bridge "${OUTPUT_DIR}/allocator-bridge-${BACKEND}-${allocator}.json")
+    message(STATUS "Allocator ${BACKEND}: ${allocator}, ${CALLS} calls to every primitive")
+    execute_process(
+        COMMAND "${GIRAFFE}" --headless ${allocator_args} --giraffes 1 --bridge-calls ${CALLS} --bridge-bench "${bridge}"
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Allocator ${BACKEND}: ${allocator} bridge benchmark failed with ${result}")
+    endif()
+
+    file(READ "${bridge}" bench)
+    string(JSON count LENGTH "${bench}" primitives)
+    if(count GREATER 0)
+        math(EXPR last "${count} - 1")
+        foreach(index RANGE ${last})
+            string(JSON primitive GET "${bench}" primitives ${index} primitive)
+            string(JSON net_ns_per_call GET "${bench}" primitives ${index} net_ns_per_call)
+            string(JSON allocations_per_call GET "${bench}" primitives ${index} allocations_per_call)
+            string(APPEND bridge_rows "${BACKEND},${allocator},${primitive},${net_ns_per_call},${allocations_per_call}\n")
+        endforeach()
+    endif()
+endforeach()
+
+replace_rows("${RESULTS_DIR}/allocators.csv" "backend,allocator,giraffes,ns_per_frame,p50_ns,p99_ns,allocations_per_frame,bytes_per_frame,peak_memory_bytes" "${frame_rows}")
+replace_rows("${RESULTS_DIR}/allocators-bridge.csv" "backend,allocator,primitive,net_ns_per_call,allocations_per_call" "${bridge_rows}")
+message(STATUS "Wrote ${RESULTS_DIR}/allocators.csv and ${RESULTS_DIR}/allocators-bridge.csv")
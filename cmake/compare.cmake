@@ -0,0 +1,266 @@
+# Reruns the scenarios of a baseline with one backend and fails when the frame times have regressed.
+#
+# cmake -DGIRAFFE=<executable> -DBACKEND=<SCRIPT> -DBASELINE=<json> -DOUTPUT_DIR=<dir> -DTHRESHOLD=5 -DZ=2.33 -P compare.cmake
+# cmake -DGIRAFFE=<executable> -DBACKEND=<SCRIPT> -DBASELINE=<json> -DOUTPUT_DIR=<dir> -DRECORD=ON -DGIRAFFES=1000,10000 -DFRAMES=600 -DWARMUP=120 -P compare.cmake
+#
+# The baseline holds every frame time of every scenario for every backend it was recorded with:
+#
+# {"scenarios":{"giraffes-1000":{"giraffes":1000,"frames":600,"warmup":120,"backends":{"LUA51":{"p50_ns":...,"frame_ns":[...]}}}}}
+#
+# With RECORD set, the scenarios are run and stored for BACKEND, keeping what other backends stored for the same
+# scenarios. Otherwise every scenario BACKEND has a baseline for is rerun, and its frame times are compared to the
+# baseline with a one sided Mann-Whitney U test. A scenario has regressed when the new frames are slower with a z score
+# of at least Z, and the median frame is more than THRESHOLD percent slower, so neither noise nor a significant but
+# negligible change fails the comparison.
+
+foreach(variable GIRAFFE BACKEND BASELINE OUTPUT_DIR)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "compare.cmake needs -D${variable}")
+    endif()
+endforeach()
+
+# A decimal number as an integer number of hundredths, "2.33" is 233.
+function(hundredths value result)
+    if(NOT value MATCHES "^([0-9]+)(\\.([0-9]?[0-9]?))?$")
+        message(FATAL_ERROR "compare.cmake expected a number with at most two decimals, got ${value}")
+    endif()
+    set(whole ${CMAKE_MATCH_1})
+    set(fraction "${CMAKE_MATCH_3}00")
+    string(SUBSTRING "${fraction}" 0 2 fraction)
+    string(REGEX REPLACE "^0(.)" "\\1" fraction "${fraction}")
+    math(EXPR value "${whole} * 100 + ${fraction}")
+    set(${result} ${value} PARENT_SCOPE)
+endfunction()
+
+# An integer number of hundredths as a decimal number, 233 is "2.33".
+function(decimal value result)
+    set(sign "")
+    if(value LESS 0)
+        set(sign "-")
+        math(EXPR value "-(${value})")
+    endif()
+    math(EXPR whole "${value} / 100")
+    math(EXPR fraction "${value} % 100")
+    if(fraction LESS 10)
+        set(fraction "0${fraction}")
+    endif()
+    set(${result} "${sign}${whole}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+# The largest integer whose square is at most value, with Newton's method.
+function(integer_sqrt value result)
+    if(value LESS 2)
+        set(${result} ${value} PARENT_SCOPE)
+        return()
+    endif()
+    set(x ${value})
+    math(EXPR y "(${x} + 1) / 2")
+    while(y LESS x)
+        set(x ${y})
+        math(EXPR y "(${x} + ${value} / ${x}) / 2")
+    endwhile()
+    set(${result} ${x} PARENT_SCOPE)
+endfunction()
+
+# The frame times of a report or a baseline entry as a sorted list.
+function(frame_samples json result)
+    string(JSON samples GET "${json}" frame_ns)
+    string(REGEX REPLACE "[][ \t\r\n]" "" samples "${samples}")
+    string(REPLACE "," ";" samples "${samples}")
+    list(SORT samples COMPARE NATURAL)
+    set(${result} "${samples}" PARENT_SCOPE)
+endfunction()
+
+# The middle value of a sorted list.
+function(sorted_median values result)
+    list(LENGTH values count)
+    math(EXPR middle "(${count} - 1) / 2")
+    list(GET values ${middle} value)
+    set(${result} ${value} PARENT_SCOPE)
+endfunction()
+
+# The Mann-Whitney z score of the current frames being slower than the baseline frames, in hundredths.
+#
+# U counts the pairs where the current frame is slower, with ties counting a half, so 2U is kept to stay in integers.
+# Both lists must be sorted. Ties don't correct the variance, they're rare with nanosecond frame times.
+function(mann_whitney_z baseline current result)
+    list(LENGTH baseline n1)
+    list(LENGTH current n2)
+
+    set(two_u 0)
+    set(below 0)
+    set(at_or_below 0)
+    foreach(sample IN LISTS current)
+        while(below LESS n1)
+            list(GET baseline ${below} value)
+            if(NOT value LESS sample)
+                break()
+            endif()
+            math(EXPR below "${below} + 1")
+        endwhile()
+        if(at_or_below LESS below)
+            set(at_or_below ${below})
+        endif()
+        while(at_or_below LESS n1)
+            list(GET baseline ${at_or_below} value)
+            if(value GREATER sample)
+                break()
+            endif()
+            math(EXPR at_or_below "${at_or_below} + 1")
+        endwhile()
+        math(EXPR two_u "${two_u} + ${below} + ${at_or_below}")
+    endforeach()
+
+    # z = (U - n1 n2 / 2) / sqrt(n1 n2 (n1 + n2 + 1) / 12)
+    math(EXPR sigma_squared "${n1} * ${n2} * (${n1} + ${n2} + 1) * 10000 / 12")
+    integer_sqrt(${sigma_squared} sigma)
+    if(sigma EQUAL 0)
+        set(${result} 0 PARENT_SCOPE)
+        return()
+    endif()
+    math(EXPR z "(${two_u} - ${n1} * ${n2}) * 5000 / ${sigma}")
+    set(${result} ${z} PARENT_SCOPE)
+endfunction()
+
+# Runs a scenario headless and returns its report.
+function(run_scenario name giraffes frames warmup result)
+    set(report "${OUTPUT_DIR}/compare-${BACKEND}-${name}.json")
+    message(STATUS "Compare ${BACKEND}: ${name}, ${giraffes} giraffes")
+
+    execute_process(
+        COMMAND "${GIRAFFE}" --headless --giraffes ${giraffes} --frames ${frames} --warmup ${warmup} --report "${report}"
+        RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "Compare ${BACKEND}: ${name} failed with ${status}")
+    endif()
+
+    file(READ "${report}" run)
+    string(STRIP "${run}" run)
+    set(${result} "${run}" PARENT_SCOPE)
+endfunction()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+set(baseline "{\"scenarios\":{}}")
+if(EXISTS "${BASELINE}")
+    file(READ "${BASELINE}" baseline)
+endif()
+
+if(RECORD)
+    foreach(variable GIRAFFES FRAMES WARMUP)
+        if(NOT DEFINED ${variable})
+            message(FATAL_ERROR "compare.cmake needs -D${variable} with -DRECORD=ON")
+        endif()
+    endforeach()
+
+    string(REPLACE "," ";" herd_sizes "${GIRAFFES}")
+    foreach(herd_size IN LISTS herd_sizes)
+        set(name "giraffes-${herd_size}")
+        run_scenario(${name} ${herd_size} ${FRAMES} ${WARMUP} run)
+
+        # A scenario run with other settings can't be compared with, so it starts over.
+        string(JSON scenario ERROR_VARIABLE missing GET "${baseline}" scenarios ${name})
+        if(NOT missing)
+            string(JSON stored_frames GET "${scenario}" frames)
+            string(JSON stored_warmup GET "${scenario}" warmup)
+            if(NOT stored_frames EQUAL FRAMES OR NOT stored_warmup EQUAL WARMUP)
+                message(STATUS "Compare ${BACKEND}: ${name} was recorded with other frames, replacing it for every backend")
+                set(missing ON)
+            endif()
+        endif()
+        if(missing)
+            string(JSON baseline SET "${baseline}" scenarios ${name}
+                "{\"giraffes\":${herd_size},\"frames\":${FRAMES},\"warmup\":${WARMUP},\"backends\":{}}")
+        endif()
+
+        set(entry "{}")
+        foreach(field p50_ns p99_ns ns_per_frame allocations_per_frame frame_ns)
+            string(JSON value GET "${run}" ${field})
+            string(JSON entry SET "${entry}" ${field} "${value}")
+        endforeach()
+        string(JSON baseline SET "${baseline}" scenarios ${name} backends ${BACKEND} "${entry}")
+    endforeach()
+
+    get_filename_component(baseline_dir "${BASELINE}" DIRECTORY)
+    file(MAKE_DIRECTORY "${baseline_dir}")
+    file(WRITE "${BASELINE}" "${baseline}\n")
+    message(STATUS "Recorded ${BACKEND} in ${BASELINE}")
+    return()
+endif()
+
+foreach(variable THRESHOLD Z)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "compare.cmake needs -D${variable}")
+    endif()
+endforeach()
+
+if(NOT EXISTS "${BASELINE}")
+    message(FATAL_ERROR "Compare ${BACKEND}: there's no baseline at ${BASELINE}, record one with the baseline target")
+endif()
+
+hundredths(${THRESHOLD} threshold)
+hundredths(${Z} z_threshold)
+
+set(compared 0)
+set(regressions "")
+set(csv "scenario,backend,baseline_p50_ns,p50_ns,change_percent,z,regressed\n")
+
+string(JSON scenario_count LENGTH "${baseline}" scenarios)
+if(scenario_count GREATER 0)
+    math(EXPR last "${scenario_count} - 1")
+    foreach(index RANGE ${last})
+        string(JSON name MEMBER "${baseline}" scenarios ${index})
+        string(JSON scenario GET "${baseline}" scenarios ${name})
+
+        string(JSON entry ERROR_VARIABLE missing GET "${scenario}" backends ${BACKEND})
+        if(missing)
+            message(STATUS "Compare ${BACKEND}: ${name} has no baseline for ${BACKEND}, skipping it")
+            continue()
+        endif()
+
+        string(JSON giraffes GET "${scenario}" giraffes)
+        string(JSON frames GET "${scenario}" frames)
+        string(JSON warmup GET "${scenario}" warmup)
+        run_scenario(${name} ${giraffes} ${frames} ${warmup} run)
+
+        frame_samples("${entry}" baseline_samples)
+        frame_samples("${run}" current_samples)
+        sorted_median("${baseline_samples}" baseline_p50)
+        sorted_median("${current_samples}" current_p50)
+        mann_whitney_z("${baseline_samples}" "${current_samples}" z)
+
+        # The change of the median frame, in hundredths of a percent.
+        math(EXPR change "(${current_p50} - ${baseline_p50}) * 10000 / ${baseline_p50}")
+
+        set(regressed 0)
+        if(NOT z LESS z_threshold AND change GREATER threshold)
+            set(regressed 1)
+            list(APPEND regressions ${name})
+        endif()
+
+        decimal(${change} change_text)
+        decimal(${z} z_text)
+        if(regressed)
+            message(STATUS "Compare ${BACKEND}: ${name} REGRESSED, p50 ${baseline_p50} -> ${current_p50} ns (${change_text}%), z ${z_text}")
+        else()
+            message(STATUS "Compare ${BACKEND}: ${name} p50 ${baseline_p50} -> ${current_p50} ns (${change_text}%), z ${z_text}")
+        endif()
+
+        string(APPEND csv "${name},${BACKEND},${baseline_p50},${current_p50},${change_text},${z_text},${regressed}\n")
+        math(EXPR compared "${compared} + 1")
+    endforeach()
+endif()
+
+file(WRITE "${OUTPUT_DIR}/compare-${BACKEND}.csv" "${csv}")
+message(STATUS "Wrote ${OUTPUT_DIR}/compare-${BACKEND}.csv")
+
+if(compared EQUAL 0)
+    message(FATAL_ERROR "Compare ${BACKEND}: ${BASELINE} has no scenarios for ${BACKEND}, record them with the baseline target")
+endif()
+
+if(regressions)
+    string(REPLACE ";" ", " regressions "${regressions}")
+    message(FATAL_ERROR "Compare ${BACKEND}: regressed in ${regressions}")
+endif()
+
+message(STATUS "Compare ${BACKEND}: no regressions in ${compared} scenarios")
@@ -0,0 +1,126 @@
+# Starts the game a number of times and reports the median time of every startup phase and of the first frame.
+#
+# cmake -DGIRAFFE=<executable> -DBACKEND=<SCRIPT> -DRUNS=5 -DOUTPUT_DIR=<dir> -DHISTORY=<csv> -P startup.cmake
+#
+# The medians are written as JSON, and appended to the history CSV with the time and the commit, so it shows how
+# startup changes over time.
+
+foreach(variable GIRAFFE BACKEND RUNS OUTPUT_DIR HISTORY)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "startup.cmake needs -D${variable}")
+    endif()
+endforeach()
+
+if(RUNS LESS 1)
+    message(FATAL_ERROR "startup.cmake needs -DRUNS to be positive")
+endif()
+
+# The middle value of a list of integers, the lower one of the two in the middle for an even count.
+function(median values result)
+    list(SORT values COMPARE NATURAL)
+    list(LENGTH values count)
+    math(EXPR middle "(${count} - 1) / 2")
+    list(GET values ${middle} value)
+    set(${result} ${value} PARENT_SCOPE)
+endfunction()
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+set(first_frame_values "")
+set(phase_names "")
+set(phase_depths "")
+set(phase_count 0)
+
+foreach(run RANGE 1 ${RUNS})
+    set(report "${OUTPUT_DIR}/startup-${BACKEND}-${run}.json")
+    message(STATUS "Startup ${BACKEND}: run ${run} of ${RUNS}")
+
+    execute_process(
+        COMMAND "${GIRAFFE}" --headless --giraffes 1 --frames 1 --warmup 0 --startup "${report}"
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Startup ${BACKEND}: run ${run} failed with ${result}")
+    endif()
+
+    file(READ "${report}" startup)
+    string(JSON first_frame_ns GET "${startup}" first_frame_ns)
+    list(APPEND first_frame_values ${first_frame_ns})
+
+    string(JSON count LENGTH "${startup}" phases)
+    if(run EQUAL 1)
+        set(phase_count ${count})
+    elseif(NOT count EQUAL phase_count)
+        message(FATAL_ERROR "Startup ${BACKEND}: run ${run} has ${count} phases, the first run had ${phase_count}")
+    endif()
+
+    if(count GREATER 0)
+        math(EXPR last "${count} - 1")
+        foreach(index RANGE ${last})
+            string(JSON name GET "${startup}" phases ${index} name)
+            string(JSON ns GET "${startup}" phases ${index} ns)
+            if(run EQUAL 1)
+                string(JSON depth GET "${startup}" phases ${index} depth)
+                list(APPEND phase_names "${name}")
+                list(APPEND phase_depths ${depth})
+            endif()
+            list(APPEND phase_values_${index} ${ns})
+        endforeach()
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    OUTPUT_VARIABLE commit
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    RESULT_VARIABLE result
+    ERROR_QUIET)
+if(NOT result EQUAL 0)
+    set(commit "unknown")
+endif()
+
+string(TIMESTAMP timestamp "%Y-%m-%dT%H:%M:%SZ" UTC)
+
+median("${first_frame_values}" first_frame_ns)
+message(STATUS "Startup ${BACKEND}: ${first_frame_ns} ns to the first frame, median of ${RUNS} runs")
+
+set(json "{}")
+string(JSON json SET "${json}" backend "\"${BACKEND}\"")
+string(JSON json SET "${json}" commit "\"${commit}\"")
+string(JSON json SET "${json}" timestamp "\"${timestamp}\"")
+string(JSON json SET "${json}" runs ${RUNS})
+string(JSON json SET "${json}" first_frame_ns ${first_frame_ns})
+string(JSON json SET "${json}" phases "[]")
+
+set(header "timestamp,commit,backend,runs,first_frame_ns")
+set(row "${timestamp},${commit},${BACKEND},${RUNS},${first_frame_ns}")
+
+if(phase_count GREATER 0)
+    math(EXPR last "${phase_count} - 1")
+    foreach(index RANGE ${last})
+        list(GET phase_names ${index} name)
+        list(GET phase_depths ${index} depth)
+        median("${phase_values_${index}}" ns)
+        message(STATUS "Startup ${BACKEND}: ${name} ${ns} ns")
+
+        string(JSON json SET "${json}" phases ${index} "{\"name\":\"${name}\",\"depth\":${depth},\"ns\":${ns}}")
+        string(APPEND header ",${name}")
+        string(APPEND row ",${ns}")
+    endforeach()
+endif()
+
+file(WRITE "${OUTPUT_DIR}/startup-${BACKEND}.json" "${json}\n")
+
+# A new header starts a new table when the phases have changed since the last row.
+set(last_header "")
+if(EXISTS "${HISTORY}")
+    file(STRINGS "${HISTORY}" history_headers REGEX "^timestamp,")
+    if(history_headers)
+        list(GET history_headers -1 last_header)
+    endif()
+endif()
+if(NOT last_header STREQUAL header)
+    file(APPEND "${HISTORY}" "${header}\n")
+endif()
+file(APPEND "${HISTORY}" "${row}\n")
+
+message(STATUS "Wrote ${OUTPUT_DIR}/startup-${BACKEND}.json and appended to ${HISTORY}")
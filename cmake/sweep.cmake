@@ -0,0 +1,49 @@
+# Runs the headless benchmark once per herd size and collects the reports into a JSON array and a CSV table.
+#
+# cmake -DGIRAFFE=<executable> -DBACKEND=<SCRIPT> -DGIRAFFES=100,1000 -DFRAMES=600 -DWARMUP=120 -DOUTPUT_DIR=<dir> -P sweep.cmake
+#
+# Every size runs in its own process, so the peak memory of each report only covers its own herd.
+
+foreach(variable GIRAFFE BACKEND GIRAFFES FRAMES WARMUP OUTPUT_DIR)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "sweep.cmake needs -D${variable}")
+    endif()
+endforeach()
+
+string(REPLACE "," ";" herd_sizes "${GIRAFFES}")
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+
+set(report_fields backend giraffes warmup_frames frames dt seed ns_per_frame min_ns p50_ns p99_ns max_ns allocations_per_frame frees_per_frame bytes_per_frame peak_memory_bytes)
+string(REPLACE ";" "," csv "${report_fields}")
+string(APPEND csv "\n")
+set(json "[]")
+set(index 0)
+
+foreach(herd_size IN LISTS herd_sizes)
+    set(report "${OUTPUT_DIR}/sweep-${BACKEND}-${herd_size}.json")
+    message(STATUS "Sweep ${BACKEND}: ${herd_size} giraffes")
+
+    execute_process(
+        COMMAND "${GIRAFFE}" --headless --giraffes ${herd_size} --frames ${FRAMES} --warmup ${WARMUP} --report "${report}"
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Sweep ${BACKEND}: ${herd_size} giraffes failed with ${result}")
+    endif()
+
+    file(READ "${report}" run)
+    string(STRIP "${run}" run)
+    string(JSON json SET "${json}" ${index} "${run}")
+    math(EXPR index "${index} + 1")
+
+    set(row "")
+    foreach(field IN LISTS report_fields)
+        string(JSON value GET "${run}" ${field})
+        list(APPEND row "${value}")
+    endforeach()
+    string(REPLACE ";" "," row "${row}")
+    string(APPEND csv "${row}\n")
+endforeach()
+
+file(WRITE "${OUTPUT_DIR}/sweep-${BACKEND}.json" "${json}\n")
+file(WRITE "${OUTPUT_DIR}/sweep-${BACKEND}.csv" "${csv}")
+message(STATUS "Wrote ${OUTPUT_DIR}/sweep-${BACKEND}.json and ${OUTPUT_DIR}/sweep-${BACKEND}.csv")
@@ -31,6 +31,7 @@ if ffi then
         vec2 glm_divide_vec2_scalar(const vec2 lhs, const float rhs);
 
         bool glm_ray_circle_intersection(const vec2 ray_origin, const vec2 ray_direction, const vec2 circle_center, float circle_radius, vec2 *intersection);
+        bool glm_ray_circles_intersection(const vec2 ray_origin, const vec2 ray_direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance);
         bool glm_ray_line_intersection(const vec2 ray_origin, const vec2 ray_direction, const vec2 p1, const vec2 p2, vec2 *intersection);
         vec2 glm_truncate(const vec2 v, float max_length);
         vec2 glm_normalize(const vec2 v);
@@ -42,6 +43,13 @@ if ffi then
         mat4 glm_scale(const mat4 m, const vec3 v);
     ]]
 
+    -- Reused for every ray_circles_intersection result, instead of allocating one per ray
+    local ray_circles_distance = ffi.new("float[1]")
+
+    -- Reused for the rays of every ray_circles_intersection2, which takes them as plain numbers
+    local ray_circles_origin = ffi.new("vec2")
+    local ray_circles_direction = ffi.new("vec2")
+
     Glm = {
         vec2 = ffi.metatype(ffi.typeof("vec2"), {
             __tostring = function(v)
@@ -94,6 +102,25 @@ if ffi then
             local hit = ffi.C.glm_ray_circle_intersection(ray_origin, ray_direction, circle_center, circle_radius, intersection)
             return hit, intersection
         end,
+        circles = function(centers, radii)
+            local count = #centers
+            local circles = {
+                count = count,
+                center_x = ffi.new("float[?]", count),
+                center_y = ffi.new("float[?]", count),
+                radius = ffi.new("float[?]", count),
+            }
+            for i = 1, count do
+                circles.center_x[i - 1] = centers[i].x
+                circles.center_y[i - 1] = centers[i].y
+                circles.radius[i - 1] = radii[i]
+            end
+            return circles
+        end,
+        ray_circles_intersection = function(ray_origin, ray_direction, circles, max_distance)
+            local hit = ffi.C.glm_ray_circles_intersection(ray_origin, ray_direction, circles.center_x, circles.center_y, circles.radius, circles.count, max_distance, ray_circles_distance)
+            return hit, ray_circles_distance[0]
+        end,
         ray_line_intersection = function()
             local intersection = ffi.new("vec2")
             local hit = ffi.C.glm_ray_line_intersection(ray_origin, ray_direction, p1, p2, intersection)
@@ -105,6 +132,40 @@ if ffi then
         length2 = ffi.C.glm_length2,
         translate = ffi.C.glm_translate,
         scale = ffi.C.glm_scale,
+        -- The unboxed vec2 functions take and return plain numbers, which doesn't make a cdata for every result. They're
+        -- plain Lua that computes in doubles, unlike the C functions behind the other backends, which compute in floats.
+        add2 = function(ax, ay, bx, by)
+            return ax + bx, ay + by
+        end,
+        sub2 = function(ax, ay, bx, by)
+            return ax - bx, ay - by
+        end,
+        mul2 = function(x, y, scalar)
+            return x * scalar, y * scalar
+        end,
+        div2 = function(x, y, scalar)
+            return x / scalar, y / scalar
+        end,
+        truncate2 = function(x, y, max_length)
+            local length = math.sqrt(x * x + y * y)
+            if length > max_length and length > 0 then
+                local scale = max_length / length
+                return x * scale, y * scale
+            end
+            return x, y
+        end,
+        normalize2 = function(x, y)
+            local length = math.sqrt(x * x + y * y)
+            return x / length, y / length
+        end,
+        ray_circles_intersection2 = function(ray_origin_x, ray_origin_y, ray_direction_x, ray_direction_y, circles, max_distance)
+            ray_circles_origin.x = ray_origin_x
+            ray_circles_origin.y = ray_origin_y
+            ray_circles_direction.x = ray_direction_x
+            ray_circles_direction.y = ray_direction_y
+            local hit = ffi.C.glm_ray_circles_intersection(ray_circles_origin, ray_circles_direction, circles.center_x, circles.center_y, circles.radius, circles.count, max_distance, ray_circles_distance)
+            return hit, ray_circles_distance[0]
+        end,
     }
 end
 
@@ -309,13 +370,16 @@ end
 local class = require_middleclass()
 
 
+-- Positions and vectors are kept as plain numbers, so updating them doesn't make a Glm.vec2 for every result.
 local Mob = class("Mob")
 function Mob:initialize()
     self.mass = 100
-    self.position = Glm.vec2(0, 0)
-    self.velocity = Glm.vec2(0, 0)
-    self.steering_direction = Glm.vec2(0, 0)
-    self.steering_target = Glm.vec2(0, 0)
+    self.x, self.y = 0, 0
+    -- Where the mob was before the last tick, which its sprite is interpolated from
+    self.previous_x, self.previous_y = 0, 0
+    self.vx, self.vy = 0, 0
+    self.steering_x, self.steering_y = 0, 0
+    self.target_x, self.target_y = 0, 0
     self.max_force = 30
     self.max_speed = 30
     self.orientation = 0
@@ -341,12 +405,12 @@ end
 local Food = class("Food")
 function Food:initialize()
     self.sprite_id = 0
-    self.position = Glm.vec2(0, 0)
+    self.x, self.y = 0, 0
 end
 
 local Obstacle = class("Obstacle")
 function Obstacle:initialize()
-    self.position = Glm.vec2(0, 0)
+    self.x, self.y = 0, 0
     self.radius = 100
     self.color = Math.Color4f(1, 1, 1, 1)
 end
@@ -359,8 +423,32 @@ local FOOD_Z_LAYER = -3
 local game_state = {
     giraffes = {},
     obstacles = {},
+    obstacle_circles = nil,
+    -- Atlas frames looked up once in on_enter, instead of by name for every sprite in every update
+    giraffe_frame = nil,
+    lion_frame = nil,
+    -- Sprite transforms added during update, and passed to Engine.transform_sprites all at once by interpolate, which
+    -- fills in x and y between where the sprites were before and after the last tick
+    sprite_transforms = {
+        count = 0,
+        sprite_id = {},
+        previous_x = {},
+        previous_y = {},
+        position_x = {},
+        position_y = {},
+        x_offset = {},
+        y_offset = {},
+        x = {},
+        y = {},
+        scale_x = {},
+        scale_y = {},
+        z = {},
+    },
     food = Food:new(),
     lion = Lion:new(),
+    -- The window size, read once per update since engine.window_rect makes a new table every time
+    window_width = 0,
+    window_height = 0,
     debug_draw = false,
     debug_avoidance = false,
 }
@@ -372,10 +460,8 @@ local spawn_giraffes = function(engine, game, num_giraffes)
         giraffe.mob.max_force = 1000
         giraffe.mob.max_speed = 300
         giraffe.mob.radius = 20
-        giraffe.mob.position = Glm.vec2(
-            50 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.x - 100),
-            50 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.y - 100)
-        )
+        giraffe.mob.x = 50 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.x - 100)
+        giraffe.mob.y = 50 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.y - 100)
 
         local sprite = Engine.add_sprite(game.sprites, "giraffe", Engine.Color.Pico8.orange)
         giraffe.sprite_id = sprite:identifier()
@@ -388,16 +474,20 @@ function on_enter(engine, game)
         profile.start()
     end
 
-    local time = os.time()
-    rnd_pcg_seed(RANDOM_DEVICE, time)
+    game_state.giraffe_frame = Engine.atlas_frame(game.sprites.atlas, "giraffe")
+    game_state.lion_frame = Engine.atlas_frame(game.sprites.atlas, "lion")
+
+    local seed = game.random_seed
+    if seed == 0 then
+        seed = os.time()
+    end
+    rnd_pcg_seed(RANDOM_DEVICE, seed)
 
     -- Spawn lake
     do
         local lake_obstacle = Obstacle:new()
-        lake_obstacle.position = Glm.vec2(
-            (engine.window_rect.size.x / 2) + 200 * rnd_pcg_nextf(RANDOM_DEVICE) - 100,
-            (engine.window_rect.size.y / 2) + 200 * rnd_pcg_nextf(RANDOM_DEVICE) - 100
-        )
+        lake_obstacle.x = (engine.window_rect.size.x / 2) + 200 * rnd_pcg_nextf(RANDOM_DEVICE) - 100
+        lake_obstacle.y = (engine.window_rect.size.y / 2) + 200 * rnd_pcg_nextf(RANDOM_DEVICE) - 100
         lake_obstacle.color = Engine.Color.Pico8.blue
         lake_obstacle.radius = 100 + rnd_pcg_nextf(RANDOM_DEVICE) * 100
         table.insert(game_state.obstacles, lake_obstacle)
@@ -406,28 +496,42 @@ function on_enter(engine, game)
     -- Spawn trees
     for _ = 1, 10 do
         local obstacle = Obstacle:new()
-        obstacle.position = Glm.vec2(
-            10 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.x - 20),
-            10 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.y - 20)
-        )
+        obstacle.x = 10 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.x - 20)
+        obstacle.y = 10 + rnd_pcg_nextf(RANDOM_DEVICE) * (engine.window_rect.size.y - 20)
         obstacle.color = Engine.Color.Pico8.light_gray
         obstacle.radius = 20
         table.insert(game_state.obstacles, obstacle)
     end
 
+    -- The obstacles don't move, so their circles are copied once for the avoidance rays
+    do
+        local centers = {}
+        local radii = {}
+        for i, obstacle in ipairs(game_state.obstacles) do
+            centers[i] = Glm.vec2(obstacle.x, obstacle.y)
+            radii[i] = obstacle.radius
+        end
+        game_state.obstacle_circles = Glm.circles(centers, radii)
+    end
+
     -- Spawn giraffes
-    spawn_giraffes(engine, game, 1000)
+    local initial_giraffes = game.initial_giraffes
+    if initial_giraffes == 0 then
+        initial_giraffes = 1000
+    end
+    spawn_giraffes(engine, game, initial_giraffes)
 
     -- Spawn food
     do
         local sprite = Engine.add_sprite(game.sprites, "food", Engine.Color.Pico8.green)
         game_state.food.sprite_id = sprite:identifier()
-        game_state.food.position = Glm.vec2(0.25 * engine.window_rect.size.x, 0.25 * engine.window_rect.size.y)
+        game_state.food.x = 0.25 * engine.window_rect.size.x
+        game_state.food.y = 0.25 * engine.window_rect.size.y
 
         local transform = Glm.mat4(1.0)
         transform = Glm.translate(transform, Glm.vec3(
-            math.floor(game_state.food.position.x - sprite.atlas_frame.rect.size.x * sprite.atlas_frame.pivot.x),
-            math.floor(game_state.food.position.y - sprite.atlas_frame.rect.size.y * (1.0 - sprite.atlas_frame.pivot.y)),
+            math.floor(game_state.food.x - sprite.atlas_frame.rect.size.x * sprite.atlas_frame.pivot.x),
+            math.floor(game_state.food.y - sprite.atlas_frame.rect.size.y * (1.0 - sprite.atlas_frame.pivot.y)),
             FOOD_Z_LAYER
         ))
         transform = Glm.scale(transform, Glm.vec3(sprite.atlas_frame.rect.size.x, sprite.atlas_frame.rect.size.y, 1.0))
@@ -440,7 +544,8 @@ function on_enter(engine, game)
     do
         local sprite = Engine.add_sprite(game.sprites, "lion", Engine.Color.Pico8.yellow)
         game_state.lion.sprite_id = sprite:identifier()
-        game_state.lion.mob.position = Glm.vec2(engine.window_rect.size.x * 0.75, engine.window_rect.size.y * 0.75)
+        game_state.lion.mob.x = engine.window_rect.size.x * 0.75
+        game_state.lion.mob.y = engine.window_rect.size.y * 0.75
         game_state.lion.mob.mass = 25
         game_state.lion.mob.max_force = 1000
         game_state.lion.mob.max_speed = 400
@@ -498,13 +603,14 @@ function on_input(engine, game, input_command)
         if input_command.mouse_state.mouse_left_state == Engine.TriggerState.Pressed then
             local x = input_command.mouse_state.mouse_position.x
             local y = engine.window_rect.size.y - input_command.mouse_state.mouse_position.y
-            game_state.food.position = Glm.vec2(x, y)
+            game_state.food.x = x
+            game_state.food.y = y
 
             local sprite = Engine.get_sprite(game.sprites, game_state.food.sprite_id)
             local transform = Glm.mat4(1.0)
             transform = Glm.translate(transform, Glm.vec3(
-                math.floor(game_state.food.position.x - sprite.atlas_frame.rect.size.x * sprite.atlas_frame.pivot.x),
-                math.floor(game_state.food.position.y - sprite.atlas_frame.rect.size.y * (1.0 - sprite.atlas_frame.pivot.y)),
+                math.floor(game_state.food.x - sprite.atlas_frame.rect.size.x * sprite.atlas_frame.pivot.x),
+                math.floor(game_state.food.y - sprite.atlas_frame.rect.size.y * (1.0 - sprite.atlas_frame.pivot.y)),
                 FOOD_Z_LAYER
             ))
             transform = Glm.scale(transform, Glm.vec3(sprite.atlas_frame.rect.size.x, sprite.atlas_frame.rect.size.y, 1.0))
@@ -515,193 +621,198 @@ function on_input(engine, game, input_command)
     end
 end
 
+local add_sprite_transform = function(sprite_id, mob, x_offset, y_offset, scale_x, scale_y, z)
+    local transforms = game_state.sprite_transforms
+    local i = transforms.count + 1
+    transforms.count = i
+    transforms.sprite_id[i] = sprite_id
+    transforms.previous_x[i] = mob.previous_x
+    transforms.previous_y[i] = mob.previous_y
+    transforms.position_x[i] = mob.x
+    transforms.position_y[i] = mob.y
+    transforms.x_offset[i] = x_offset
+    transforms.y_offset[i] = y_offset
+    transforms.scale_x[i] = scale_x
+    transforms.scale_y[i] = scale_y
+    transforms.z[i] = z
+end
+
 local update_mob = function(mob, game, dt)
     local drag = 1
 
     -- lake drags you down
     for _, obstacle in ipairs(game_state.obstacles) do
-        local length = Glm.length(obstacle.position - mob.position)
+        local offset_x, offset_y = obstacle.x - mob.x, obstacle.y - mob.y
+        local length = math.sqrt(offset_x * offset_x + offset_y * offset_y)
         if length <= obstacle.radius then
             drag = 10
             break
         end
     end
 
-    local drag_force = -drag * mob.velocity
-    local steering_force = Glm.truncate(mob.steering_direction, mob.max_force) + drag_force
-    local acceleration = steering_force / mob.mass
+    local steering_x, steering_y = Glm.truncate2(mob.steering_x, mob.steering_y, mob.max_force)
+    local acceleration_x = (steering_x - drag * mob.vx) / mob.mass
+    local acceleration_y = (steering_y - drag * mob.vy) / mob.mass
 
-    mob.velocity = Glm.truncate(mob.velocity + acceleration, mob.max_speed)
-    mob.position = mob.position + mob.velocity * dt
+    mob.vx, mob.vy = Glm.truncate2(mob.vx + acceleration_x, mob.vy + acceleration_y, mob.max_speed)
+    mob.previous_x, mob.previous_y = mob.x, mob.y
+    mob.x = mob.x + mob.vx * dt
+    mob.y = mob.y + mob.vy * dt
 
-    if Glm.length(mob.velocity) > 0.001 then
-        mob.orientation = math.atan2(-mob.velocity.x, mob.velocity.y)
+    if math.sqrt(mob.vx * mob.vx + mob.vy * mob.vy) > 0.001 then
+        mob.orientation = math.atan2(-mob.vx, mob.vy)
     end
 end
 
-local arrival_behavior = function(mob, target_position, speed_ramp_distance)
-    local target_offset = target_position - mob.position
-    local distance = Glm.length(target_offset)
+local arrival_behavior = function(mob, target_x, target_y, speed_ramp_distance)
+    local offset_x, offset_y = target_x - mob.x, target_y - mob.y
+    local distance = math.sqrt(offset_x * offset_x + offset_y * offset_y)
     local ramped_speed = mob.max_speed * (distance / speed_ramp_distance)
     local clipped_speed = math.min(ramped_speed, mob.max_speed)
-    local desired_velocity = (clipped_speed / distance) * target_offset
+    local desired_speed = clipped_speed / distance
 
-    return desired_velocity - mob.velocity
+    return desired_speed * offset_x - mob.vx, desired_speed * offset_y - mob.vy
 end
 
 local avoidance_behavior = function(mob, engine, game)
     local look_ahead_distance = 200
 
-    local origin = mob.position
-    local target_distance = Glm.length(mob.steering_target - origin)
-    local forward = Glm.normalize(mob.steering_target - origin)
-
-    local right_vector = Glm.vec2(forward.y, -forward.x)
-    local left_vector = Glm.vec2(-forward.y, forward.x)
-
-    local left_start = origin + left_vector * mob.radius
-    local right_start = origin + right_vector * mob.radius
+    local offset_x, offset_y = mob.target_x - mob.x, mob.target_y - mob.y
+    local target_distance = math.sqrt(offset_x * offset_x + offset_y * offset_y)
+    local forward_x, forward_y = Glm.normalize2(offset_x, offset_y)
 
-    local left_intersects = false
-    local left_intersection = nil
-    local left_intersection_distance = 1000000 -- sufficiently large enough
-
-    local right_intersects = false
-    local right_intersection = nil
-    local right_intersection_distance = 1000000 -- sufficiently large enough
-
-    -- check against each obstacle
-    for _, obstacle in ipairs(game_state.obstacles) do
-        local did_li, li = Glm.ray_circle_intersection(left_start, forward, obstacle.position, obstacle.radius);
-        if did_li then
-            local distance = Glm.length(li - left_start)
-            if distance <= look_ahead_distance and distance < left_intersection_distance then
-                left_intersects = true
-                left_intersection = li
-                left_intersection_distance = distance
-            end
-        end
+    -- The right vector is (forward_y, -forward_x), and the left vector is (-forward_y, forward_x)
+    local left_start_x, left_start_y = mob.x - forward_y * mob.radius, mob.y + forward_x * mob.radius
+    local right_start_x, right_start_y = mob.x + forward_y * mob.radius, mob.y - forward_x * mob.radius
 
-        local did_ri, ri = Glm.ray_circle_intersection(right_start, forward, obstacle.position, obstacle.radius)
-        if did_ri then
-            local distance = Glm.length(ri - right_start)
-            if distance <= look_ahead_distance and distance < right_intersection_distance then
-                right_intersects = true
-                right_intersection = li
-                right_intersection_distance = distance
-            end
-        end
-    end
+    local left_intersects, left_intersection_distance = Glm.ray_circles_intersection2(left_start_x, left_start_y, forward_x, forward_y, game_state.obstacle_circles, look_ahead_distance)
+    local right_intersects, right_intersection_distance = Glm.ray_circles_intersection2(right_start_x, right_start_y, forward_x, forward_y, game_state.obstacle_circles, look_ahead_distance)
 
-    local avoidance_force = Glm.vec2(0, 0)
+    left_intersection_distance = left_intersects and left_intersection_distance or 1000000 -- sufficiently large enough
+    right_intersection_distance = right_intersects and right_intersection_distance or 1000000 -- sufficiently large enough
 
     if right_intersects or left_intersects then
         if target_distance <= left_intersection_distance and target_distance <= right_intersection_distance then
-            return Glm.vec2(0, 0)
+            return 0, 0
         end
 
         if left_intersection_distance < right_intersection_distance then
             local ratio = left_intersection_distance / look_ahead_distance
-            avoidance_force = right_vector * (1.0 - ratio) * 50
+            local strength = (1.0 - ratio) * 50
+            return forward_y * strength, -forward_x * strength
         else
             local ratio = right_intersection_distance / look_ahead_distance
-            avoidance_force = left_vector * (1.0 - ratio) * 50
+            local strength = (1.0 - ratio) * 50
+            return -forward_y * strength, forward_x * strength
         end
     end
 
-    return avoidance_force
+    return 0, 0
 end
 
 local update_giraffe = function(giraffe, engine, game, dt)
-    local arrival_force = Glm.vec2(0, 0)
+    local mob = giraffe.mob
+
+    local arrival_x, arrival_y = 0, 0
     local arrival_weight = 1
 
-    local flee_force = Glm.vec2(0, 0)
+    local flee_x, flee_y = 0, 0
     local flee_weight = 1
 
-    local separation_force = Glm.vec2(0, 0)
+    local separation_x, separation_y = 0, 0
     local separation_weight = 10
 
-    local avoidance_force = Glm.vec2(0, 0)
+    local avoidance_x, avoidance_y = 0, 0
     local avoidance_weight = 10
 
     if not giraffe.dead then
+        local lion_mob = game_state.lion.mob
         local is_hunted = false
 
-        local distance = Glm.length(game_state.lion.mob.position - giraffe.mob.position)
+        local lion_offset_x, lion_offset_y = lion_mob.x - mob.x, lion_mob.y - mob.y
+        local distance = math.sqrt(lion_offset_x * lion_offset_x + lion_offset_y * lion_offset_y)
         if distance <= 300 then
             is_hunted = true
         end
 
         -- flee
         if is_hunted then
-            local flee_direction = giraffe.mob.position - game_state.lion.mob.position
-            local steering_target = giraffe.mob.position + flee_direction
-            giraffe.mob.steering_target = steering_target
+            local flee_direction_x, flee_direction_y = mob.x - lion_mob.x, mob.y - lion_mob.y
+            mob.target_x = mob.x + flee_direction_x
+            mob.target_y = mob.y + flee_direction_y
 
-            local desired_velocity = Glm.normalize(flee_direction) * giraffe.mob.max_speed
-            flee_force = desired_velocity - giraffe.mob.velocity
+            local desired_x, desired_y = Glm.normalize2(flee_direction_x, flee_direction_y)
+            flee_x = desired_x * mob.max_speed - mob.vx
+            flee_y = desired_y * mob.max_speed - mob.vy
 
-            local boundary_avoidance_force = Glm.vec2(0, 0)
+            local boundary_avoidance_x, boundary_avoidance_y = 0, 0
             local buffer_distance = 100
+            local window_width = game_state.window_width
+            local window_height = game_state.window_height
 
-            if giraffe.mob.position.x <= buffer_distance then
-                boundary_avoidance_force.x = buffer_distance - giraffe.mob.position.x
-            elseif giraffe.mob.position.x >= engine.window_rect.size.x - buffer_distance then
-                boundary_avoidance_force.x = engine.window_rect.size.x - buffer_distance - giraffe.mob.position.x
+            if mob.x <= buffer_distance then
+                boundary_avoidance_x = buffer_distance - mob.x
+            elseif mob.x >= window_width - buffer_distance then
+                boundary_avoidance_x = window_width - buffer_distance - mob.x
             end
 
-            if giraffe.mob.position.y <= buffer_distance then
-                boundary_avoidance_force.y = buffer_distance - giraffe.mob.position.y
-            elseif giraffe.mob.position.y >= engine.window_rect.size.y - buffer_distance then
-                boundary_avoidance_force.y = engine.window_rect.size.y - buffer_distance - giraffe.mob.position.y
+            if mob.y <= buffer_distance then
+                boundary_avoidance_y = buffer_distance - mob.y
+            elseif mob.y >= window_height - buffer_distance then
+                boundary_avoidance_y = window_height - buffer_distance - mob.y
             end
 
-            boundary_avoidance_force = boundary_avoidance_force * 20
-
-            flee_force = flee_force + boundary_avoidance_force
-            flee_force = flee_force * flee_weight
+            flee_x = (flee_x + boundary_avoidance_x * 20) * flee_weight
+            flee_y = (flee_y + boundary_avoidance_y * 20) * flee_weight
         else
             -- arrival
-            giraffe.mob.steering_target = game_state.food.position
-            arrival_force = arrival_behavior(giraffe.mob, game_state.food.position, 100)
-            arrival_force = arrival_force * arrival_weight
+            local food = game_state.food
+            mob.target_x = food.x
+            mob.target_y = food.y
+            arrival_x, arrival_y = arrival_behavior(mob, food.x, food.y, 100)
+            arrival_x = arrival_x * arrival_weight
+            arrival_y = arrival_y * arrival_weight
         end
 
         -- separation
         do
             for _, other_giraffe in ipairs(game_state.giraffes) do
                 if other_giraffe ~= giraffe and not other_giraffe.dead then
-                    local offset = other_giraffe.mob.position - giraffe.mob.position
-                    local distance_squared = Glm.length2(offset)
-                    local near_distance_squared = (giraffe.mob.radius + other_giraffe.mob.radius) * (giraffe.mob.radius + other_giraffe.mob.radius)
-                    if distance_squared <= near_distance_squared then
-                        local distance = math.sqrt(distance_squared)
-                        offset = offset / distance
-                        offset = offset * (giraffe.mob.radius + other_giraffe.mob.radius)
-                        separation_force = separation_force - offset
+                    local other_mob = other_giraffe.mob
+                    local offset_x, offset_y = other_mob.x - mob.x, other_mob.y - mob.y
+                    local distance_squared = offset_x * offset_x + offset_y * offset_y
+                    local near_distance = mob.radius + other_mob.radius
+                    if distance_squared <= near_distance * near_distance then
+                        local scale = near_distance / math.sqrt(distance_squared)
+                        separation_x = separation_x - offset_x * scale
+                        separation_y = separation_y - offset_y * scale
                     end
                 end
             end
 
-            separation_force = separation_force * separation_weight
+            separation_x = separation_x * separation_weight
+            separation_y = separation_y * separation_weight
         end
 
         -- avoidance
         do
-            avoidance_force = avoidance_behavior(giraffe.mob, engine, game)
-            avoidance_force = avoidance_force * avoidance_weight
+            avoidance_x, avoidance_y = avoidance_behavior(mob, engine, game)
+            avoidance_x = avoidance_x * avoidance_weight
+            avoidance_y = avoidance_y * avoidance_weight
         end
     end
 
-    giraffe.mob.steering_direction = Glm.truncate(arrival_force + flee_force + separation_force + avoidance_force, giraffe.mob.max_force)
+    mob.steering_x, mob.steering_y = Glm.truncate2(
+        arrival_x + flee_x + separation_x + avoidance_x,
+        arrival_y + flee_y + separation_y + avoidance_y,
+        mob.max_force
+    )
 
-    update_mob(giraffe.mob, game, dt)
+    update_mob(mob, game, dt)
 
-    local giraffe_frame = Engine.atlas_frame(game.sprites.atlas, "giraffe")
+    local giraffe_frame = game_state.giraffe_frame
 
-    local transform = Glm.mat4(1.0)
-    local flip_x = giraffe.mob.velocity.x <= 0.0
+    local flip_x = mob.vx <= 0.0
     local flip_y = giraffe.dead == true
 
     local x_offset = giraffe_frame.rect.size.x * giraffe_frame.pivot.x
@@ -715,25 +826,28 @@ local update_giraffe = function(giraffe, engine, game, dt)
         y_offset = y_offset * -1.0
     end
 
-    transform = Glm.translate(transform, Glm.vec3(
-        math.floor(giraffe.mob.position.x - x_offset),
-        math.floor(giraffe.mob.position.y - y_offset),
+    add_sprite_transform(
+        giraffe.sprite_id,
+        mob,
+        x_offset,
+        y_offset,
+        (flip_x and -1.0 or 1.0) * giraffe_frame.rect.size.x,
+        (flip_y and -1.0 or 1.0) * giraffe_frame.rect.size.y,
         GIRAFFE_Z_LAYER
-    ))
-    transform = Glm.scale(transform, Glm.vec3((flip_x and -1.0 or 1.0) * giraffe_frame.rect.size.x, (flip_y and -1.0 or 1.0) * giraffe_frame.rect.size.y, 1.0))
-
-    local matrix = Math.matrix4f_from_transform(transform)
-    Engine.transform_sprite(game.sprites, giraffe.sprite_id, matrix)
+    )
 end
 
 local update_lion = function(lion, engine, game, t, dt)
+    local mob = lion.mob
+
     if not lion.locked_giraffe then
         if lion.energy >= lion.max_energy then
             local found_giraffe = nil
             local distance = 1000000
             for _, giraffe in ipairs(game_state.giraffes) do
                 if not giraffe.dead then
-                    local d = Glm.length(giraffe.mob.position - lion.mob.position)
+                    local offset_x, offset_y = giraffe.mob.x - mob.x, giraffe.mob.y - mob.y
+                    local d = math.sqrt(offset_x * offset_x + offset_y * offset_y)
                     if d < distance then
                         distance = d
                         found_giraffe = giraffe
@@ -751,52 +865,55 @@ local update_lion = function(lion, engine, game, t, dt)
     end
 
     if lion.locked_giraffe then
-        lion.mob.steering_target = lion.locked_giraffe.mob.position
+        local target = lion.locked_giraffe.mob
+        mob.target_x = target.x
+        mob.target_y = target.y
 
-        local pursue_force = Glm.vec2(0, 0)
+        local pursue_x, pursue_y = 0, 0
         local pursue_weight = 1
 
-        local avoidance_force = Glm.vec2(0, 0)
+        local avoidance_x, avoidance_y = 0, 0
         local avoidance_weight = 10
 
         -- Pursue
         do
-            local desired_velocity = Glm.normalize(lion.locked_giraffe.mob.position - lion.mob.position) * lion.mob.max_speed
-            pursue_force = desired_velocity - lion.mob.velocity
-            pursue_force = pursue_force * pursue_weight
+            local desired_x, desired_y = Glm.normalize2(target.x - mob.x, target.y - mob.y)
+            pursue_x = (desired_x * mob.max_speed - mob.vx) * pursue_weight
+            pursue_y = (desired_y * mob.max_speed - mob.vy) * pursue_weight
         end
 
         -- Avoidance
         do
-            avoidance_force = avoidance_behavior(lion.mob, engine, game)
-            avoidance_force = avoidance_force * avoidance_weight
+            avoidance_x, avoidance_y = avoidance_behavior(mob, engine, game)
+            avoidance_x = avoidance_x * avoidance_weight
+            avoidance_y = avoidance_y * avoidance_weight
         end
 
-        lion.mob.steering_direction = Glm.truncate(pursue_force + avoidance_force, lion.mob.max_force)
+        mob.steering_x, mob.steering_y = Glm.truncate2(pursue_x + avoidance_x, pursue_y + avoidance_y, mob.max_force)
 
-        if Glm.length(lion.locked_giraffe.mob.position - lion.mob.position) <= lion.mob.radius then
+        local offset_x, offset_y = target.x - mob.x, target.y - mob.y
+        if math.sqrt(offset_x * offset_x + offset_y * offset_y) <= mob.radius then
             lion.locked_giraffe.dead = true
             Engine.color_sprite(game.sprites, lion.locked_giraffe.sprite_id, Engine.Color.Pico8.light_gray)
 
             lion.locked_giraffe = nil
             lion.energy = 0
-            lion.mob.steering_direction = Glm.vec2(0, 0)
+            mob.steering_x, mob.steering_y = 0, 0
         else
             lion.energy = lion.energy - dt
             if lion.energy <= 0.0 then
                 lion.locked_giraffe = nil
                 lion.energy = 0.0
-                lion.mob.steering_direction = Glm.vec2(0, 0)
+                mob.steering_x, mob.steering_y = 0, 0
             end
         end
     end
 
-    update_mob(lion.mob, game, dt);
+    update_mob(mob, game, dt);
 
-    local lion_frame = Engine.atlas_frame(game.sprites.atlas, "lion")
+    local lion_frame = game_state.lion_frame
 
-    local transform = Glm.mat4(1.0)
-    local flip = lion.locked_giraffe and lion.locked_giraffe.mob.position.x < lion.mob.position.x
+    local flip = lion.locked_giraffe and lion.locked_giraffe.mob.x < mob.x
 
     local x_offset = lion_frame.rect.size.x * lion_frame.pivot.x
 
@@ -804,23 +921,45 @@ local update_lion = function(lion, engine, game, t, dt)
         x_offset = x_offset * -1.0
     end
 
-    transform = Glm.translate(transform, Glm.vec3(
-        math.floor(lion.mob.position.x - x_offset),
-        math.floor(lion.mob.position.y - lion_frame.rect.size.y * (1.0 - lion_frame.pivot.y)),
+    add_sprite_transform(
+        lion.sprite_id,
+        mob,
+        x_offset,
+        lion_frame.rect.size.y * (1.0 - lion_frame.pivot.y),
+        (flip and -1.0 or 1.0) * lion_frame.rect.size.x,
+        lion_frame.rect.size.y,
         LION_Z_LAYER
-    ))
-    transform = Glm.scale(transform, Glm.vec3((flip and -1.0 or 1.0) * lion_frame.rect.size.x, lion_frame.rect.size.y, 1.0))
-
-    local matrix = Math.matrix4f_from_transform(transform)
-    Engine.transform_sprite(game.sprites, lion.sprite_id, matrix)
+    )
 end
 
 function update(engine, game, t, dt)
+    game_state.sprite_transforms.count = 0
+
+    local window_size = engine.window_rect.size
+    game_state.window_width = window_size.x
+    game_state.window_height = window_size.y
+
     for _, giraffe in ipairs(game_state.giraffes) do
         update_giraffe(giraffe, engine, game, dt)
     end
 
     update_lion(game_state.lion, engine, game, t, dt)
+end
+
+-- Transforms the sprites alpha of the way from where the last tick started to where it ended, once per frame however
+-- many ticks it ran
+function interpolate(engine, game, t, dt, alpha)
+    local transforms = game_state.sprite_transforms
+    local previous_x, previous_y = transforms.previous_x, transforms.previous_y
+    local position_x, position_y = transforms.position_x, transforms.position_y
+    local x_offset, y_offset = transforms.x_offset, transforms.y_offset
+    local x, y = transforms.x, transforms.y
+    for i = 1, transforms.count do
+        x[i] = math.floor(previous_x[i] * (1.0 - alpha) + position_x[i] * alpha - x_offset[i])
+        y[i] = math.floor(previous_y[i] * (1.0 - alpha) + position_y[i] * alpha - y_offset[i])
+    end
+
+    Engine.transform_sprites(game.sprites, transforms)
 
     Engine.update_sprites(game.sprites, t, dt)
     Engine.commit_sprites(game.sprites)
@@ -830,16 +969,28 @@ function render(engine, game)
     Engine.render_sprites(engine, game.sprites)
 end
 
+-- Hands the simulation state to the state hasher, the lion first, then the food, then every giraffe in spawn order.
+function hash_state(engine, game)
+    local lion = game_state.lion
+    Game.hash_lion(game, lion.mob.x, lion.mob.y, lion.mob.vx, lion.mob.vy, lion.energy)
+    Game.hash_food(game, game_state.food.x, game_state.food.y)
+
+    for i, giraffe in ipairs(game_state.giraffes) do
+        local mob = giraffe.mob
+        Game.hash_giraffe(game, i - 1, giraffe.dead, mob.x, mob.y, mob.vx, mob.vy)
+    end
+end
+
 function render_imgui(engine, game)
     local draw_list = Imgui.GetForegroundDrawList()
 
     if game_state.debug_draw then
         local debug_draw_mob = function(mob)
-            local origin = Glm.vec2(mob.position.x, engine.window_rect.size.y - mob.position.y)
+            local origin = Glm.vec2(mob.x, engine.window_rect.size.y - mob.y)
 
             -- steer
             do
-                local steer = Glm.truncate(mob.steering_direction, mob.max_force)
+                local steer = Glm.truncate(Glm.vec2(mob.steering_x, mob.steering_y), mob.max_force)
                 steer.y = steer.y * -1
                 local steer_ratio = Glm.length(steer) / mob.max_force
                 local end_point = origin + Glm.normalize(steer) * (steer_ratio * 100)
@@ -850,7 +1001,7 @@ function render_imgui(engine, game)
 
             -- velocity
             do
-                local vel = Glm.truncate(mob.velocity, mob.max_speed)
+                local vel = Glm.truncate(Glm.vec2(mob.vx, mob.vy), mob.max_speed)
                 vel.y = vel.y * -1
                 local vel_ratio = Glm.length(vel) / mob.max_speed
                 local end_point = origin + Glm.normalize(vel) * (vel_ratio * 100)
@@ -861,7 +1012,7 @@ function render_imgui(engine, game)
 
             -- avoidance
             if game_state.debug_avoidance then
-                local forward = Glm.normalize(mob.steering_target - mob.position)
+                local forward = Glm.normalize(Glm.vec2(mob.target_x - mob.x, mob.target_y - mob.y))
 
                 forward.y = forward.y * -1
                 local look_ahead = origin + forward * 200
@@ -895,20 +1046,20 @@ function render_imgui(engine, game)
         do
             debug_draw_mob(game_state.lion.mob)
 
-            local origin = Glm.vec2(game_state.lion.mob.position.x, engine.window_rect.size.y - game_state.lion.mob.position.y)
+            local origin = Glm.vec2(game_state.lion.mob.x, engine.window_rect.size.y - game_state.lion.mob.y)
 
             local ss = string.format("energy: %.0f", game_state.lion.energy)
             draw_list:AddText(Imgui.Imvec2(origin.x, origin.y + 32), Imgui.IM_COL32(255, 0, 0, 255), ss)
         end
 
         -- food
-        draw_list:AddText(Imgui.Imvec2(game_state.food.position.x, engine.window_rect.size.y - game_state.food.position.y + 8), Imgui.IM_COL32(255, 255, 0, 255), "food")
+        draw_list:AddText(Imgui.Imvec2(game_state.food.x, engine.window_rect.size.y - game_state.food.y + 8), Imgui.IM_COL32(255, 255, 0, 255), "food")
     end
 
     -- obstacles
     for _, obstacle in ipairs(game_state.obstacles) do
         local obstacle_color = Imgui.IM_COL32(obstacle.color.r * 255, obstacle.color.g * 255, obstacle.color.b * 255, 255)
-        local position = Imgui.Imvec2(obstacle.position.x, engine.window_rect.size.y - obstacle.position.y)
+        local position = Imgui.Imvec2(obstacle.x, engine.window_rect.size.y - obstacle.y)
         draw_list:AddCircle(position, obstacle.radius, obstacle_color, 0, 2.0)
     end
 
@@ -925,3 +1076,99 @@ function render_imgui(engine, game)
         draw_list:AddText(Imgui.Imvec2(8, 8), Imgui.IM_COL32(255, 255, 255, 255), ss)
     end
 end
+
+-- Times calls to the bound primitives for the bridge benchmark, starting with the empty loop that's subtracted from the others.
+function bridge_bench(engine, game, calls)
+    local a = Glm.vec2(1.0, 2.0)
+    local b = Glm.vec2(3.0, 4.0)
+    local origin = Glm.vec2(0.0, 0.0)
+    local direction = Glm.vec2(1.0, 0.0)
+    local center = Glm.vec2(10.0, 0.0)
+    local circles = Glm.circles({ center }, { 5.0 })
+    local sprites = game.sprites
+    local atlas = sprites.atlas
+    local sprite_id = game_state.lion.sprite_id
+    local matrix = Math.matrix4f_from_transform(Glm.mat4(1.0))
+    local v
+
+    -- The unboxed functions are plain Lua on LuaJIT and don't cross the bridge, so their rows are named for that.
+    local unboxed = ffi and " (pure lua)" or ""
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = a
+    end
+    Game.bench_end(game, "loop", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = a + b
+    end
+    Game.bench_end(game, "vec2 add", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = a * 2.0
+    end
+    Game.bench_end(game, "vec2 mul", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.add2(1.0, 2.0, 3.0, 4.0)
+    end
+    Game.bench_end(game, "add2" .. unboxed, calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.normalize(a)
+    end
+    Game.bench_end(game, "normalize", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.normalize2(1.0, 2.0)
+    end
+    Game.bench_end(game, "normalize2" .. unboxed, calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.truncate(b, 1.0)
+    end
+    Game.bench_end(game, "truncate", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.truncate2(3.0, 4.0, 1.0)
+    end
+    Game.bench_end(game, "truncate2" .. unboxed, calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.ray_circle_intersection(origin, direction, center, 5.0)
+    end
+    Game.bench_end(game, "ray_circle_intersection", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Glm.ray_circles_intersection(origin, direction, circles, 100.0)
+    end
+    Game.bench_end(game, "ray_circles_intersection", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        Engine.transform_sprite(sprites, sprite_id, matrix)
+    end
+    Game.bench_end(game, "transform_sprite", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = Engine.atlas_frame(atlas, "giraffe")
+    end
+    Game.bench_end(game, "atlas_frame", calls)
+
+    Game.bench_begin(game)
+    for i = 1, calls do
+        v = engine.window_rect
+    end
+    Game.bench_end(game, "window_rect", calls)
+end
@@ -6,6 +6,8 @@ const int32 FOOD_Z_LAYER = -3;
 class Mob {
     float mass = 100.0f;
     glm::vec2 position = glm::vec2(0.0f, 0.0f);
+    // Where the mob was before the last tick, which its sprite is interpolated from.
+    glm::vec2 previous_position = glm::vec2(0.0f, 0.0f);
     glm::vec2 velocity = glm::vec2(0.0f, 0.0f);
     glm::vec2 steering_direction = glm::vec2(0.0f, 0.0f);
     glm::vec2 steering_target = glm::vec2(0.0f, 0.0f);
@@ -40,44 +42,81 @@ class Food {
     glm::vec2 position = glm::vec2(0.0f, 0.0f);
 }
 
-class GameState {
-    array<Giraffe> giraffes;
-    array<Obstacle> obstacles;
-    Food food;
-    Lion lion;
-}
-
-GameState game_state;
+// Sprite transforms added during update, and passed to engine::transform_sprites all at once by interpolate, which
+// fills in x and y between where the sprites were before and after the last tick.
+class SpriteTransforms {
+    array<uint64> sprite_id;
+    array<float> previous_x;
+    array<float> previous_y;
+    array<float> position_x;
+    array<float> position_y;
+    array<float> x_offset;
+    array<float> y_offset;
+    array<float> x;
+    array<float> y;
+    array<float> scale_x;
+    array<float> scale_y;
+    array<float> z;
+
+    void add(uint64 id, Mob@ mob, float offset_x, float offset_y, float sx, float sy, float depth) {
+        sprite_id.insertLast(id);
+        previous_x.insertLast(mob.previous_position.x);
+        previous_y.insertLast(mob.previous_position.y);
+        position_x.insertLast(mob.position.x);
+        position_y.insertLast(mob.position.y);
+        x_offset.insertLast(offset_x);
+        y_offset.insertLast(offset_y);
+        x.insertLast(0.0f);
+        y.insertLast(0.0f);
+        scale_x.insertLast(sx);
+        scale_y.insertLast(sy);
+        z.insertLast(depth);
+    }
 
-bool ray_circle_intersection(const glm::vec2 &in ray_origin, const glm::vec2 &in ray_direction, const glm::vec2 &in circle_center, float circle_radius, glm::vec2 &out intersection) {
-    glm::vec2 ray_dir = glm::normalize(ray_direction);
+    void interpolate(float alpha) {
+        for (uint i = 0; i < sprite_id.length(); ++i) {
+            x[i] = floor(previous_x[i] * (1.0f - alpha) + position_x[i] * alpha - x_offset[i]);
+            y[i] = floor(previous_y[i] * (1.0f - alpha) + position_y[i] * alpha - y_offset[i]);
+        }
+    }
 
-    // Check if origin is inside the circle
-    if (glm::length(ray_origin - circle_center) <= circle_radius) {
-        intersection = ray_origin;
-        return true;
+    void clear() {
+        sprite_id.resize(0);
+        previous_x.resize(0);
+        previous_y.resize(0);
+        position_x.resize(0);
+        position_y.resize(0);
+        x_offset.resize(0);
+        y_offset.resize(0);
+        x.resize(0);
+        y.resize(0);
+        scale_x.resize(0);
+        scale_y.resize(0);
+        z.resize(0);
     }
+}
 
-    // Compute the nearest point on the ray to the circle's center
-    float t = glm::dot(circle_center - ray_origin, ray_dir);
+class GameState {
+    array<Giraffe> giraffes;
+    array<Obstacle> obstacles;
 
-    if (t < 0.0f) {
-        return false;
-    }
+    // The obstacle circles as arrays for glm::ray_circles_intersection, copied once since obstacles don't move.
+    array<float> obstacle_center_x;
+    array<float> obstacle_center_y;
+    array<float> obstacle_radius;
 
-    glm::vec2 P = ray_origin + t * ray_dir;
+    SpriteTransforms sprite_transforms;
 
-    // If the nearest point is inside the circle, calculate intersection
-    if (glm::length(P - circle_center) <= circle_radius) {
-        // Distance from P to circle boundary along the ray
-        float h = sqrt(circle_radius * circle_radius - glm::length(P - circle_center) * glm::length(P - circle_center));
-        intersection = P - h * ray_dir;
-        return true;
-    }
+    // Atlas frames looked up once in on_enter, instead of by name for every sprite in every update.
+    const engine::AtlasFrame@ giraffe_frame;
+    const engine::AtlasFrame@ lion_frame;
 
-    return false;
+    Food food;
+    Lion lion;
 }
 
+GameState game_state;
+
 void spawn_giraffes(engine::Engine@ engine, game::Game@ game, int num_giraffes) {
     for (int i = 0; i < num_giraffes; ++i) {
         Giraffe giraffe;
@@ -95,7 +134,10 @@ void spawn_giraffes(engine::Engine@ engine, game::Game@ game, int num_giraffes)
 }
 
 void on_enter(engine::Engine@ engine, game::Game@ game) {
-    rnd_pcg_seed(RANDOM_DEVICE, 123456);
+    rnd_pcg_seed(RANDOM_DEVICE, game.random_seed != 0 ? game.random_seed : 123456);
+
+    @game_state.giraffe_frame = engine::atlas_frame(game.sprites.atlas, "giraffe");
+    @game_state.lion_frame = engine::atlas_frame(game.sprites.atlas, "lion");
 
     // Spawn lake
     Obstacle obstacle;
@@ -119,8 +161,14 @@ void on_enter(engine::Engine@ engine, game::Game@ game) {
         game_state.obstacles.insertLast(obstacle);
     }
 
+    for (uint i = 0; i < game_state.obstacles.length(); ++i) {
+        game_state.obstacle_center_x.insertLast(game_state.obstacles[i].position.x);
+        game_state.obstacle_center_y.insertLast(game_state.obstacles[i].position.y);
+        game_state.obstacle_radius.insertLast(game_state.obstacles[i].radius);
+    }
+
     // Spawn giraffes
-    spawn_giraffes(engine, game, 1000);
+    spawn_giraffes(engine, game, game.initial_giraffes != 0 ? int(game.initial_giraffes) : 1000);
 
     // Spawn food
     {
@@ -173,6 +221,7 @@ void update_mob(Mob@ mob, game::Game@ game, float dt) {
     const glm::vec2 acceleration = steering_force / mob.mass;
 
     mob.velocity = glm::truncate(mob.velocity + acceleration, mob.max_speed);
+    mob.previous_position = mob.position;
     mob.position = mob.position + mob.velocity * dt;
 
     if (glm::length(mob.velocity) > 0.001f) {
@@ -202,39 +251,11 @@ glm::vec2 avoidance_behavior(const Mob@ mob, engine::Engine@ engine) {
     const glm::vec2 left_start = origin + left_vector * mob.radius;
     const glm::vec2 right_start = origin + right_vector * mob.radius;
 
-    bool left_intersects = false;
-    glm::vec2 left_intersection;
-    float left_intersection_distance = 1000000.0f; // large enough
-
-    bool right_intersects = false;
-    glm::vec2 right_intersection;
-    float right_intersection_distance = 1000000.0f; // large enough
-
-    // check against each obstacle
-    for (uint i = 0; i < game_state.obstacles.length(); ++i) {
-        Obstacle@ obstacle = @game_state.obstacles[i];
-        glm::vec2 li;
-        bool did_li = ray_circle_intersection(left_start, forward, obstacle.position, obstacle.radius, li);
-        if (did_li) {
-            float distance = glm::length(li - left_start);
-            if (distance <= look_ahead_distance && distance < left_intersection_distance) {
-                left_intersects = true;
-                left_intersection = li;
-                left_intersection_distance = distance;
-            }
-        }
+    float left_intersection_distance; // FLT_MAX if there's no hit
+    const bool left_intersects = glm::ray_circles_intersection(left_start, forward, game_state.obstacle_center_x, game_state.obstacle_center_y, game_state.obstacle_radius, look_ahead_distance, left_intersection_distance);
 
-        glm::vec2 ri;
-        bool did_ri = ray_circle_intersection(right_start, forward, obstacle.position, obstacle.radius, ri);
-        if (did_ri) {
-            float distance = glm::length(ri - right_start);
-            if (distance <= look_ahead_distance && distance < right_intersection_distance) {
-                right_intersects = true;
-                right_intersection = li;
-                right_intersection_distance = distance;
-            }
-        }
-    }
+    float right_intersection_distance; // FLT_MAX if there's no hit
+    const bool right_intersects = glm::ray_circles_intersection(right_start, forward, game_state.obstacle_center_x, game_state.obstacle_center_y, game_state.obstacle_radius, look_ahead_distance, right_intersection_distance);
 
     glm::vec2 avoidance_force = glm::vec2(0.0f, 0.0f);
 
@@ -342,9 +363,8 @@ void update_giraffe(Giraffe@ giraffe, engine::Engine@ engine, game::Game@ game,
 
     update_mob(giraffe.mob, game, dt);
 
-    const engine::AtlasFrame@ giraffe_frame = engine::atlas_frame(game.sprites.atlas, "giraffe");
+    const engine::AtlasFrame@ giraffe_frame = game_state.giraffe_frame;
 
-    glm::mat4 transform = glm::mat4(1.0f);
     bool flip_x = giraffe.mob.velocity.x <= 0.0f;
     bool flip_y = giraffe.dead;
 
@@ -359,12 +379,14 @@ void update_giraffe(Giraffe@ giraffe, engine::Engine@ engine, game::Game@ game,
         y_offset *= -1.0f;
     }
 
-    transform = glm::translate(transform, glm::vec3(
-        floor(giraffe.mob.position.x - x_offset),
-        floor(giraffe.mob.position.y - y_offset),
-        GIRAFFE_Z_LAYER));
-    transform = glm::scale(transform, glm::vec3((flip_x ? -1.0f : 1.0f) * giraffe_frame.rect.size.x, (flip_y ? -1.0f : 1.0f) * giraffe_frame.rect.size.y, 1.0f));
-    engine::transform_sprite(game.sprites, giraffe.sprite_id, math::Matrix4f(transform));
+    game_state.sprite_transforms.add(
+        giraffe.sprite_id,
+        giraffe.mob,
+        x_offset,
+        y_offset,
+        (flip_x ? -1.0f : 1.0f) * giraffe_frame.rect.size.x,
+        (flip_y ? -1.0f : 1.0f) * giraffe_frame.rect.size.y,
+        GIRAFFE_Z_LAYER);
 }
 
 void update_lion(Lion@ lion, engine::Engine@ engine, game::Game@ game, float t, float dt) {
@@ -435,9 +457,8 @@ void update_lion(Lion@ lion, engine::Engine@ engine, game::Game@ game, float t,
 
     update_mob(lion.mob, game, dt);
 
-    const engine::AtlasFrame@ lion_frame = engine::atlas_frame(game.sprites.atlas, "lion");
+    const engine::AtlasFrame@ lion_frame = game_state.lion_frame;
 
-    glm::mat4 transform = glm::mat4(1.0f);
     bool flip = false;
     if (lion.locked_giraffe !is null) {
         if (lion.locked_giraffe.mob.position.x < lion.mob.position.x) {
@@ -450,21 +471,33 @@ void update_lion(Lion@ lion, engine::Engine@ engine, game::Game@ game, float t,
         x_offset *= -1.0f;
     }
 
-    transform = glm::translate(transform, glm::vec3(
-        floor(lion.mob.position.x - x_offset),
-        floor(lion.mob.position.y - lion_frame.rect.size.y * (1.0f - lion_frame.pivot.y)),
-        LION_Z_LAYER));
-    transform = glm::scale(transform, glm::vec3((flip ? -1.0f : 1.0f) * lion_frame.rect.size.x, lion_frame.rect.size.y, 1.0f));
-    engine::transform_sprite(game.sprites, lion.sprite_id, math::Matrix4f(transform));
+    game_state.sprite_transforms.add(
+        lion.sprite_id,
+        lion.mob,
+        x_offset,
+        lion_frame.rect.size.y * (1.0f - lion_frame.pivot.y),
+        (flip ? -1.0f : 1.0f) * lion_frame.rect.size.x,
+        lion_frame.rect.size.y,
+        LION_Z_LAYER);
 }
 
 void update(engine::Engine@ engine, game::Game@ game, float t, float dt) {
+    game_state.sprite_transforms.clear();
+
     for (uint i = 0; i < game_state.giraffes.length(); ++i) {
         Giraffe@ other_giraffe = @game_state.giraffes[i];
         update_giraffe(other_giraffe, engine, game, dt);
     }
 
     update_lion(game_state.lion, engine, game, t, dt);
+}
+
+// Transforms the sprites alpha of the way from where the last tick started to where it ended, once per frame however
+// many ticks it ran.
+void interpolate(engine::Engine@ engine, game::Game@ game, float t, float dt, float alpha) {
+    SpriteTransforms@ transforms = game_state.sprite_transforms;
+    transforms.interpolate(alpha);
+    engine::transform_sprites(game.sprites, transforms.sprite_id, transforms.x, transforms.y, transforms.scale_x, transforms.scale_y, transforms.z);
 
     engine::update_sprites(game.sprites, t, dt);
     engine::commit_sprites(game.sprites);
@@ -474,6 +507,17 @@ void render(engine::Engine@ engine, game::Game@ game) {
     engine::render_sprites(engine, game.sprites);
 }
 
+// Hands the simulation state to the state hasher, the lion first, then the food, then every giraffe in spawn order.
+void hash_state(engine::Engine@ engine, game::Game@ game) {
+    game::hash_lion(game, game_state.lion.mob.position, game_state.lion.mob.velocity, game_state.lion.energy);
+    game::hash_food(game, game_state.food.position);
+
+    for (uint i = 0; i < game_state.giraffes.length(); ++i) {
+        Giraffe@ giraffe = @game_state.giraffes[i];
+        game::hash_giraffe(game, i, giraffe.dead, giraffe.mob.position, giraffe.mob.velocity);
+    }
+}
+
 void render_imgui(engine::Engine@ engine, game::Game@ game) {
     ImDrawList@ draw_list = ImGui::GetForegroundDrawList();
     
@@ -486,3 +530,73 @@ void render_imgui(engine::Engine@ engine, game::Game@ game) {
         draw_list.AddCircle(position, obstacle.radius, obstacle_color, 0, 2.0f);
     }
 }
+
+// Times calls to the bound primitives for the bridge benchmark, starting with the empty loop that's subtracted from the others.
+void bridge_bench(engine::Engine@ engine, game::Game@ game, uint32 calls) {
+    const glm::vec2 a = glm::vec2(1.0f, 2.0f);
+    const glm::vec2 b = glm::vec2(3.0f, 4.0f);
+    const glm::vec2 origin = glm::vec2(0.0f, 0.0f);
+    const glm::vec2 direction = glm::vec2(1.0f, 0.0f);
+    array<float> center_x = {10.0f};
+    array<float> center_y = {0.0f};
+    array<float> radius = {5.0f};
+    const math::Matrix4f matrix = math::Matrix4f(glm::mat4(1.0f));
+    const uint64 sprite_id = game_state.lion.sprite_id;
+    glm::vec2 v;
+    float distance = 0.0f;
+    float x = 0.0f;
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        v = a;
+    }
+    game::bench_end(game, "loop", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        v = a + b;
+    }
+    game::bench_end(game, "vec2 add", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        v = a * 2.0f;
+    }
+    game::bench_end(game, "vec2 mul", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        v = glm::normalize(a);
+    }
+    game::bench_end(game, "normalize", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        v = glm::truncate(b, 1.0f);
+    }
+    game::bench_end(game, "truncate", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        glm::ray_circles_intersection(origin, direction, center_x, center_y, radius, 100.0f, distance);
+    }
+    game::bench_end(game, "ray_circles_intersection", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        engine::transform_sprite(game.sprites, sprite_id, matrix);
+    }
+    game::bench_end(game, "transform_sprite", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        engine::atlas_frame(game.sprites.atlas, "giraffe");
+    }
+    game::bench_end(game, "atlas_frame", calls);
+
+    game::bench_begin(game);
+    for (uint32 i = 0; i < calls; ++i) {
+        x = engine.window_rect.size.x;
+    }
+    game::bench_end(game, "window_rect", calls);
+}
@@ -13,6 +13,8 @@ const Sprites = extern struct {};
 const Mob = struct {
     mass: f32 = 100.0,
     position: c.Vector2f = c.Vector2f{ .x = 0, .y = 0 },
+    // Where the mob was before the last tick, which its sprite is interpolated from.
+    previous_position: c.Vector2f = c.Vector2f{ .x = 0, .y = 0 },
     velocity: c.Vector2f = c.Vector2f{ .x = 0, .y = 0 },
     steering_direction: c.Vector2f = c.Vector2f{ .x = 0, .y = 0 },
     steering_target: c.Vector2f = c.Vector2f{ .x = 0, .y = 0 },
@@ -47,11 +49,64 @@ const Obstacle = struct {
     color: c.Color4f = c.Color4f{ .r = 0, .g = 0, .b = 0, .a = 0 },
 };
 
-var gpa = std.heap.GeneralPurposeAllocator(.{}){};
-const allocator = gpa.allocator();
+// Allocates through the game's allocator, so the profiler counts what the script allocates.
+const GameAllocator = struct {
+    fn alloc(ctx: *anyopaque, len: usize, ptr_align: u8, ret_addr: usize) ?[*]u8 {
+        _ = ctx;
+        _ = ret_addr;
+        const alignment = @as(u32, 1) << @intCast(ptr_align);
+        const p = c.Game_allocate(@intCast(len), alignment) orelse return null;
+        return @ptrCast(p);
+    }
+
+    // Shrinking keeps the allocation, growing always moves it.
+    fn resize(ctx: *anyopaque, buf: []u8, buf_align: u8, new_len: usize, ret_addr: usize) bool {
+        _ = ctx;
+        _ = buf_align;
+        _ = ret_addr;
+        return new_len <= buf.len;
+    }
+
+    fn free(ctx: *anyopaque, buf: []u8, buf_align: u8, ret_addr: usize) void {
+        _ = ctx;
+        _ = buf_align;
+        _ = ret_addr;
+        c.Game_deallocate(buf.ptr);
+    }
+};
+
+const allocator = std.mem.Allocator{
+    .ptr = undefined,
+    .vtable = &.{
+        .alloc = GameAllocator.alloc,
+        .resize = GameAllocator.resize,
+        .free = GameAllocator.free,
+    },
+};
 
 var g_giraffes = std.ArrayList(Giraffe).init(allocator);
 var g_obstacles = std.ArrayList(Obstacle).init(allocator);
+// The obstacle circles as arrays for ray_circles_intersection_vec2, copied once since obstacles don't move.
+var g_obstacle_center_x = std.ArrayList(f32).init(allocator);
+var g_obstacle_center_y = std.ArrayList(f32).init(allocator);
+var g_obstacle_radius = std.ArrayList(f32).init(allocator);
+// Sprite transforms added during update, and passed to Engine_transform_sprites all at once by script_interpolate,
+// which fills in x and y between where the sprites were before and after the last tick.
+var g_sprite_transform_ids = std.ArrayList(u64).init(allocator);
+var g_sprite_transform_previous_x = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_previous_y = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_position_x = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_position_y = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_x_offset = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_y_offset = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_x = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_y = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_scale_x = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_scale_y = std.ArrayList(f32).init(allocator);
+var g_sprite_transform_z = std.ArrayList(f32).init(allocator);
+// Atlas frames looked up once in script_enter, instead of by name for every sprite in every update.
+var g_giraffe_frame: [*c]const c.AtlasFrame = null;
+var g_lion_frame: [*c]const c.AtlasFrame = null;
 var g_food: Food = Food{};
 var g_lion: Lion = Lion{};
 
@@ -60,6 +115,21 @@ const LION_Z_LAYER: i32 = -1;
 const GIRAFFE_Z_LAYER: i32 = -2;
 const FOOD_Z_LAYER: i32 = -3;
 
+fn add_sprite_transform(sprite_id: u64, mob: *const Mob, x_offset: f32, y_offset: f32, scale_x: f32, scale_y: f32, z: f32) void {
+    g_sprite_transform_ids.append(sprite_id) catch unreachable;
+    g_sprite_transform_previous_x.append(mob.previous_position.x) catch unreachable;
+    g_sprite_transform_previous_y.append(mob.previous_position.y) catch unreachable;
+    g_sprite_transform_position_x.append(mob.position.x) catch unreachable;
+    g_sprite_transform_position_y.append(mob.position.y) catch unreachable;
+    g_sprite_transform_x_offset.append(x_offset) catch unreachable;
+    g_sprite_transform_y_offset.append(y_offset) catch unreachable;
+    g_sprite_transform_x.append(0.0) catch unreachable;
+    g_sprite_transform_y.append(0.0) catch unreachable;
+    g_sprite_transform_scale_x.append(scale_x) catch unreachable;
+    g_sprite_transform_scale_y.append(scale_y) catch unreachable;
+    g_sprite_transform_z.append(z) catch unreachable;
+}
+
 fn update_mob(mob: *Mob, game: *Game, dt: f32) void {
     _ = game;
 
@@ -78,6 +148,7 @@ fn update_mob(mob: *Mob, game: *Game, dt: f32) void {
     const acceleration: c.Vector2f = c.divide_vec2(steering_force, mob.mass);
 
     mob.velocity = c.truncate_vec2(c.add_vec2(mob.velocity, acceleration), mob.max_speed);
+    mob.previous_position = mob.position;
     mob.position = c.add_vec2(mob.position, c.multiply_vec2_factor(mob.velocity, dt));
 }
 
@@ -102,38 +173,13 @@ fn avoidance_behavior(mob: *Mob) c.Vector2f {
     const left_start = c.add_vec2(origin, c.multiply_vec2_factor(left_vector, mob.radius));
     const right_start = c.add_vec2(origin, c.multiply_vec2_factor(right_vector, mob.radius));
 
-    var left_intersects: bool = false;
-    var left_intersection: ?c.Vector2f = null;
+    const count: u32 = @intCast(g_obstacles.items.len);
+
     var left_intersection_distance: f32 = 100000.0;
+    const left_intersects = c.ray_circles_intersection_vec2(left_start, forward, g_obstacle_center_x.items.ptr, g_obstacle_center_y.items.ptr, g_obstacle_radius.items.ptr, count, look_ahead_distance, &left_intersection_distance);
 
-    var right_intersects: bool = false;
-    var right_intersection: ?c.Vector2f = null;
     var right_intersection_distance: f32 = 100000.0;
-
-    // check against each obstacle
-    for (g_obstacles.items) |obstacle| {
-        var li = c.Vector2f{ .x = 0, .y = 0 };
-        const did_li = c.ray_circle_intersection_vec2(left_start, forward, obstacle.position, obstacle.radius, &li);
-        if (did_li) {
-            const distance = c.length_vec2(c.subtract_vec2(li, left_start));
-            if (distance <= look_ahead_distance and distance < left_intersection_distance) {
-                left_intersects = true;
-                left_intersection = li;
-                left_intersection_distance = distance;
-            }
-        }
-
-        var ri = c.Vector2f{ .x = 0, .y = 0 };
-        const did_ri = c.ray_circle_intersection_vec2(right_start, forward, obstacle.position, obstacle.radius, &ri);
-        if (did_ri) {
-            const distance = c.length_vec2(c.subtract_vec2(ri, right_start));
-            if (distance <= look_ahead_distance and distance < right_intersection_distance) {
-                right_intersects = true;
-                right_intersection = ri;
-                right_intersection_distance = distance;
-            }
-        }
-    }
+    const right_intersects = c.ray_circles_intersection_vec2(right_start, forward, g_obstacle_center_x.items.ptr, g_obstacle_center_y.items.ptr, g_obstacle_radius.items.ptr, count, look_ahead_distance, &right_intersection_distance);
 
     var avoidance_force = c.Vector2f{ .x = 0, .y = 0 };
 
@@ -240,12 +286,10 @@ fn update_giraffe(giraffe: *Giraffe, engine: *Engine, game: *Game, dt: f32) void
 
     update_mob(&giraffe.mob, game, dt);
 
-    const sprites = c.get_sprites(game);
-    const giraffe_frame = c.Engine_atlas_frame(c.get_atlas(game), "giraffe");
+    const giraffe_frame = g_giraffe_frame;
     const frame_rect_w = @as(f32, @floatFromInt(giraffe_frame.*.rect.size.x));
     const frame_rect_h = @as(f32, @floatFromInt(giraffe_frame.*.rect.size.y));
 
-    var transform: c.Matrix4f = c.Matrix4f_Identity();
     const flip_x: bool = giraffe.mob.velocity.x <= 0.0;
     const flip_y: bool = giraffe.dead == true;
     var x_offset: f32 = frame_rect_w * giraffe_frame.*.pivot.x;
@@ -259,22 +303,10 @@ fn update_giraffe(giraffe: *Giraffe, engine: *Engine, game: *Game, dt: f32) void
         y_offset *= -1.0;
     }
 
-    transform = c.translate(transform, c.Vector3f{
-        .x = giraffe.mob.position.x - x_offset,
-        .y = giraffe.mob.position.y - y_offset,
-        .z = GIRAFFE_Z_LAYER,
-    });
-
     const scale_x = if (flip_x) -1.0 * frame_rect_w else frame_rect_w;
     const scale_y = if (flip_y) -1.0 * frame_rect_h else frame_rect_h;
 
-    transform = c.scale(transform, c.Vector3f{
-        .x = scale_x,
-        .y = scale_y,
-        .z = 1.0,
-    });
-
-    c.Engine_transform_sprite(sprites, giraffe.sprite_id, transform);
+    add_sprite_transform(giraffe.sprite_id, &giraffe.mob, x_offset, y_offset, scale_x, scale_y, GIRAFFE_Z_LAYER);
 }
 
 fn update_lion(lion: *Lion, engine: *Engine, game: *Game, dt: f32) void {
@@ -346,12 +378,10 @@ fn update_lion(lion: *Lion, engine: *Engine, game: *Game, dt: f32) void {
 
     update_mob(&lion.mob, game, dt);
 
-    const sprites = c.get_sprites(game);
-    const lion_frame = c.Engine_atlas_frame(c.get_atlas(game), "lion");
+    const lion_frame = g_lion_frame;
     const frame_rect_w = @as(f32, @floatFromInt(lion_frame.*.rect.size.x));
     const frame_rect_h = @as(f32, @floatFromInt(lion_frame.*.rect.size.y));
 
-    var transform: c.Matrix4f = c.Matrix4f_Identity();
     const flip_x: bool = lion.mob.velocity.x <= 0.0;
     var x_offset: f32 = frame_rect_w * lion_frame.*.pivot.x;
     const y_offset: f32 = frame_rect_h * (1.0 - lion_frame.*.pivot.y);
@@ -360,26 +390,18 @@ fn update_lion(lion: *Lion, engine: *Engine, game: *Game, dt: f32) void {
         x_offset *= -1.0;
     }
 
-    transform = c.translate(transform, c.Vector3f{
-        .x = lion.mob.position.x - x_offset,
-        .y = lion.mob.position.y - y_offset,
-        .z = LION_Z_LAYER,
-    });
-
     const scale_x = if (flip_x) -1.0 * frame_rect_w else frame_rect_w;
     const scale_y = frame_rect_h;
 
-    transform = c.scale(transform, c.Vector3f{
-        .x = scale_x,
-        .y = scale_y,
-        .z = 1.0,
-    });
-
-    c.Engine_transform_sprite(sprites, lion.sprite_id, transform);
+    add_sprite_transform(lion.sprite_id, &lion.mob, x_offset, y_offset, scale_x, scale_y, LION_Z_LAYER);
 }
 
 export fn script_enter(engine: *Engine, game: *Game) void {
-    c.rnd_pcg_seed(&RANDOM_DEVICE, 100);
+    const random_seed = c.get_random_seed(game);
+    c.rnd_pcg_seed(&RANDOM_DEVICE, if (random_seed != 0) random_seed else 100);
+
+    g_giraffe_frame = c.Engine_atlas_frame(c.get_atlas(game), "giraffe");
+    g_lion_frame = c.Engine_atlas_frame(c.get_atlas(game), "lion");
 
     const window_rect = c.glfw_window_rect(engine);
     const window_res_w: f32 = @floatFromInt(window_rect.size.x);
@@ -412,8 +434,15 @@ export fn script_enter(engine: *Engine, game: *Game) void {
         g_obstacles.append(obstacle) catch unreachable;
     }
 
+    for (g_obstacles.items) |obstacle| {
+        g_obstacle_center_x.append(obstacle.position.x) catch unreachable;
+        g_obstacle_center_y.append(obstacle.position.y) catch unreachable;
+        g_obstacle_radius.append(obstacle.radius) catch unreachable;
+    }
+
     // Spawn giraffes
-    for (0..1000) |_| {
+    const initial_giraffes = c.get_initial_giraffes(game);
+    for (0..if (initial_giraffes != 0) initial_giraffes else 1000) |_| {
         const x: f32 = c.rnd_pcg_nextf(&RANDOM_DEVICE) * (window_res_w - 100);
         const y: f32 = c.rnd_pcg_nextf(&RANDOM_DEVICE) * (window_res_h - 100);
 
@@ -473,13 +502,42 @@ export fn script_leave(engine: *Engine, game: *Game) void {
 export fn script_on_input() void {}
 
 export fn script_update(engine: *Engine, game: *Game, t: f32, dt: f32) void {
+    _ = t;
+
+    g_sprite_transform_ids.clearRetainingCapacity();
+    g_sprite_transform_previous_x.clearRetainingCapacity();
+    g_sprite_transform_previous_y.clearRetainingCapacity();
+    g_sprite_transform_position_x.clearRetainingCapacity();
+    g_sprite_transform_position_y.clearRetainingCapacity();
+    g_sprite_transform_x_offset.clearRetainingCapacity();
+    g_sprite_transform_y_offset.clearRetainingCapacity();
+    g_sprite_transform_x.clearRetainingCapacity();
+    g_sprite_transform_y.clearRetainingCapacity();
+    g_sprite_transform_scale_x.clearRetainingCapacity();
+    g_sprite_transform_scale_y.clearRetainingCapacity();
+    g_sprite_transform_z.clearRetainingCapacity();
+
     for (g_giraffes.items) |*giraffe| {
         update_giraffe(giraffe, engine, game, dt);
     }
 
     update_lion(&g_lion, engine, game, dt);
+}
+
+// Transforms the sprites alpha of the way from where the last tick started to where it ended, once per frame however
+// many ticks it ran.
+export fn script_interpolate(engine: *Engine, game: *Game, t: f32, dt: f32, alpha: f32) void {
+    _ = engine;
+
+    for (g_sprite_transform_x.items, g_sprite_transform_y.items, 0..) |*x, *y, i| {
+        x.* = g_sprite_transform_previous_x.items[i] * (1.0 - alpha) + g_sprite_transform_position_x.items[i] * alpha - g_sprite_transform_x_offset.items[i];
+        y.* = g_sprite_transform_previous_y.items[i] * (1.0 - alpha) + g_sprite_transform_position_y.items[i] * alpha - g_sprite_transform_y_offset.items[i];
+    }
 
     const sprites = c.get_sprites(game);
+    const count: u32 = @intCast(g_sprite_transform_ids.items.len);
+    c.Engine_transform_sprites(sprites, g_sprite_transform_ids.items.ptr, g_sprite_transform_x.items.ptr, g_sprite_transform_y.items.ptr, g_sprite_transform_scale_x.items.ptr, g_sprite_transform_scale_y.items.ptr, g_sprite_transform_z.items.ptr, count);
+
     c.Engine_update_sprites(sprites, t, dt);
     c.Engine_commit_sprites(sprites);
 }
@@ -493,3 +551,104 @@ export fn script_render_imgui(engine: *Engine, game: *Game) void {
     _ = engine;
     _ = game;
 }
+
+// Hands the simulation state to the state hasher, the lion first, then the food, then every giraffe in spawn order.
+export fn script_hash_state(engine: *Engine, game: *Game) void {
+    _ = engine;
+
+    c.Game_hash_lion(game, g_lion.mob.position, g_lion.mob.velocity, g_lion.energy);
+    c.Game_hash_food(game, g_food.position);
+
+    for (g_giraffes.items, 0..) |*giraffe, i| {
+        c.Game_hash_giraffe(game, @intCast(i), giraffe.dead, giraffe.mob.position, giraffe.mob.velocity);
+    }
+}
+
+// Times calls to the bound primitives for the bridge benchmark, starting with the empty loop that's subtracted from the others.
+export fn script_bridge_bench(engine: *Engine, game: *Game, calls: u32) void {
+    const a = c.Vector2f{ .x = 1.0, .y = 2.0 };
+    const b = c.Vector2f{ .x = 3.0, .y = 4.0 };
+    const origin = c.Vector2f{ .x = 0.0, .y = 0.0 };
+    const direction = c.Vector2f{ .x = 1.0, .y = 0.0 };
+    const center = c.Vector2f{ .x = 10.0, .y = 0.0 };
+    const center_x = [_]f32{10.0};
+    const center_y = [_]f32{0.0};
+    const radius = [_]f32{5.0};
+    const transform = c.Matrix4f_Identity();
+    const sprites = c.get_sprites(game);
+    const atlas = c.get_atlas(game);
+
+    var i: u32 = 0;
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(a);
+    }
+    c.Game_bench_end(game, "loop", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(c.add_vec2(a, b));
+    }
+    c.Game_bench_end(game, "vec2 add", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(c.multiply_vec2_factor(a, 2.0));
+    }
+    c.Game_bench_end(game, "vec2 mul", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(c.normalize_vec2(a));
+    }
+    c.Game_bench_end(game, "normalize", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(c.truncate_vec2(b, 1.0));
+    }
+    c.Game_bench_end(game, "truncate", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        var intersection = c.Vector2f{ .x = 0.0, .y = 0.0 };
+        std.mem.doNotOptimizeAway(c.ray_circle_intersection_vec2(origin, direction, center, 5.0, &intersection));
+    }
+    c.Game_bench_end(game, "ray_circle_intersection", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        var distance: f32 = 0.0;
+        std.mem.doNotOptimizeAway(c.ray_circles_intersection_vec2(origin, direction, &center_x, &center_y, &radius, 1, 100.0, &distance));
+    }
+    c.Game_bench_end(game, "ray_circles_intersection", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        c.Engine_transform_sprite(sprites, g_lion.sprite_id, transform);
+    }
+    c.Game_bench_end(game, "transform_sprite", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(c.Engine_atlas_frame(atlas, "giraffe"));
+    }
+    c.Game_bench_end(game, "atlas_frame", calls);
+
+    c.Game_bench_begin(game);
+    i = 0;
+    while (i < calls) : (i += 1) {
+        std.mem.doNotOptimizeAway(c.glfw_window_rect(engine));
+    }
+    c.Game_bench_end(game, "window_rect", calls);
+}
@@ -27,6 +27,7 @@ if ffi then
         vec2 glm_divide_vec2_scalar(const vec2 lhs, const float rhs);
         
         bool glm_ray_circle_intersection(const vec2 ray_origin, const vec2 ray_direction, const vec2 circle_center, float circle_radius, vec2 *intersection);
+        bool glm_ray_circles_intersection(const vec2 ray_origin, const vec2 ray_direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance);
         bool glm_ray_line_intersection(const vec2 ray_origin, const vec2 ray_direction, const vec2 p1, const vec2 p2, vec2 *intersection);
         vec2 glm_truncate(const vec2 v, float max_length);
         vec2 glm_normalize(const vec2 v);
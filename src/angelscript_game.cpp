@@ -4,6 +4,8 @@
 
 #include "game.h"
 
+#include "simd.h"
+#include "sprite_transforms.h"
 #include "util.h"
 
 #include "array.h"
@@ -42,10 +44,29 @@ asIScriptFunction *on_enter_func = nullptr;
 asIScriptFunction *on_leave_func = nullptr;
 asIScriptFunction *on_input_func = nullptr;
 asIScriptFunction *update_func = nullptr;
+asIScriptFunction *interpolate_func = nullptr;
 asIScriptFunction *render_func = nullptr;
 asIScriptFunction *render_imgui_func = nullptr;
+asIScriptFunction *hash_state_func = nullptr;
+asIScriptFunction *bridge_bench_func = nullptr;
 asIScriptContext *ctx = nullptr;
 rnd_pcg_t random_device;
+
+// The allocator behind every allocation made by AngelScript itself.
+foundation::Allocator *script_allocator = nullptr;
+
+// Allocates for AngelScript, aligned for any type it stores.
+void *script_alloc(size_t size) {
+    void *p = script_allocator->allocate((uint32_t)size, 16);
+    if (!p) {
+        log_fatal("Could not allocate memory");
+    }
+    return p;
+}
+
+void script_free(void *p) {
+    script_allocator->deallocate(p);
+}
 } // namespace
 
 void message_callback(const asSMessageInfo *msg, void *param) {
@@ -80,6 +101,28 @@ void transform_sprite_wrapper(engine::Sprites *sprites, uint64_t sprite_id, math
     engine::transform_sprite(*sprites, sprite_id, transform);
 }
 
+void transform_sprites_wrapper(engine::Sprites *sprites, const CScriptArray *sprite_ids, const CScriptArray *x, const CScriptArray *y, const CScriptArray *scale_x, const CScriptArray *scale_y, const CScriptArray *z) {
+    if (!sprite_ids || !x || !y || !scale_x || !scale_y || !z) {
+        asGetActiveContext()->SetException("transform_sprites needs six arrays, got a null handle");
+        return;
+    }
+
+    const asUINT count = sprite_ids->GetSize();
+    if (x->GetSize() != count || y->GetSize() != count || scale_x->GetSize() != count || scale_y->GetSize() != count || z->GetSize() != count) {
+        asGetActiveContext()->SetException("transform_sprites needs arrays of the same length");
+        return;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    game::transform_sprites(*sprites, static_cast<const uint64_t *>(sprite_ids->At(0)),
+                            static_cast<const float *>(x->At(0)), static_cast<const float *>(y->At(0)),
+                            static_cast<const float *>(scale_x->At(0)), static_cast<const float *>(scale_y->At(0)),
+                            static_cast<const float *>(z->At(0)), count);
+}
+
 void color_sprite_wrapper(engine::Sprites *sprites, uint64_t sprite_id, math::Color4f color) {
     engine::color_sprite(*sprites, sprite_id, color);
 }
@@ -92,6 +135,26 @@ void render_sprites_wrapper(engine::Engine *engine, engine::Sprites *sprites) {
     engine::render_sprites(*engine, *sprites);
 }
 
+void hash_lion_wrapper(game::Game *game, const glm::vec2 &position, const glm::vec2 &velocity, float energy) {
+    game::state_hash::lion(game->state_hasher, position.x, position.y, velocity.x, velocity.y, energy);
+}
+
+void hash_food_wrapper(game::Game *game, const glm::vec2 &position) {
+    game::state_hash::food(game->state_hasher, position.x, position.y);
+}
+
+void hash_giraffe_wrapper(game::Game *game, uint32_t id, bool dead, const glm::vec2 &position, const glm::vec2 &velocity) {
+    game::state_hash::giraffe(game->state_hasher, id, dead, position.x, position.y, velocity.x, velocity.y);
+}
+
+void bench_begin_wrapper(game::Game *game) {
+    game::bridge_bench::begin(game->bridge_bench);
+}
+
+void bench_end_wrapper(game::Game *game, const std::string &primitive, uint32_t calls) {
+    game::bridge_bench::end(game->bridge_bench, primitive.c_str(), calls);
+}
+
 void vec2_default(void *memory) {
     new (memory) glm::vec2();
 }
@@ -122,6 +185,32 @@ float vec2_dot(const glm::vec2 &x, const glm::vec2 &y) {
     return glm::dot(x, y);
 }
 
+// The circles are three arrays of the same length, the script keeps them around for circles that don't move.
+// Script out references are always copied back, so a miss sets the distance to FLT_MAX. Null handles or arrays of
+// different lengths raise a script exception instead of reaching the kernel.
+bool vec2_ray_circles_intersection(const glm::vec2 &ray_origin, const glm::vec2 &ray_direction, const CScriptArray *center_x, const CScriptArray *center_y, const CScriptArray *radius, float max_distance, float &distance) {
+    distance = FLT_MAX;
+
+    if (!center_x || !center_y || !radius) {
+        asGetActiveContext()->SetException("ray_circles_intersection needs three arrays, got a null handle");
+        return false;
+    }
+
+    const asUINT count = center_x->GetSize();
+    if (center_y->GetSize() != count || radius->GetSize() != count) {
+        asGetActiveContext()->SetException("ray_circles_intersection needs arrays of the same length");
+        return false;
+    }
+
+    if (count == 0) {
+        return false;
+    }
+
+    return simd::best_kernels().ray_circles(ray_origin.x, ray_origin.y, ray_direction.x, ray_direction.y,
+                                            static_cast<const float *>(center_x->At(0)), static_cast<const float *>(center_y->At(0)), static_cast<const float *>(radius->At(0)),
+                                            count, max_distance, &distance);
+}
+
 void vec3_default(void *memory) {
     new (memory) glm::vec3();
 }
@@ -191,14 +280,21 @@ void initialize(foundation::Allocator &allocator) {
 
     log_info("Initializing angelscript");
 
+    // The memory functions are global to the library, and have to be set before the engine is created.
+    script_allocator = &allocator;
+    int r = asSetGlobalMemoryFunctions(script_alloc, script_free);
+    assert(r >= 0);
+
+    game::startup::begin("asCreateScriptEngine");
     script_engine = asCreateScriptEngine();
-    int r = script_engine->SetMessageCallback(asFUNCTION(message_callback), 0, asCALL_CDECL);
+    r = script_engine->SetMessageCallback(asFUNCTION(message_callback), 0, asCALL_CDECL);
     assert(r >= 0);
 
     RegisterScriptArray(script_engine, true);
     RegisterStdString(script_engine);
     RegisterScriptHandle(script_engine);
     RegisterScriptMath(script_engine);
+    game::startup::end();
 
     // Register functions
 
@@ -211,13 +307,16 @@ void initialize(foundation::Allocator &allocator) {
     r = builder.StartNewModule(script_engine, "MyModule");
     assert(r >= 0);
 
+    game::startup::begin("AddSectionFromFile scripts/script.as");
     r = builder.AddSectionFromFile("scripts/script.as");
     assert(r >= 0);
+    game::startup::end();
 
     asIScriptModule *mod = script_engine->GetModule("MyModule");
 
     // Context
 
+    game::startup::begin("register namespaces and types");
     ctx = script_engine->CreateContext();
     assert(ctx);
 
@@ -318,6 +417,8 @@ void initialize(foundation::Allocator &allocator) {
 
         r = script_engine->RegisterGlobalFunction("vec2 truncate(const vec2 &in, float)", asFUNCTION(truncate), asCALL_CDECL);
         assert(r >= 0);
+        r = script_engine->RegisterGlobalFunction("bool ray_circles_intersection(const vec2 &in, const vec2 &in, const array<float>@, const array<float>@, const array<float>@, float, float &out)", asFUNCTION(vec2_ray_circles_intersection), asCALL_CDECL);
+        assert(r >= 0);
 
         r = script_engine->SetDefaultNamespace("");
         assert(r >= 0);
@@ -480,6 +581,8 @@ void initialize(foundation::Allocator &allocator) {
         assert(r >= 0);
         r = script_engine->RegisterGlobalFunction("void transform_sprite(engine::Sprites@ sprites, uint64 sprite_id, math::Matrix4f)", asFUNCTION(transform_sprite_wrapper), asCALL_CDECL);
         assert(r >= 0);
+        r = script_engine->RegisterGlobalFunction("void transform_sprites(engine::Sprites@ sprites, const array<uint64>@ sprite_ids, const array<float>@ x, const array<float>@ y, const array<float>@ scale_x, const array<float>@ scale_y, const array<float>@ z)", asFUNCTION(transform_sprites_wrapper), asCALL_CDECL);
+        assert(r >= 0);
         r = script_engine->RegisterGlobalFunction("void color_sprite(engine::Sprites@ sprites, uint64 sprite_id, math::Color4f color)", asFUNCTION(color_sprite_wrapper), asCALL_CDECL);
         assert(r >= 0);
         r = script_engine->RegisterGlobalFunction("void update_sprites(engine::Sprites@ sprites, float t, float dt)", asFUNCTION(update_sprites_wrapper), asCALL_CDECL);
@@ -504,6 +607,21 @@ void initialize(foundation::Allocator &allocator) {
 
         r = script_engine->RegisterObjectProperty("Game", "engine::Sprites@ sprites", asOFFSET(game::Game, sprites));
         assert(r >= 0);
+        r = script_engine->RegisterObjectProperty("Game", "uint32 random_seed", asOFFSET(game::Game, random_seed));
+        assert(r >= 0);
+        r = script_engine->RegisterObjectProperty("Game", "uint32 initial_giraffes", asOFFSET(game::Game, initial_giraffes));
+        assert(r >= 0);
+
+        r = script_engine->RegisterGlobalFunction("void hash_lion(Game@ game, const glm::vec2 &in position, const glm::vec2 &in velocity, float energy)", asFUNCTION(hash_lion_wrapper), asCALL_CDECL);
+        assert(r >= 0);
+        r = script_engine->RegisterGlobalFunction("void hash_food(Game@ game, const glm::vec2 &in position)", asFUNCTION(hash_food_wrapper), asCALL_CDECL);
+        assert(r >= 0);
+        r = script_engine->RegisterGlobalFunction("void hash_giraffe(Game@ game, uint32 id, bool dead, const glm::vec2 &in position, const glm::vec2 &in velocity)", asFUNCTION(hash_giraffe_wrapper), asCALL_CDECL);
+        assert(r >= 0);
+        r = script_engine->RegisterGlobalFunction("void bench_begin(Game@ game)", asFUNCTION(bench_begin_wrapper), asCALL_CDECL);
+        assert(r >= 0);
+        r = script_engine->RegisterGlobalFunction("void bench_end(Game@ game, const string &in primitive, uint32 calls)", asFUNCTION(bench_end_wrapper), asCALL_CDECL);
+        assert(r >= 0);
 
         r = script_engine->SetDefaultNamespace("");
         assert(r >= 0);
@@ -551,22 +669,35 @@ void initialize(foundation::Allocator &allocator) {
         assert(r >= 0);
     }
 
+    game::startup::end();
+
     // Build module
 
-    r = builder.BuildModule();
-    assert(r >= 0);
+    {
+        game::StartupScope startup_scope("BuildModule");
+        r = builder.BuildModule();
+        assert(r >= 0);
+    }
 
     // Get functions
     on_enter_func = mod->GetFunctionByDecl("void on_enter(engine::Engine@ engine, game::Game@ game)");
     on_leave_func = mod->GetFunctionByDecl("void on_leave(engine::Engine@ engine, game::Game@ game)");
     update_func = mod->GetFunctionByDecl("void update(engine::Engine@ engine, game::Game@ game, float t, float dt)");
+    interpolate_func = mod->GetFunctionByDecl("void interpolate(engine::Engine@ engine, game::Game@ game, float t, float dt, float alpha)");
     render_func = mod->GetFunctionByDecl("void render(engine::Engine@ engine, game::Game@ game)");
     render_imgui_func = mod->GetFunctionByDecl("void render_imgui(engine::Engine@ engine, game::Game@ game)");
     assert(on_enter_func);
     assert(on_leave_func);
     assert(update_func);
+    assert(interpolate_func);
     assert(render_func);
     assert(render_imgui_func);
+
+    // Only needed for hashing the simulation state.
+    hash_state_func = mod->GetFunctionByDecl("void hash_state(engine::Engine@ engine, game::Game@ game)");
+
+    // Only needed for the bridge benchmark.
+    bridge_bench_func = mod->GetFunctionByDecl("void bridge_bench(engine::Engine@ engine, game::Game@ game, uint32 calls)");
 }
 
 void close() {
@@ -579,6 +710,14 @@ void close() {
         script_engine->ShutDownAndRelease();
         script_engine = nullptr;
         update_func = nullptr;
+        interpolate_func = nullptr;
+        hash_state_func = nullptr;
+        bridge_bench_func = nullptr;
+    }
+
+    if (script_allocator) {
+        asResetGlobalMemoryFunctions();
+        script_allocator = nullptr;
     }
 }
 
@@ -591,6 +730,8 @@ void game_state_playing_enter(engine::Engine &engine, Game &game) {
         ctx->Prepare(on_enter_func);
         ctx->SetArgAddress(0, &engine);
         ctx->SetArgAddress(1, &game);
+        TraceScope trace_scope(game.tracer, "angelscript on_enter");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
         int r = ctx->Execute();
         if (r != asEXECUTION_FINISHED) {
             log_fatal("Could not execute on_enter() in scripts/script.as: %s", ctx->GetExceptionString());
@@ -604,6 +745,8 @@ void game_state_playing_leave(engine::Engine &engine, Game &game) {
         ctx->Prepare(on_leave_func);
         ctx->SetArgAddress(0, &engine);
         ctx->SetArgAddress(1, &game);
+        TraceScope trace_scope(game.tracer, "angelscript on_leave");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
         int r = ctx->Execute();
         if (r != asEXECUTION_FINISHED) {
             log_fatal("Could not execute on_leave() in scripts/script.as: %s", ctx->GetExceptionString());
@@ -617,11 +760,14 @@ void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::Inp
 
 void game_state_playing_update(engine::Engine &engine, Game &game, float t, float dt) {
     if (ctx && update_func) {
+        ProfileScope scope(game.profiler, ProfilePhase::Update);
         ctx->Prepare(update_func);
         ctx->SetArgAddress(0, &engine);
         ctx->SetArgAddress(1, &game);
         ctx->SetArgFloat(2, t);
         ctx->SetArgFloat(3, dt);
+        TraceScope trace_scope(game.tracer, "angelscript update");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
         int r = ctx->Execute();
         if (r != asEXECUTION_FINISHED) {
             log_fatal("Could not execute update() in scripts/script.as: %s", ctx->GetExceptionString());
@@ -630,11 +776,33 @@ void game_state_playing_update(engine::Engine &engine, Game &game, float t, floa
     }
 }
 
+void game_state_playing_interpolate(engine::Engine &engine, Game &game, float t, float dt, float alpha) {
+    if (ctx && interpolate_func) {
+        ProfileScope scope(game.profiler, ProfilePhase::Transforms);
+        ctx->Prepare(interpolate_func);
+        ctx->SetArgAddress(0, &engine);
+        ctx->SetArgAddress(1, &game);
+        ctx->SetArgFloat(2, t);
+        ctx->SetArgFloat(3, dt);
+        ctx->SetArgFloat(4, alpha);
+        TraceScope trace_scope(game.tracer, "angelscript interpolate");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+        int r = ctx->Execute();
+        if (r != asEXECUTION_FINISHED) {
+            log_fatal("Could not execute interpolate() in scripts/script.as: %s", ctx->GetExceptionString());
+        }
+        ctx->Unprepare();
+    }
+}
+
 void game_state_playing_render(engine::Engine &engine, Game &game) {
     if (ctx && update_func) {
+        ProfileScope scope(game.profiler, ProfilePhase::Render);
         ctx->Prepare(render_func);
         ctx->SetArgAddress(0, &engine);
         ctx->SetArgAddress(1, &game);
+        TraceScope trace_scope(game.tracer, "angelscript render");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
         int r = ctx->Execute();
         if (r != asEXECUTION_FINISHED) {
             log_fatal("Could not execute render() in scripts/script.as: %s", ctx->GetExceptionString());
@@ -648,6 +816,8 @@ void game_state_playing_render_imgui(engine::Engine &engine, Game &game) {
         ctx->Prepare(render_imgui_func);
         ctx->SetArgAddress(0, &engine);
         ctx->SetArgAddress(1, &game);
+        TraceScope trace_scope(game.tracer, "angelscript render_imgui");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
         int r = ctx->Execute();
         if (r != asEXECUTION_FINISHED) {
             log_fatal("Could not execute render_imgui() in scripts/script.as: %s", ctx->GetExceptionString());
@@ -656,6 +826,35 @@ void game_state_playing_render_imgui(engine::Engine &engine, Game &game) {
     }
 }
 
+void game_state_playing_hash_state(engine::Engine &engine, Game &game) {
+    if (ctx && hash_state_func) {
+        ctx->Prepare(hash_state_func);
+        ctx->SetArgAddress(0, &engine);
+        ctx->SetArgAddress(1, &game);
+        TraceScope trace_scope(game.tracer, "angelscript hash_state");
+        int r = ctx->Execute();
+        if (r != asEXECUTION_FINISHED) {
+            log_fatal("Could not execute hash_state() in scripts/script.as: %s", ctx->GetExceptionString());
+        }
+        ctx->Unprepare();
+    }
+}
+
+void game_state_playing_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls) {
+    if (ctx && bridge_bench_func) {
+        ctx->Prepare(bridge_bench_func);
+        ctx->SetArgAddress(0, &engine);
+        ctx->SetArgAddress(1, &game);
+        ctx->SetArgDWord(2, calls);
+        TraceScope trace_scope(game.tracer, "angelscript bridge_bench");
+        int r = ctx->Execute();
+        if (r != asEXECUTION_FINISHED) {
+            log_fatal("Could not execute bridge_bench() in scripts/script.as: %s", ctx->GetExceptionString());
+        }
+        ctx->Unprepare();
+    }
+}
+
 } // namespace game
 
 #endif
@@ -0,0 +1,60 @@
+#include "atlas_frames.h"
+
+#include <engine/atlas.h>
+#include <engine/log.h>
+
+#include <hash.h>
+#include <murmur_hash.h>
+
+#include <cassert>
+#include <string.h>
+
+namespace {
+// The name behind every AtlasFrameHash.
+const struct {
+    game::AtlasFrameHash hash;
+    const char *name;
+} ATLAS_FRAME_NAMES[] = {
+    {game::AtlasFrameHash::GIRAFFE, "giraffe"},
+    {game::AtlasFrameHash::LION, "lion"},
+    {game::AtlasFrameHash::FOOD, "food"},
+};
+
+uint64_t frame_name_hash(const char *name) {
+    return foundation::murmur_hash_64(name, (uint32_t)strlen(name), 0);
+}
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+AtlasFrames::AtlasFrames(Allocator &allocator)
+: frames(allocator) {}
+
+namespace atlas_frames {
+
+void init(AtlasFrames &frames, const engine::Atlas &atlas) {
+    hash::clear(frames.frames);
+
+    for (const auto &frame_name : ATLAS_FRAME_NAMES) {
+        const uint64_t key = frame_name_hash(frame_name.name);
+        assert(key == (uint64_t)frame_name.hash);
+
+        const engine::AtlasFrame *atlas_frame = engine::atlas_frame(atlas, frame_name.name);
+        if (!atlas_frame) {
+            log_fatal("Atlas is missing the frame %s", frame_name.name);
+        }
+
+        hash::set(frames.frames, key, atlas_frame);
+    }
+}
+
+const engine::AtlasFrame *frame(const AtlasFrames &frames, AtlasFrameHash frame_hash) {
+    const engine::AtlasFrame *atlas_frame = hash::get(frames.frames, (uint64_t)frame_hash, (const engine::AtlasFrame *)nullptr);
+    assert(atlas_frame);
+    return atlas_frame;
+}
+
+} // namespace atlas_frames
+
+} // namespace game
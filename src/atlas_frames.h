@@ -0,0 +1,59 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace engine {
+struct Atlas;
+struct AtlasFrame;
+} // namespace engine
+
+namespace game {
+
+/// Murmur hashed atlas frame names.
+enum class AtlasFrameHash : uint64_t {
+    NONE = 0x0ULL,
+    GIRAFFE = 0x29cb51935eeefab0ULL,
+    LION = 0xfb2a9ffb66d4f141ULL,
+    FOOD = 0x4f43d16cd3c1c0dbULL,
+};
+
+/**
+ * @brief Atlas frames resolved once by name, and looked up by the murmur hash of their name after that.
+ *
+ */
+struct AtlasFrames {
+    AtlasFrames(foundation::Allocator &allocator);
+    ~AtlasFrames(){};
+    DELETE_COPY_AND_MOVE(AtlasFrames)
+
+    // The resolved frames by AtlasFrameHash.
+    foundation::Hash<const engine::AtlasFrame *> frames;
+};
+
+namespace atlas_frames {
+
+/**
+ * @brief Resolves every AtlasFrameHash frame in an atlas, forgetting the frames from any previous atlas.
+ *
+ * @param frames The frames to resolve.
+ * @param atlas The atlas to resolve them in.
+ */
+void init(AtlasFrames &frames, const engine::Atlas &atlas);
+
+/**
+ * @brief Looks up a frame resolved by init.
+ *
+ * @param frames The initialized frames.
+ * @param frame_hash The hashed name of the frame.
+ * @return const engine::AtlasFrame* The frame.
+ */
+const engine::AtlasFrame *frame(const AtlasFrames &frames, AtlasFrameHash frame_hash);
+
+} // namespace atlas_frames
+
+} // namespace game
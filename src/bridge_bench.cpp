@@ -0,0 +1,105 @@
+#include "bridge_bench.h"
+#include "profiler.h"
+
+#include <engine/log.h>
+
+#include <array.h>
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+// The name of the primitive that times the empty loop.
+const char *LOOP_PRIMITIVE = "loop";
+
+// Nanoseconds per call of a result.
+double ns_per_call(const game::BridgeBenchResult &result) {
+    return result.calls ? (double)result.ns / (double)result.calls : 0.0;
+}
+
+// Nanoseconds per call of the empty loop, 0 if it wasn't timed.
+double loop_ns_per_call(const game::BridgeBench &bench) {
+    for (const game::BridgeBenchResult *it = foundation::array::begin(bench.results); it != foundation::array::end(bench.results); ++it) {
+        if (strcmp(it->primitive, LOOP_PRIMITIVE) == 0) {
+            return ns_per_call(*it);
+        }
+    }
+
+    return 0.0;
+}
+
+// Nanoseconds per call of a result without the loop around it, 0 for the loop itself.
+double net_ns_per_call(const game::BridgeBenchResult &result, double loop_ns) {
+    if (strcmp(result.primitive, LOOP_PRIMITIVE) == 0) {
+        return 0.0;
+    }
+
+    const double ns = ns_per_call(result) - loop_ns;
+    return ns > 0.0 ? ns : 0.0;
+}
+
+// Allocations, or allocated bytes, per call of a result.
+double per_call(const game::BridgeBenchResult &result, uint64_t count) {
+    return result.calls ? (double)count / (double)result.calls : 0.0;
+}
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+BridgeBench::BridgeBench(Allocator &allocator)
+: results(allocator)
+, start_ns(0)
+, start_allocations() {}
+
+namespace bridge_bench {
+
+void begin(BridgeBench &bench) {
+    bench.start_allocations = counting_allocator::thread_totals();
+    bench.start_ns = profiler::now_ns();
+}
+
+void end(BridgeBench &bench, const char *primitive, uint32_t calls) {
+    const uint64_t ns = profiler::now_ns() - bench.start_ns;
+
+    BridgeBenchResult result;
+    strncpy(result.primitive, primitive, BRIDGE_BENCH_NAME_LENGTH - 1);
+    result.primitive[BRIDGE_BENCH_NAME_LENGTH - 1] = '\0';
+    result.calls = calls;
+    result.ns = ns;
+    result.allocations = counting_allocator::difference(bench.start_allocations, counting_allocator::thread_totals());
+    array::push_back(bench.results, result);
+}
+
+void log(const BridgeBench &bench) {
+    const double loop_ns = loop_ns_per_call(bench);
+
+    for (const BridgeBenchResult *it = array::begin(bench.results); it != array::end(bench.results); ++it) {
+        log_info("%-32s %8.1f ns/call  %8.1f ns/call without the loop  %6.2f allocations/call  %8.1f bytes/call", it->primitive,
+                 ns_per_call(*it), net_ns_per_call(*it, loop_ns), per_call(*it, it->allocations.allocations), per_call(*it, it->allocations.bytes));
+    }
+}
+
+bool write_json(const BridgeBench &bench, const char *backend, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    const double loop_ns = loop_ns_per_call(bench);
+
+    fprintf(file, "{\"backend\":\"%s\",\"primitives\":[", backend);
+    for (const BridgeBenchResult *it = array::begin(bench.results); it != array::end(bench.results); ++it) {
+        fprintf(file, "%s{\"primitive\":\"%s\",\"calls\":%u,\"ns_per_call\":%f,\"net_ns_per_call\":%f,\"allocations_per_call\":%f,\"bytes_per_call\":%f}",
+                it == array::begin(bench.results) ? "" : ",", it->primitive, it->calls, ns_per_call(*it), net_ns_per_call(*it, loop_ns),
+                per_call(*it, it->allocations.allocations), per_call(*it, it->allocations.bytes));
+    }
+    fprintf(file, "]}\n");
+
+    fclose(file);
+    return true;
+}
+
+} // namespace bridge_bench
+
+} // namespace game
@@ -0,0 +1,85 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "counting_allocator.h"
+#include "memory_types.h"
+#include "util.h"
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+// Longest primitive name kept by a BridgeBench, including the terminator.
+const uint32_t BRIDGE_BENCH_NAME_LENGTH = 48;
+
+/**
+ * @brief The time and allocations of a number of calls to one primitive.
+ *
+ */
+struct BridgeBenchResult {
+    char primitive[BRIDGE_BENCH_NAME_LENGTH];
+    uint32_t calls;
+    uint64_t ns;
+    AllocationCounts allocations;
+};
+
+/**
+ * @brief Collects how long the gameplay implementation takes to call each bound primitive, and what the calls allocate.
+ *
+ * The implementation calls bridge_bench::begin, calls a primitive in a loop, and then calls bridge_bench::end with the
+ * primitive's name. A primitive named "loop" times the empty loop, and is subtracted from the others when reporting.
+ */
+struct BridgeBench {
+    BridgeBench(foundation::Allocator &allocator);
+    ~BridgeBench(){};
+    DELETE_COPY_AND_MOVE(BridgeBench)
+
+    // Every primitive timed so far.
+    foundation::Array<BridgeBenchResult> results;
+
+    // When the current primitive started.
+    uint64_t start_ns;
+
+    // What the thread had allocated when the current primitive started.
+    AllocationCounts start_allocations;
+};
+
+namespace bridge_bench {
+
+/**
+ * @brief Starts timing calls to a primitive.
+ *
+ * @param bench The bench.
+ */
+void begin(BridgeBench &bench);
+
+/**
+ * @brief Stops timing calls to a primitive.
+ *
+ * @param bench The bench.
+ * @param primitive The name of the primitive, which is copied.
+ * @param calls Number of calls made since begin.
+ */
+void end(BridgeBench &bench, const char *primitive, uint32_t calls);
+
+/**
+ * @brief Logs the nanoseconds and allocated bytes per call of every primitive.
+ *
+ * @param bench The bench.
+ */
+void log(const BridgeBench &bench);
+
+/**
+ * @brief Writes the results as a JSON object.
+ *
+ * @param bench The bench.
+ * @param backend The name of the gameplay implementation.
+ * @param path The file to write.
+ * @return bool Whether the file could be written.
+ */
+bool write_json(const BridgeBench &bench, const char *backend, const char *path);
+
+} // namespace bridge_bench
+
+} // namespace game
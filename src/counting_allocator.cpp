@@ -0,0 +1,74 @@
+#include "counting_allocator.h"
+
+namespace {
+// What the calling thread has counted, across every CountingAllocator.
+thread_local game::AllocationCounts thread_counts = {0, 0, 0};
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+CountingAllocator::CountingAllocator(Allocator &backing)
+: backing(backing)
+, allocations(0)
+, frees(0)
+, bytes(0) {}
+
+CountingAllocator::~CountingAllocator() {}
+
+void *CountingAllocator::allocate(uint32_t size, uint32_t align) {
+    void *p = backing.allocate(size, align);
+    counting_allocator::add_allocation(*this, size);
+    return p;
+}
+
+void CountingAllocator::deallocate(void *p) {
+    if (!p) {
+        return;
+    }
+
+    counting_allocator::add_free(*this);
+    backing.deallocate(p);
+}
+
+uint32_t CountingAllocator::allocated_size(void *p) {
+    return backing.allocated_size(p);
+}
+
+uint32_t CountingAllocator::total_allocated() {
+    return backing.total_allocated();
+}
+
+namespace counting_allocator {
+
+AllocationCounts totals(const CountingAllocator &allocator) {
+    return {
+        allocator.allocations.load(std::memory_order_relaxed),
+        allocator.frees.load(std::memory_order_relaxed),
+        allocator.bytes.load(std::memory_order_relaxed),
+    };
+}
+
+AllocationCounts thread_totals() {
+    return thread_counts;
+}
+
+AllocationCounts difference(const AllocationCounts &from, const AllocationCounts &to) {
+    return {to.allocations - from.allocations, to.frees - from.frees, to.bytes - from.bytes};
+}
+
+void add_allocation(CountingAllocator &allocator, uint32_t size) {
+    allocator.allocations.fetch_add(1, std::memory_order_relaxed);
+    allocator.bytes.fetch_add(size, std::memory_order_relaxed);
+    ++thread_counts.allocations;
+    thread_counts.bytes += size;
+}
+
+void add_free(CountingAllocator &allocator) {
+    allocator.frees.fetch_add(1, std::memory_order_relaxed);
+    ++thread_counts.frees;
+}
+
+} // namespace counting_allocator
+
+} // namespace game
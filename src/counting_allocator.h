@@ -0,0 +1,91 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "memory.h"
+#include "util.h"
+#include <atomic>
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief A number of allocations and frees, and the bytes requested by the allocations.
+ *
+ */
+struct AllocationCounts {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;
+};
+
+/**
+ * @brief An allocator that counts every allocation and free before handing it to a backing allocator.
+ *
+ * The counts are kept for the allocator as a whole, and for each thread across every CountingAllocator, so a scope
+ * on one thread can tell what it allocated without seeing the other threads.
+ */
+class CountingAllocator : public foundation::Allocator {
+  public:
+    CountingAllocator(foundation::Allocator &backing);
+    ~CountingAllocator();
+    DELETE_COPY_AND_MOVE(CountingAllocator)
+
+    void *allocate(uint32_t size, uint32_t align = DEFAULT_ALIGN) override;
+    void deallocate(void *p) override;
+    uint32_t allocated_size(void *p) override;
+    uint32_t total_allocated() override;
+
+    foundation::Allocator &backing;
+
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> bytes;
+};
+
+namespace counting_allocator {
+
+/**
+ * @brief Everything counted by an allocator so far, on every thread.
+ *
+ * @param allocator The allocator.
+ * @return AllocationCounts The counts.
+ */
+AllocationCounts totals(const CountingAllocator &allocator);
+
+/**
+ * @brief Everything counted on the calling thread so far, by every CountingAllocator.
+ *
+ * @return AllocationCounts The counts.
+ */
+AllocationCounts thread_totals();
+
+/**
+ * @brief The counts between two readings.
+ *
+ * @param from The earlier reading.
+ * @param to The later reading.
+ * @return AllocationCounts The difference.
+ */
+AllocationCounts difference(const AllocationCounts &from, const AllocationCounts &to);
+
+/**
+ * @brief Counts an allocation that was served without reaching the allocator, like a block from a slab.
+ *
+ * It's counted for the allocator and for the calling thread, like an allocation made through the allocator.
+ *
+ * @param allocator The allocator to count it for.
+ * @param size The bytes requested.
+ */
+void add_allocation(CountingAllocator &allocator, uint32_t size);
+
+/**
+ * @brief Counts the free of an allocation that was counted with add_allocation.
+ *
+ * @param allocator The allocator it was counted for.
+ */
+void add_free(CountingAllocator &allocator);
+
+} // namespace counting_allocator
+
+} // namespace game
@@ -5,14 +5,19 @@
 #include <engine/engine.h>
 #include <engine/file.h>
 #include <engine/ini.h>
+#include <engine/input.h>
 #include <engine/log.h>
 #include <engine/sprites.h>
 
+#include <hash.h>
 #include <memory.h>
 #include <string_stream.h>
 #include <temp_allocator.h>
 
 #include <cassert>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #if defined(HAS_LUA)
 #include "if_game.h"
@@ -22,14 +27,35 @@
 #include "zig_game.h"
 #endif
 
+namespace {
+// Ticks run in one update when [game] max_fixed_steps isn't set.
+const uint32_t DEFAULT_MAX_FIXED_STEPS = 4;
+
+void write_trace(game::Game &game) {
+    if (!game.tracer.path) {
+        log_info("Tracing is off, set [game] trace to a file name to record a trace");
+        return;
+    }
+
+    if (game::trace::write(game.tracer, game.tracer.path)) {
+        log_info("Wrote trace to %s", game.tracer.path);
+    } else {
+        log_info("Could not write trace to %s", game.tracer.path);
+    }
+}
+} // namespace
+
 namespace game {
 
 void game_state_playing_enter(engine::Engine &engine, Game &game);
 void game_state_playing_leave(engine::Engine &engine, Game &game);
 void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::InputCommand &input_command);
 void game_state_playing_update(engine::Engine &engine, Game &game, float t, float dt);
+void game_state_playing_interpolate(engine::Engine &engine, Game &game, float t, float dt, float alpha);
 void game_state_playing_render(engine::Engine &engine, Game &game);
 void game_state_playing_render_imgui(engine::Engine &engine, Game &game);
+void game_state_playing_hash_state(engine::Engine &engine, Game &game);
+void game_state_playing_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls);
 
 using namespace foundation;
 
@@ -38,13 +64,26 @@ Game::Game(Allocator &allocator, const char *config_path)
 , config(nullptr)
 , action_binds(nullptr)
 , sprites(nullptr)
+, atlas_frames(allocator)
 , app_state(AppState::None)
-, game_state(allocator) {
+, game_state(allocator)
+, random_seed(0)
+, initial_giraffes(0)
+, verify(false)
+, tracer(allocator)
+, playing_ticks(0)
+, bridge_bench(allocator)
+, fixed_dt(0.0f)
+, max_fixed_steps(DEFAULT_MAX_FIXED_STEPS)
+, lua_slab_allocator(true)
+, fixed_accumulator(0.0f)
+, fixed_t(0.0f) {
     action_binds = MAKE_NEW(allocator, engine::ActionBinds, allocator, config_path);
     sprites = MAKE_NEW(allocator, engine::Sprites, allocator);
 
     // Config
     {
+        StartupScope startup_scope("config ini_load");
         TempAllocator1024 ta;
 
         string_stream::Buffer buffer(ta);
@@ -58,9 +97,64 @@ Game::Game(Allocator &allocator, const char *config_path)
             log_fatal("Could not parse config file %s", config_path);
         }
     }
+
+    const char *fixed_rate = engine::config::read_property(config, "game", "fixed_rate");
+    if (fixed_rate && strcmp(fixed_rate, "off") != 0) {
+        const float rate = strtof(fixed_rate, nullptr);
+        if (rate <= 0.0f) {
+            log_fatal("Invalid config file, [game] fixed_rate must be off or a number of ticks per second");
+        }
+
+        fixed_dt = 1.0f / rate;
+    }
+
+    const char *fixed_steps = engine::config::read_property(config, "game", "max_fixed_steps");
+    if (fixed_steps) {
+        max_fixed_steps = (uint32_t)strtoul(fixed_steps, nullptr, 10);
+        if (max_fixed_steps == 0) {
+            log_fatal("Invalid config file, [game] max_fixed_steps must be a positive number of ticks");
+        }
+    }
+
+    const char *trace_path = engine::config::read_property(config, "game", "trace");
+    if (trace_path && strcmp(trace_path, "off") != 0) {
+        tracer.path = trace_path;
+        tracer.enabled = true;
+    }
+
+    const char *record_input = engine::config::read_property(config, "game", "record_input");
+    if (record_input && strcmp(record_input, "off") != 0) {
+        if (!input_recording::open(input_recorder, record_input)) {
+            log_fatal("Could not open %s for writing", record_input);
+        }
+    }
+
+    const char *profile = engine::config::read_property(config, "game", "profiler");
+    if (profile && strcmp(profile, "on") == 0) {
+        profiler.enabled = true;
+    } else if (profile && strcmp(profile, "off") != 0) {
+        log_fatal("Invalid config file, [game] profiler must be on or off");
+    }
+
+    const char *counters = engine::config::read_property(config, "game", "perf_counters");
+    if (counters && strcmp(counters, "on") == 0) {
+        profiler.enabled = true;
+        profiler::enable_counters(profiler);
+    } else if (counters && strcmp(counters, "off") != 0) {
+        log_fatal("Invalid config file, [game] perf_counters must be on or off");
+    }
+
+    const char *lua_allocator = engine::config::read_property(config, "game", "lua_allocator");
+    if (lua_allocator && strcmp(lua_allocator, "foundation") == 0) {
+        lua_slab_allocator = false;
+    } else if (lua_allocator && strcmp(lua_allocator, "slab") != 0) {
+        log_fatal("Invalid config file, [game] lua_allocator must be slab or foundation");
+    }
 }
 
 Game::~Game() {
+    input_recording::close(input_recorder);
+
     MAKE_DELETE(allocator, ActionBinds, action_binds);
     MAKE_DELETE(allocator, Sprites, sprites);
 
@@ -75,6 +169,7 @@ void update(engine::Engine &engine, void *game_object, float t, float dt) {
     }
 
     Game *game = static_cast<Game *>(game_object);
+    TraceScope trace_scope(game->tracer, "update");
 
     switch (game->app_state) {
     case AppState::None: {
@@ -82,7 +177,38 @@ void update(engine::Engine &engine, void *game_object, float t, float dt) {
         break;
     }
     case AppState::Playing: {
-        game_state_playing_update(engine, *game, t, dt);
+        if (game->fixed_dt <= 0.0f) {
+            {
+                TraceScope playing_scope(game->tracer, "game_state_playing_update");
+                game_state_playing_update(engine, *game, t, dt);
+                ++game->playing_ticks;
+            }
+            TraceScope interpolate_scope(game->tracer, "game_state_playing_interpolate");
+            game_state_playing_interpolate(engine, *game, t, dt, 1.0f);
+            break;
+        }
+
+        game->fixed_accumulator += dt;
+
+        uint32_t steps = 0;
+        while (game->fixed_accumulator >= game->fixed_dt && steps < game->max_fixed_steps && game->app_state == AppState::Playing) {
+            game->fixed_t += game->fixed_dt;
+            TraceScope playing_scope(game->tracer, "game_state_playing_update");
+            game_state_playing_update(engine, *game, game->fixed_t, game->fixed_dt);
+            ++game->playing_ticks;
+            game->fixed_accumulator -= game->fixed_dt;
+            ++steps;
+        }
+
+        // Ticks that didn't fit are skipped, so a slow tick can't make every following update run more of them.
+        if (game->fixed_accumulator >= game->fixed_dt) {
+            game->fixed_accumulator = fmodf(game->fixed_accumulator, game->fixed_dt);
+        }
+
+        if (game->app_state == AppState::Playing) {
+            TraceScope interpolate_scope(game->tracer, "game_state_playing_interpolate");
+            game_state_playing_interpolate(engine, *game, t, dt, game->fixed_accumulator / game->fixed_dt);
+        }
         break;
     }
     case AppState::Quitting: {
@@ -103,8 +229,27 @@ void on_input(engine::Engine &engine, void *game_object, engine::InputCommand &i
     Game *game = static_cast<Game *>(game_object);
     assert(game->action_binds != nullptr);
 
+    // Writing the trace and showing the profiler work the same in every gameplay implementation, so they're handled
+    // before they see the input.
+    if (input_command.input_type == engine::InputType::Key && input_command.key_state.trigger_state == engine::TriggerState::Pressed) {
+        const uint64_t bind_action_key = engine::action_key_for_input_command(input_command);
+        const ActionHash action_hash = bind_action_key != 0 ? ActionHash(hash::get(game->action_binds->bind_actions, bind_action_key, (uint64_t)0)) : ActionHash::NONE;
+        if (action_hash == ActionHash::TRACE) {
+            write_trace(*game);
+            return;
+        }
+        if (action_hash == ActionHash::PROFILER) {
+            game->profiler.enabled = !game->profiler.enabled;
+            return;
+        }
+    }
+
+    TraceScope trace_scope(game->tracer, "on_input");
+
     switch (game->app_state) {
     case AppState::Playing: {
+        input_recording::record(game->input_recorder, game->playing_ticks, input_command);
+        TraceScope playing_scope(game->tracer, "game_state_playing_on_input");
         game_state_playing_on_input(engine, *game, input_command);
         break;
     }
@@ -116,9 +261,11 @@ void on_input(engine::Engine &engine, void *game_object, engine::InputCommand &i
 
 void render(engine::Engine &engine, void *game_object) {
     Game *game = static_cast<Game *>(game_object);
+    TraceScope trace_scope(game->tracer, "render");
 
     switch (game->app_state) {
     case AppState::Playing: {
+        TraceScope playing_scope(game->tracer, "game_state_playing_render");
         game_state_playing_render(engine, *game);
         break;
     }
@@ -131,14 +278,26 @@ void render(engine::Engine &engine, void *game_object) {
 void render_imgui(engine::Engine &engine, void *game_object) {
     Game *game = static_cast<Game *>(game_object);
 
-    switch (game->app_state) {
-    case AppState::Playing: {
-        game_state_playing_render_imgui(engine, *game);
-        break;
-    }
-    default: {
-        break;
+    {
+        TraceScope trace_scope(game->tracer, "render_imgui");
+
+        switch (game->app_state) {
+        case AppState::Playing: {
+            TraceScope playing_scope(game->tracer, "game_state_playing_render_imgui");
+            game_state_playing_render_imgui(engine, *game);
+            profiler::render_imgui(game->profiler);
+            break;
+        }
+        default: {
+            break;
+        }
+        }
     }
+
+    // The ImGui pass is the last callback of a frame.
+    profiler::end_frame(game->profiler);
+    if (game->app_state == AppState::Playing) {
+        startup::first_frame();
     }
 }
 
@@ -163,6 +322,7 @@ void transition(engine::Engine &engine, void *game_object, AppState app_state) {
         return;
     }
     case AppState::Playing: {
+        TraceScope playing_scope(game->tracer, "game_state_playing_leave");
         game_state_playing_leave(engine, *game);
         break;
     }
@@ -184,21 +344,31 @@ void transition(engine::Engine &engine, void *game_object, AppState app_state) {
             log_fatal("Invalid config file, missing [game] atlas_filename");
         }
 
-        engine::init_sprites(*game->sprites, atlas_filename);
+        {
+            StartupScope startup_scope("atlas load");
+            engine::init_sprites(*game->sprites, atlas_filename);
+            atlas_frames::init(game->atlas_frames, *game->sprites->atlas);
+        }
 
+        {
+            StartupScope startup_scope("script initialize");
 #if defined(HAS_LUA)
-        lua::initialize(game->allocator);
+            lua::initialize(game->allocator, game->lua_slab_allocator, game->profiler.allocator);
 #elif defined(HAS_ANGELSCRIPT)
-        angelscript::initialize(game->allocator);
+            angelscript::initialize(game->allocator);
 #elif defined(HAS_ZIG)
-        zig::initialize(game->allocator);
+            zig::initialize(game->allocator);
 #endif
+        }
 
         transition(engine, game_object, AppState::Playing);
         break;
     }
     case AppState::Playing: {
         log_info("Playing");
+        game->playing_ticks = 0;
+        TraceScope playing_scope(game->tracer, "game_state_playing_enter");
+        StartupScope startup_scope("game_state_playing_enter");
         game_state_playing_enter(engine, *game);
         break;
     }
@@ -208,7 +378,11 @@ void transition(engine::Engine &engine, void *game_object, AppState app_state) {
     }
     case AppState::Terminate: {
         log_info("Terminating");
-        
+
+        if (game->tracer.enabled) {
+            write_trace(*game);
+        }
+
 #if defined(HAS_LUA)
         lua::close();
 #elif defined(HAS_ANGELSCRIPT)
@@ -221,4 +395,23 @@ void transition(engine::Engine &engine, void *game_object, AppState app_state) {
     }
 }
 
+void hash_state(engine::Engine &engine, Game &game) {
+    if (game.app_state != AppState::Playing || !game.state_hasher.file) {
+        return;
+    }
+
+    TraceScope trace_scope(game.tracer, "game_state_playing_hash_state");
+    game_state_playing_hash_state(engine, game);
+    state_hash::end_frame(game.state_hasher);
+}
+
+void run_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls) {
+    if (game.app_state != AppState::Playing) {
+        return;
+    }
+
+    TraceScope trace_scope(game.tracer, "game_state_playing_bridge_bench");
+    game_state_playing_bridge_bench(engine, game, calls);
+}
+
 } // namespace game
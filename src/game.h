@@ -1,8 +1,19 @@
 #pragma once
 
 #pragma warning(push, 0)
+#include "atlas_frames.h"
+#include "bridge_bench.h"
 #include "collection_types.h"
+#include "handle_pool.h"
+#include "input_recording.h"
 #include "memory_types.h"
+#include "obstacle_grid.h"
+#include "profiler.h"
+#include "spatial_grid.h"
+#include "sprite_transforms.h"
+#include "startup.h"
+#include "state_hash.h"
+#include "trace.h"
 #include "util.h"
 #include <engine/math.inl>
 #include <glm/glm.hpp>
@@ -11,6 +22,14 @@
 
 typedef struct ini_t ini_t;
 
+namespace simd {
+struct Kernels;
+} // namespace simd
+
+namespace game {
+struct ThreadPool;
+} // namespace game
+
 namespace engine {
 struct Engine;
 struct InputCommand;
@@ -29,6 +48,8 @@ enum class ActionHash : uint64_t {
     ADD_ONE = 0xc6d7077102962545ULL,
     ADD_FIVE = 0x290570f1484c39a6ULL,
     ADD_TEN = 0xebc74835735457f2ULL,
+    TRACE = 0x8a2e2ef85327d4e4ULL,
+    PROFILER = 0xd7469c566d7f886cULL,
 };
 
 /**
@@ -55,6 +76,10 @@ enum class AppState {
 struct Mob {
     float mass = 100.0f;
     glm::vec2 position = {0.0f, 0.0f};
+
+    // Where the mob was before the last simulation tick, which its sprite is interpolated from.
+    glm::vec2 previous_position = {0.0f, 0.0f};
+
     glm::vec2 velocity = {0.0f, 0.0f};
     glm::vec2 steering_direction = {0.0f, 0.0f};
     glm::vec2 steering_target = {0.0f, 0.0f};
@@ -64,16 +89,41 @@ struct Mob {
     float radius = 10.0f;
 };
 
+/**
+ * @brief Constants shared by every mob of a species.
+ *
+ */
+struct MobSpecies {
+    float mass;
+    float max_force;
+    float max_speed;
+    float radius;
+};
+
+enum class Species {
+    Giraffe,
+    Lion,
+    Count,
+};
+
 struct Giraffe {
     uint64_t sprite_id = 0;
+
+    // The number of giraffes spawned before this one, which identifies it in state hashes.
+    uint32_t spawn_id = 0;
     Mob mob;
-    bool dead = false;
 };
 
+// Marks a search that found no giraffe.
+const uint32_t NO_GIRAFFE = UINT32_MAX;
+
 struct Lion {
     uint64_t sprite_id = 0;
     Mob mob;
-    Giraffe *locked_giraffe = nullptr;
+
+    // The hunted giraffe, which stops being alive when it's killed.
+    Handle locked_giraffe = NO_HANDLE;
+
     float energy = 0.0f;
     float max_energy = 10.0f;
 };
@@ -89,23 +139,160 @@ struct Food {
     glm::vec2 position = {0.0f, 0.0f};
 };
 
+/**
+ * @brief How giraffes find their neighbors for separation.
+ *
+ */
+enum class SeparationMode {
+    // Every giraffe checks every other giraffe.
+    BruteForce,
+
+    // Every giraffe checks the giraffes in nearby cells of a uniform grid.
+    Grid,
+};
+
+/**
+ * @brief How the C++ gameplay implementation stores its giraffes.
+ *
+ */
+enum class MobLayout {
+    // An array of Giraffe structs.
+    ArrayOfStructs,
+
+    // One array per Giraffe field, with the Mob constants looked up from the species.
+    StructOfArrays,
+};
+
+/**
+ * @brief Giraffes stored as a structure of arrays, where index i in every array is the same giraffe.
+ *
+ * Mass, max force, max speed, and radius are the same for every giraffe, and come from the giraffe MobSpecies.
+ */
+struct GiraffesSoA {
+    GiraffesSoA(foundation::Allocator &allocator)
+    : sprite_id(allocator)
+    , spawn_id(allocator)
+    , position_x(allocator)
+    , position_y(allocator)
+    , velocity_x(allocator)
+    , velocity_y(allocator)
+    , steering_direction_x(allocator)
+    , steering_direction_y(allocator)
+    , steering_target_x(allocator)
+    , steering_target_y(allocator)
+    , orientation(allocator)
+    , drag(allocator)
+    , previous_position_x(allocator)
+    , previous_position_y(allocator)
+    , next_position_x(allocator)
+    , next_position_y(allocator)
+    , next_velocity_x(allocator)
+    , next_velocity_y(allocator) {}
+    ~GiraffesSoA(){};
+    DELETE_COPY_AND_MOVE(GiraffesSoA)
+
+    foundation::Array<uint64_t> sprite_id;
+
+    // The number of giraffes spawned before each one, which identifies it in state hashes.
+    foundation::Array<uint32_t> spawn_id;
+
+    foundation::Array<float> position_x;
+    foundation::Array<float> position_y;
+    foundation::Array<float> velocity_x;
+    foundation::Array<float> velocity_y;
+    foundation::Array<float> steering_direction_x;
+    foundation::Array<float> steering_direction_y;
+    foundation::Array<float> steering_target_x;
+    foundation::Array<float> steering_target_y;
+    foundation::Array<float> orientation;
+
+    // Scratch for the drag at each position, filled in before the batched integration.
+    foundation::Array<float> drag;
+
+    // Where the giraffes were before the last simulation tick, which their sprites are interpolated from.
+    foundation::Array<float> previous_position_x;
+    foundation::Array<float> previous_position_y;
+
+    // The positions and velocities being written by the parallel update, swapped with the current ones at the end of the frame.
+    foundation::Array<float> next_position_x;
+    foundation::Array<float> next_position_y;
+    foundation::Array<float> next_velocity_x;
+    foundation::Array<float> next_velocity_y;
+};
+
 // This is the game state for the C++ gameplay implementation.
 struct GameState {
     GameState(foundation::Allocator &allocator)
-    : giraffes(allocator)
+    : layout(MobLayout::ArrayOfStructs)
+    , giraffes(allocator)
+    , giraffes_soa(allocator)
+    , giraffe_handles(allocator)
+    , giraffes_spawned(0)
+    , hashed_giraffes(allocator)
     , obstacles(allocator)
+    , obstacle_grid(allocator)
     , food()
     , lion()
+    , separation_mode(SeparationMode::Grid)
+    , separation_grid(allocator)
+    , separation_query_distance(0.0f)
+    , separation_grid_drift(0.0f)
+    , sprite_transforms(allocator)
+    , simd_kernels(nullptr)
+    , thread_pool(nullptr)
     , debug_draw(false)
     , debug_avoidance(false) {}
     ~GameState(){};
     DELETE_COPY_AND_MOVE(GameState)
 
+    MobLayout layout;
+
+    // Giraffes when the layout is ArrayOfStructs.
     foundation::Array<Giraffe> giraffes;
+
+    // Giraffes when the layout is StructOfArrays.
+    GiraffesSoA giraffes_soa;
+
+    // Handles to the giraffes, whose dense indices are their indices in the active layout. Killed giraffes are
+    // removed with swap_pop, so only live giraffes are stored and updated.
+    HandlePool giraffe_handles;
+
+    // The number of giraffes spawned so far, which is the spawn id of the next one.
+    uint32_t giraffes_spawned;
+
+    // Scratch for the state hash, the index of every giraffe by spawn id, NO_GIRAFFE once it's been killed.
+    foundation::Array<uint32_t> hashed_giraffes;
+
     foundation::Array<Obstacle> obstacles;
+
+    // The obstacles, indexed once they're spawned.
+    ObstacleGrid obstacle_grid;
+
     Food food;
     Lion lion;
 
+    SeparationMode separation_mode;
+
+    // The giraffes by index, rebuilt at the start of every update. The indices are stale once a giraffe is killed.
+    SpatialGrid separation_grid;
+
+    // How far from a giraffe the grid is searched, which covers the separation distance plus how far giraffes move in a frame.
+    float separation_query_distance;
+
+    // How far a giraffe can have moved since the grid was rebuilt, which nearest giraffe searches allow for.
+    float separation_grid_drift;
+
+    // Sprite transforms queued by the ticks, applied together once per update.
+    SpriteTransforms sprite_transforms;
+
+    // When set, the StructOfArrays giraffes are updated in batches with these kernels. Every giraffe then steers
+    // from the positions at the start of the frame, and all of them are integrated at once.
+    const simd::Kernels *simd_kernels;
+
+    // When set, the StructOfArrays giraffes are updated in parallel on this pool. Every giraffe reads the others
+    // from the previous frame and writes its new position and velocity to the next buffers.
+    ThreadPool *thread_pool;
+
     bool debug_draw;
     bool debug_avoidance;
 };
@@ -118,13 +305,62 @@ struct Game {
     ini_t *config;
     engine::ActionBinds *action_binds;
     engine::Sprites *sprites;
+
+    // The sprite atlas frames, resolved when the sprites are initialized.
+    AtlasFrames atlas_frames;
+
     AppState app_state;
     GameState game_state;
+
+    // Seed for the gameplay random device, 0 seeds from the clock.
+    uint32_t random_seed;
+
+    // Number of giraffes spawned when play starts, 0 uses the gameplay implementation's default.
+    uint32_t initial_giraffes;
+
+    // Cross-checks optimized gameplay paths against their reference implementations every frame.
+    bool verify;
+
+    // Times the phases of every frame.
+    Profiler profiler;
+
+    // Records a timeline of the engine callbacks and the gameplay and script calls in them.
+    Tracer tracer;
+
+    // Hashes the simulation state after every frame when its file is open.
+    StateHasher state_hasher;
+
+    // Records the inputs of the playing state when its file is open.
+    InputRecorder input_recorder;
+
+    // Number of gameplay ticks run since entering the playing state, which recorded inputs are stamped with.
+    uint32_t playing_ticks;
+
+    // Times the bound primitives of the gameplay implementation when run_bridge_bench is called.
+    BridgeBench bridge_bench;
+
+    // Seconds simulated by every gameplay tick, 0 ticks once per update with the engine's delta time.
+    float fixed_dt;
+
+    // Most ticks run in one update, after which the time left over is dropped instead of caught up on.
+    uint32_t max_fixed_steps;
+
+    // Whether Lua allocates through a SlabAllocator rather than straight from the allocator, from [game] lua_allocator.
+    bool lua_slab_allocator;
+
+    // Time from the updates that hasn't been simulated by a tick yet.
+    float fixed_accumulator;
+
+    // Time simulated by the ticks so far.
+    float fixed_t;
 };
 
 /**
  * @brief Updates the application
  *
+ * When the game has a fixed_dt, the playing state is ticked as many times as the accumulated time covers, up to
+ * max_fixed_steps, and its sprites are then interpolated between the last two ticks.
+ *
  * @param engine The engine which calls this function
  * @param application The application to update
  * @param t The current time
@@ -174,4 +410,25 @@ void on_shutdown(engine::Engine &engine, void *application);
  */
 void transition(engine::Engine &engine, void *application, AppState app_state);
 
+/**
+ * @brief Hands the simulation state of the gameplay implementation to the game's StateHasher as one frame.
+ *
+ * Does nothing unless the game is playing and the hasher has a file open.
+ *
+ * @param engine The engine.
+ * @param game The game to hash.
+ */
+void hash_state(engine::Engine &engine, Game &game);
+
+/**
+ * @brief Has the gameplay implementation time a number of calls to each of its bound primitives into the game's BridgeBench.
+ *
+ * Does nothing unless the game is playing.
+ *
+ * @param engine The engine.
+ * @param game The game.
+ * @param calls Number of calls to each primitive.
+ */
+void run_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls);
+
 } // namespace game
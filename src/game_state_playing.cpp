@@ -1,11 +1,15 @@
 #include "game.h"
 
+#include "profiler.h"
 #include "rnd.h"
+#include "simd.h"
+#include "thread_pool.h"
 #include "util.h"
 
 #include <engine/action_binds.h>
 #include <engine/atlas.h>
 #include <engine/color.inl>
+#include <engine/config.h>
 #include <engine/engine.h>
 #include <engine/input.h>
 #include <engine/log.h>
@@ -13,6 +17,7 @@
 #include <engine/sprites.h>
 
 #include <hash.h>
+#include <memory.h>
 #include <murmur_hash.h>
 #include <string_stream.h>
 #include <temp_allocator.h>
@@ -25,6 +30,9 @@
 #include <algorithm>
 #include <imgui.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
 #include <time.h>
 
 namespace {
@@ -32,33 +40,185 @@ rnd_pcg_t RANDOM_DEVICE;
 const int32_t LION_Z_LAYER = -1;
 const int32_t GIRAFFE_Z_LAYER = -2;
 const int32_t FOOD_Z_LAYER = -3;
+
+// How far the grid and brute force separation forces may drift apart from summing in different orders.
+const float SEPARATION_VERIFY_TOLERANCE = 0.001f;
+
+// How far the batched avoidance ray hits may drift from the brute force ones, which take lengths instead of squares.
+const float AVOIDANCE_VERIFY_TOLERANCE = 0.01f;
+
+// Half the avoidance look ahead distance, so the box around the avoidance rays spans a handful of cells.
+const float OBSTACLE_CELL_SIZE = 100.0f;
+
+// A thread pool job that opens the hardware counters of every thread it runs on.
+void open_perf_counters(void *context, uint32_t begin, uint32_t end) {
+    (void)context;
+    (void)begin;
+    (void)end;
+    game::perf_counters::open();
+}
+
+// Constants for every game::Species.
+const game::MobSpecies MOB_SPECIES[(int)game::Species::Count] = {
+    // Giraffe
+    {100.0f, 1000.0f, 300.0f, 20.0f},
+
+    // Lion
+    {25.0f, 1000.0f, 400.0f, 20.0f},
+};
 } // namespace
 
 namespace game {
 using namespace math;
 using namespace foundation;
 
+uint32_t giraffe_count(const GameState &game_state) {
+    if (game_state.layout == MobLayout::ArrayOfStructs) {
+        return array::size(game_state.giraffes);
+    } else {
+        return array::size(game_state.giraffes_soa.sprite_id);
+    }
+}
+
 void spawn_giraffes(engine::Engine &engine, Game &game, int num_giraffes) {
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
+
     for (int i = 0; i < num_giraffes; ++i) {
-        Giraffe giraffe;
-        giraffe.mob.mass = 100.0f;
-        giraffe.mob.max_force = 1000.0f;
-        giraffe.mob.max_speed = 300.0f;
-        giraffe.mob.radius = 20.0;
-        giraffe.mob.position = {
+        const glm::vec2 position = {
             50.0f + rnd_pcg_nextf(&RANDOM_DEVICE) * (engine.window_rect.size.x - 100.0f),
             50.0f + rnd_pcg_nextf(&RANDOM_DEVICE) * (engine.window_rect.size.y - 100.0f)};
 
         const engine::Sprite sprite = engine::add_sprite(*game.sprites, "giraffe", engine::color::pico8::orange);
-        giraffe.sprite_id = sprite.id;
-        array::push_back(game.game_state.giraffes, giraffe);
+
+        handle_pool::create(game.game_state.giraffe_handles);
+        const uint32_t spawn_id = game.game_state.giraffes_spawned++;
+
+        if (game.game_state.layout == MobLayout::ArrayOfStructs) {
+            Giraffe giraffe;
+            giraffe.mob.mass = species.mass;
+            giraffe.mob.max_force = species.max_force;
+            giraffe.mob.max_speed = species.max_speed;
+            giraffe.mob.radius = species.radius;
+            giraffe.mob.position = position;
+            giraffe.mob.previous_position = position;
+            giraffe.sprite_id = sprite.id;
+            giraffe.spawn_id = spawn_id;
+            array::push_back(game.game_state.giraffes, giraffe);
+        } else {
+            GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+            array::push_back(giraffes.sprite_id, sprite.id);
+            array::push_back(giraffes.spawn_id, spawn_id);
+            array::push_back(giraffes.position_x, position.x);
+            array::push_back(giraffes.position_y, position.y);
+            array::push_back(giraffes.velocity_x, 0.0f);
+            array::push_back(giraffes.velocity_y, 0.0f);
+            array::push_back(giraffes.steering_direction_x, 0.0f);
+            array::push_back(giraffes.steering_direction_y, 0.0f);
+            array::push_back(giraffes.steering_target_x, 0.0f);
+            array::push_back(giraffes.steering_target_y, 0.0f);
+            array::push_back(giraffes.orientation, 0.0f);
+            array::push_back(giraffes.drag, 1.0f);
+            array::push_back(giraffes.previous_position_x, position.x);
+            array::push_back(giraffes.previous_position_y, position.y);
+            array::push_back(giraffes.next_position_x, position.x);
+            array::push_back(giraffes.next_position_y, position.y);
+            array::push_back(giraffes.next_velocity_x, 0.0f);
+            array::push_back(giraffes.next_velocity_y, 0.0f);
+        }
+    }
+}
+
+glm::vec2 giraffe_position(const GameState &game_state, uint32_t index) {
+    if (game_state.layout == MobLayout::ArrayOfStructs) {
+        return game_state.giraffes[index].mob.position;
+    } else {
+        return {game_state.giraffes_soa.position_x[index], game_state.giraffes_soa.position_y[index]};
     }
 }
 
 void game_state_playing_enter(engine::Engine &engine, Game &game) {
-    time_t seconds;
-    time(&seconds);
-    rnd_pcg_seed(&RANDOM_DEVICE, (RND_U32)seconds);
+    if (game.random_seed) {
+        rnd_pcg_seed(&RANDOM_DEVICE, (RND_U32)game.random_seed);
+    } else {
+        time_t seconds;
+        time(&seconds);
+        rnd_pcg_seed(&RANDOM_DEVICE, (RND_U32)seconds);
+    }
+
+    const char *separation = engine::config::read_property(game.config, "game", "separation");
+    if (separation) {
+        if (strcmp(separation, "grid") == 0) {
+            game.game_state.separation_mode = SeparationMode::Grid;
+        } else if (strcmp(separation, "brute_force") == 0) {
+            game.game_state.separation_mode = SeparationMode::BruteForce;
+        } else {
+            log_fatal("Invalid config file, [game] separation must be grid or brute_force");
+        }
+    }
+
+    const char *layout = engine::config::read_property(game.config, "game", "layout");
+    if (layout) {
+        if (strcmp(layout, "aos") == 0) {
+            game.game_state.layout = MobLayout::ArrayOfStructs;
+        } else if (strcmp(layout, "soa") == 0) {
+            game.game_state.layout = MobLayout::StructOfArrays;
+        } else {
+            log_fatal("Invalid config file, [game] layout must be aos or soa");
+        }
+    }
+
+    const char *simd_isa = engine::config::read_property(game.config, "game", "simd");
+    if (simd_isa && strcmp(simd_isa, "off") != 0) {
+        simd::Isa isa = simd::best_isa();
+        if (strcmp(simd_isa, "auto") != 0 && !simd::parse_isa(simd_isa, isa)) {
+            log_fatal("Invalid config file, [game] simd must be off, auto, scalar, sse41, or avx2");
+        }
+
+        if (!simd::supported(isa)) {
+            log_fatal("Invalid config file, [game] simd = %s isn't supported by this CPU", simd_isa);
+        }
+
+        if (game.game_state.layout != MobLayout::StructOfArrays) {
+            log_fatal("Invalid config file, [game] simd requires layout = soa");
+        }
+
+        game.game_state.simd_kernels = &simd::kernels(isa);
+        log_info("Using %s kernels", simd::isa_name(isa));
+    }
+
+    const char *threads = engine::config::read_property(game.config, "game", "threads");
+    if (threads && strcmp(threads, "off") != 0) {
+        uint32_t num_threads = 0;
+        if (strcmp(threads, "auto") == 0) {
+            num_threads = std::thread::hardware_concurrency();
+        } else {
+            num_threads = (uint32_t)strtoul(threads, nullptr, 10);
+            if (num_threads == 0) {
+                log_fatal("Invalid config file, [game] threads must be off, auto, or a number of threads");
+            }
+        }
+
+        if (game.game_state.layout != MobLayout::StructOfArrays) {
+            log_fatal("Invalid config file, [game] threads requires layout = soa");
+        }
+
+        game.game_state.thread_pool = MAKE_NEW(game.allocator, ThreadPool, game.allocator, num_threads);
+        log_info("Updating giraffes on %u threads", game.game_state.thread_pool->num_threads);
+
+        // Hardware counters are per thread, so every worker opens its own before its first profiled range.
+        if (game.profiler.counters_enabled) {
+            ThreadPool &pool = *game.game_state.thread_pool;
+            thread_pool::parallel_for(pool, pool.num_threads, open_perf_counters, nullptr);
+        }
+    }
+
+    if (game.verify) {
+        for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::SSE41, simd::Isa::AVX2}) {
+            if (simd::supported(isa) && !simd::verify(simd::kernels(isa))) {
+                log_fatal("The %s kernels don't match the glm implementation", simd::isa_name(isa));
+            }
+        }
+    }
 
     // Spawn lake
     Obstacle obstacle;
@@ -82,8 +242,14 @@ void game_state_playing_enter(engine::Engine &engine, Game &game) {
         array::push_back(game.game_state.obstacles, obstacle);
     }
 
+    // Obstacles don't move, so they're indexed once.
+    for (Obstacle *obstacle = array::begin(game.game_state.obstacles); obstacle != array::end(game.game_state.obstacles); ++obstacle) {
+        obstacle_grid::add(game.game_state.obstacle_grid, obstacle->position, obstacle->radius);
+    }
+    obstacle_grid::commit(game.game_state.obstacle_grid, OBSTACLE_CELL_SIZE);
+
     // Spawn giraffes
-    spawn_giraffes(engine, game, 100);
+    spawn_giraffes(engine, game, game.initial_giraffes ? (int)game.initial_giraffes : 100);
 
     // Spawn food
     {
@@ -105,16 +271,22 @@ void game_state_playing_enter(engine::Engine &engine, Game &game) {
         const engine::Sprite sprite = engine::add_sprite(*game.sprites, "lion", engine::color::pico8::yellow);
         game.game_state.lion.sprite_id = sprite.id;
         game.game_state.lion.mob.position = {engine.window_rect.size.x * 0.75f, engine.window_rect.size.y * 0.75f};
-        game.game_state.lion.mob.mass = 25.0f;
-        game.game_state.lion.mob.max_force = 1000.0f;
-        game.game_state.lion.mob.max_speed = 400.0f;
-        game.game_state.lion.mob.radius = 20.0;
+        game.game_state.lion.mob.previous_position = game.game_state.lion.mob.position;
+        const MobSpecies &species = MOB_SPECIES[(int)Species::Lion];
+        game.game_state.lion.mob.mass = species.mass;
+        game.game_state.lion.mob.max_force = species.max_force;
+        game.game_state.lion.mob.max_speed = species.max_speed;
+        game.game_state.lion.mob.radius = species.radius;
     }
 }
 
 void game_state_playing_leave(engine::Engine &engine, Game &game) {
     (void)engine;
-    (void)game;
+
+    if (game.game_state.thread_pool) {
+        MAKE_DELETE(game.allocator, ThreadPool, game.game_state.thread_pool);
+        game.game_state.thread_pool = nullptr;
+    }
 }
 
 void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::InputCommand &input_command) {
@@ -163,6 +335,11 @@ void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::Inp
             }
             break;
         }
+        case ActionHash::TRACE:
+        case ActionHash::PROFILER: {
+            // Handled by game::on_input for every gameplay implementation.
+            break;
+        }
         case ActionHash::ADD_TEN: {
             if (pressed || repeated) {
                 spawn_giraffes(engine, game, 10);
@@ -186,18 +363,50 @@ void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::Inp
     }
 }
 
-void update_mob(Mob &mob, Game &game, float dt) {
+float obstacle_drag_brute_force(Game &game, const glm::vec2 position) {
     float drag = 1.0f;
 
     // lake drags you down
     for (Obstacle *obstacle = array::begin(game.game_state.obstacles); obstacle != array::end(game.game_state.obstacles); ++obstacle) {
-        const float length = glm::length(obstacle->position - mob.position);
+        const float length = glm::length(obstacle->position - position);
         if (length <= obstacle->radius) {
             drag = 10.0f;
             break;
         }
     }
 
+    return drag;
+}
+
+float obstacle_drag(Game &game, const glm::vec2 position) {
+    const ObstacleGrid &grid = game.game_state.obstacle_grid;
+    bool in_obstacle = false;
+
+    // lake drags you down
+    obstacle_grid::query(grid, position, position, [&grid, position, &in_obstacle](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end && !in_obstacle; ++i) {
+            const float length = glm::length(glm::vec2(grid.center_x[i], grid.center_y[i]) - position);
+            if (length <= grid.radius[i]) {
+                in_obstacle = true;
+            }
+        }
+    });
+
+    const float drag = in_obstacle ? 10.0f : 1.0f;
+
+    if (game.verify) {
+        const float brute_force_drag = obstacle_drag_brute_force(game, position);
+        if (drag != brute_force_drag) {
+            log_fatal("Drag mismatch at (%f, %f): %f, brute force %f", position.x, position.y, drag, brute_force_drag);
+        }
+    }
+
+    return drag;
+}
+
+void update_mob(Mob &mob, Game &game, float dt) {
+    const float drag = obstacle_drag(game, mob.position);
+
     const glm::vec2 drag_force = -drag * mob.velocity;
     const glm::vec2 steering_force = truncate(mob.steering_direction, mob.max_force) + drag_force;
     const glm::vec2 acceleration = steering_force / mob.mass;
@@ -210,61 +419,128 @@ void update_mob(Mob &mob, Game &game, float dt) {
     }
 }
 
-glm::vec2 arrival_behavior(const Mob &mob, const glm::vec2 target_position, float speed_ramp_distance) {
-    const glm::vec2 target_offset = target_position - mob.position;
+// Integrates a giraffe stored as a structure of arrays, the same way update_mob integrates a Mob.
+void update_mob_soa(GiraffesSoA &giraffes, uint32_t index, const MobSpecies &species, Game &game, float dt) {
+    const glm::vec2 position = {giraffes.position_x[index], giraffes.position_y[index]};
+    const glm::vec2 velocity = {giraffes.velocity_x[index], giraffes.velocity_y[index]};
+    const glm::vec2 steering_direction = {giraffes.steering_direction_x[index], giraffes.steering_direction_y[index]};
+
+    const float drag = obstacle_drag(game, position);
+
+    const glm::vec2 drag_force = -drag * velocity;
+    const glm::vec2 steering_force = truncate(steering_direction, species.max_force) + drag_force;
+    const glm::vec2 acceleration = steering_force / species.mass;
+
+    const glm::vec2 new_velocity = truncate(velocity + acceleration, species.max_speed);
+    const glm::vec2 new_position = position + new_velocity * dt;
+
+    giraffes.velocity_x[index] = new_velocity.x;
+    giraffes.velocity_y[index] = new_velocity.y;
+    giraffes.position_x[index] = new_position.x;
+    giraffes.position_y[index] = new_position.y;
+
+    if (glm::length(new_velocity) > 0.001f) {
+        giraffes.orientation[index] = atan2f(-new_velocity.x, new_velocity.y);
+    }
+}
+
+glm::vec2 arrival_behavior(const glm::vec2 position, const glm::vec2 velocity, float max_speed, const glm::vec2 target_position, float speed_ramp_distance) {
+    const glm::vec2 target_offset = target_position - position;
     const float distance = glm::length(target_offset);
-    const float ramped_speed = mob.max_speed * (distance / speed_ramp_distance);
-    const float clipped_speed = std::min(ramped_speed, mob.max_speed);
+    const float ramped_speed = max_speed * (distance / speed_ramp_distance);
+    const float clipped_speed = std::min(ramped_speed, max_speed);
     const glm::vec2 desired_velocity = (clipped_speed / distance) * target_offset;
-    return desired_velocity - mob.velocity;
+    return desired_velocity - velocity;
 }
 
-glm::vec2 avoidance_behavior(const Mob &mob, engine::Engine &engine, Game &game) {
+glm::vec2 arrival_behavior(const Mob &mob, const glm::vec2 target_position, float speed_ramp_distance) {
+    return arrival_behavior(mob.position, mob.velocity, mob.max_speed, target_position, speed_ramp_distance);
+}
+
+// Lowers nearest_distance to the distance of the ray's hit on the circle, if it's within max_distance.
+void nearest_ray_hit(const glm::vec2 ray_origin, const glm::vec2 ray_direction, const glm::vec2 center, float radius, float max_distance, float &nearest_distance) {
+    glm::vec2 intersection;
+    if (ray_circle_intersection(ray_origin, ray_direction, center, radius, intersection)) {
+        float distance = glm::length(intersection - ray_origin);
+        if (distance <= max_distance && distance < nearest_distance) {
+            nearest_distance = distance;
+        }
+    }
+}
+
+void cast_avoidance_rays_brute_force(const glm::vec2 left_start, const glm::vec2 right_start, const glm::vec2 forward, float look_ahead_distance, Game &game, float &left_distance, float &right_distance) {
+    for (Obstacle *obstacle = array::begin(game.game_state.obstacles); obstacle != array::end(game.game_state.obstacles); ++obstacle) {
+        nearest_ray_hit(left_start, forward, obstacle->position, obstacle->radius, look_ahead_distance, left_distance);
+        nearest_ray_hit(right_start, forward, obstacle->position, obstacle->radius, look_ahead_distance, right_distance);
+    }
+}
+
+// Finds the distances to the nearest obstacle hits of both avoidance rays, or leaves them at FLT_MAX.
+void cast_avoidance_rays(const glm::vec2 left_start, const glm::vec2 right_start, const glm::vec2 forward, float look_ahead_distance, Game &game, float &left_distance, float &right_distance) {
+    const ObstacleGrid &grid = game.game_state.obstacle_grid;
+
+    // Any hit that counts is on one of the two ray segments, and inside its obstacle's cells. The box is padded a
+    // little, since the hit distance is compared after rounding.
+    const glm::vec2 left_end = left_start + forward * look_ahead_distance;
+    const glm::vec2 right_end = right_start + forward * look_ahead_distance;
+    const glm::vec2 padding = glm::vec2(1.0f);
+    const glm::vec2 min = glm::min(glm::min(left_start, left_end), glm::min(right_start, right_end)) - padding;
+    const glm::vec2 max = glm::max(glm::max(left_start, left_end), glm::max(right_start, right_end)) + padding;
+
+    const simd::Kernels &kernels = game.game_state.simd_kernels ? *game.game_state.simd_kernels : simd::kernels(simd::Isa::Scalar);
+
+    obstacle_grid::query(grid, min, max, [&](uint32_t begin, uint32_t end) {
+        const float *center_x = array::begin(grid.center_x) + begin;
+        const float *center_y = array::begin(grid.center_y) + begin;
+        const float *radius = array::begin(grid.radius) + begin;
+
+        float distance;
+        if (kernels.ray_circles(left_start.x, left_start.y, forward.x, forward.y, center_x, center_y, radius, end - begin, look_ahead_distance, &distance)) {
+            left_distance = std::min(left_distance, distance);
+        }
+        if (kernels.ray_circles(right_start.x, right_start.y, forward.x, forward.y, center_x, center_y, radius, end - begin, look_ahead_distance, &distance)) {
+            right_distance = std::min(right_distance, distance);
+        }
+    });
+}
+
+glm::vec2 avoidance_behavior(const glm::vec2 position, const glm::vec2 steering_target, float radius, engine::Engine &engine, Game &game) {
     const float look_ahead_distance = 200.0f;
 
-    const glm::vec2 origin = mob.position;
-    const float target_distance = glm::length(mob.steering_target - origin);
-    const glm::vec2 forward = glm::normalize(mob.steering_target - origin);
+    const glm::vec2 origin = position;
+    const float target_distance = glm::length(steering_target - origin);
+    const glm::vec2 forward = glm::normalize(steering_target - origin);
 
     const glm::vec2 right_vector = {forward.y, -forward.x};
     const glm::vec2 left_vector = {-forward.y, forward.x};
 
-    const glm::vec2 left_start = origin + left_vector * mob.radius;
-    const glm::vec2 right_start = origin + right_vector * mob.radius;
+    const glm::vec2 left_start = origin + left_vector * radius;
+    const glm::vec2 right_start = origin + right_vector * radius;
 
-    bool left_intersects = false;
-    glm::vec2 left_intersection;
     float left_intersection_distance = FLT_MAX;
-
-    bool right_intersects = false;
-    glm::vec2 right_intersection;
     float right_intersection_distance = FLT_MAX;
-
-    // check against each obstacle
-    for (Obstacle *obstacle = array::begin(game.game_state.obstacles); obstacle != array::end(game.game_state.obstacles); ++obstacle) {
-        glm::vec2 li;
-        bool did_li = ray_circle_intersection(left_start, forward, obstacle->position, obstacle->radius, li);
-        if (did_li) {
-            float distance = glm::length(li - left_start);
-            if (distance <= look_ahead_distance && distance < left_intersection_distance) {
-                left_intersects = true;
-                left_intersection = li;
-                left_intersection_distance = distance;
+    cast_avoidance_rays(left_start, right_start, forward, look_ahead_distance, game, left_intersection_distance, right_intersection_distance);
+
+    if (game.verify) {
+        float left_brute_force = FLT_MAX;
+        float right_brute_force = FLT_MAX;
+        cast_avoidance_rays_brute_force(left_start, right_start, forward, look_ahead_distance, game, left_brute_force, right_brute_force);
+        auto mismatch = [](float distance, float brute_force) {
+            if (distance == FLT_MAX || brute_force == FLT_MAX) {
+                return distance != brute_force;
             }
-        }
+            return fabsf(distance - brute_force) > AVOIDANCE_VERIFY_TOLERANCE;
+        };
 
-        glm::vec2 ri;
-        bool did_ri = ray_circle_intersection(right_start, forward, obstacle->position, obstacle->radius, ri);
-        if (did_ri) {
-            float distance = glm::length(ri - right_start);
-            if (distance <= look_ahead_distance && distance < right_intersection_distance) {
-                right_intersects = true;
-                right_intersection = li;
-                right_intersection_distance = distance;
-            }
+        if (mismatch(left_intersection_distance, left_brute_force) || mismatch(right_intersection_distance, right_brute_force)) {
+            log_fatal("Avoidance mismatch at (%f, %f): %f %f, brute force %f %f", position.x, position.y,
+                      left_intersection_distance, right_intersection_distance, left_brute_force, right_brute_force);
         }
     }
 
+    const bool left_intersects = left_intersection_distance != FLT_MAX;
+    const bool right_intersects = right_intersection_distance != FLT_MAX;
+
     glm::vec2 avoidance_force = {0.0f, 0.0f};
 
     if (right_intersects || left_intersects) {
@@ -284,6 +560,202 @@ glm::vec2 avoidance_behavior(const Mob &mob, engine::Engine &engine, Game &game)
     return avoidance_force;
 }
 
+glm::vec2 avoidance_behavior(const Mob &mob, engine::Engine &engine, Game &game) {
+    return avoidance_behavior(mob.position, mob.steering_target, mob.radius, engine, game);
+}
+
+glm::vec2 separation_offset(const glm::vec2 position, float radius, const glm::vec2 other_position, float other_radius) {
+    glm::vec2 offset = other_position - position;
+    const float distance_squared = glm::length2(offset);
+    const float near_distance_squared = (radius + other_radius) * (radius + other_radius);
+    if (distance_squared <= near_distance_squared) {
+        float distance = sqrt(distance_squared);
+        offset /= distance;
+        offset *= (radius + other_radius);
+        return offset;
+    }
+
+    return {0.0f, 0.0f};
+}
+
+glm::vec2 separation_offset(const Mob &mob, const Mob &other) {
+    return separation_offset(mob.position, mob.radius, other.position, other.radius);
+}
+
+glm::vec2 separation_behavior_brute_force(const Giraffe &giraffe, Game &game) {
+    glm::vec2 separation_force = {0.0f, 0.0f};
+
+    for (Giraffe *other_giraffe = array::begin(game.game_state.giraffes); other_giraffe != array::end(game.game_state.giraffes); ++other_giraffe) {
+        if (other_giraffe != &giraffe) {
+            separation_force -= separation_offset(giraffe.mob, other_giraffe->mob);
+        }
+    }
+
+    return separation_force;
+}
+
+glm::vec2 separation_behavior_grid(const Giraffe &giraffe, Game &game) {
+    glm::vec2 separation_force = {0.0f, 0.0f};
+
+    // The grid holds positions from the start of the frame, but the query distance is padded by how far
+    // giraffes can move in a frame, so the candidates include every giraffe near its current position.
+    spatial_grid::query(game.game_state.separation_grid, giraffe.mob.position, game.game_state.separation_query_distance, [&giraffe, &game, &separation_force](uint32_t index) {
+        const Giraffe &other_giraffe = game.game_state.giraffes[index];
+        if (&other_giraffe != &giraffe) {
+            separation_force -= separation_offset(giraffe.mob, other_giraffe.mob);
+        }
+    });
+
+    return separation_force;
+}
+
+glm::vec2 separation_behavior_brute_force_soa(uint32_t index, const MobSpecies &species, Game &game) {
+    const GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const glm::vec2 position = {giraffes.position_x[index], giraffes.position_y[index]};
+    const uint32_t count = array::size(giraffes.sprite_id);
+
+    glm::vec2 separation_force = {0.0f, 0.0f};
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (i != index) {
+            separation_force -= separation_offset(position, species.radius, {giraffes.position_x[i], giraffes.position_y[i]}, species.radius);
+        }
+    }
+
+    return separation_force;
+}
+
+glm::vec2 separation_behavior_grid_soa(uint32_t index, const MobSpecies &species, Game &game) {
+    const GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const glm::vec2 position = {giraffes.position_x[index], giraffes.position_y[index]};
+
+    glm::vec2 separation_force = {0.0f, 0.0f};
+
+    spatial_grid::query(game.game_state.separation_grid, position, game.game_state.separation_query_distance, [index, &species, &giraffes, position, &separation_force](uint32_t i) {
+        if (i != index) {
+            separation_force -= separation_offset(position, species.radius, {giraffes.position_x[i], giraffes.position_y[i]}, species.radius);
+        }
+    });
+
+    return separation_force;
+}
+
+glm::vec2 separation_behavior_simd_soa(uint32_t index, const MobSpecies &species, Game &game) {
+    const simd::Kernels &kernels = *game.game_state.simd_kernels;
+    const GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const float x = giraffes.position_x[index];
+    const float y = giraffes.position_y[index];
+    const float near_distance = species.radius + species.radius;
+
+    glm::vec2 separation_force = {0.0f, 0.0f};
+
+    if (game.game_state.separation_mode == SeparationMode::BruteForce) {
+        // Everyone before and after this giraffe.
+        const uint32_t count = array::size(giraffes.sprite_id);
+        kernels.separation(x, y, near_distance, array::begin(giraffes.position_x), array::begin(giraffes.position_y), index, &separation_force.x, &separation_force.y);
+        kernels.separation(x, y, near_distance, array::begin(giraffes.position_x) + index + 1, array::begin(giraffes.position_y) + index + 1, count - index - 1, &separation_force.x, &separation_force.y);
+    } else {
+        // Gather the candidates from the grid so the kernel can run over contiguous arrays. This runs on the
+        // thread pool too, so the candidates go in fixed buffers on the stack that are flushed when full.
+        const uint32_t chunk_size = 256;
+        float candidates_x[chunk_size];
+        float candidates_y[chunk_size];
+        uint32_t num_candidates = 0;
+
+        spatial_grid::query(game.game_state.separation_grid, {x, y}, game.game_state.separation_query_distance, [&](uint32_t i) {
+            if (i != index) {
+                candidates_x[num_candidates] = giraffes.position_x[i];
+                candidates_y[num_candidates] = giraffes.position_y[i];
+
+                if (++num_candidates == chunk_size) {
+                    kernels.separation(x, y, near_distance, candidates_x, candidates_y, num_candidates, &separation_force.x, &separation_force.y);
+                    num_candidates = 0;
+                }
+            }
+        });
+
+        kernels.separation(x, y, near_distance, candidates_x, candidates_y, num_candidates, &separation_force.x, &separation_force.y);
+    }
+
+    return separation_force;
+}
+
+void rebuild_separation_grid(Game &game, float dt) {
+    float max_radius = 0.0f;
+    float max_speed = 0.0f;
+    if (game.game_state.layout == MobLayout::ArrayOfStructs) {
+        for (Giraffe *giraffe = array::begin(game.game_state.giraffes); giraffe != array::end(game.game_state.giraffes); ++giraffe) {
+            max_radius = std::max(max_radius, giraffe->mob.radius);
+            max_speed = std::max(max_speed, giraffe->mob.max_speed);
+        }
+    } else {
+        max_radius = MOB_SPECIES[(int)Species::Giraffe].radius;
+        max_speed = MOB_SPECIES[(int)Species::Giraffe].max_speed;
+    }
+
+    // Cells are as wide as the largest separation distance, so a search usually only touches the neighboring cells.
+    const float separation_distance = 2.0f * max_radius;
+    spatial_grid::clear(game.game_state.separation_grid, std::max(separation_distance, 1.0f));
+    game.game_state.separation_query_distance = separation_distance + max_speed * dt;
+    game.game_state.separation_grid_drift = max_speed * dt;
+
+    const uint32_t count = giraffe_count(game.game_state);
+    for (uint32_t i = 0; i < count; ++i) {
+        spatial_grid::insert(game.game_state.separation_grid, i, giraffe_position(game.game_state, i));
+    }
+
+    spatial_grid::commit(game.game_state.separation_grid);
+}
+
+glm::vec2 flee_behavior(const glm::vec2 position, const glm::vec2 velocity, float max_speed, const glm::vec2 threat_position, engine::Engine &engine) {
+    const glm::vec2 flee_direction = position - threat_position;
+
+    glm::vec2 desired_velocity = glm::normalize(flee_direction) * max_speed;
+    glm::vec2 flee_force = desired_velocity - velocity;
+
+    glm::vec2 boundary_avoidance_force = {0.0f, 0.0f};
+    const float buffer_distance = 100.0f;
+
+    if (position.x <= buffer_distance) {
+        boundary_avoidance_force.x = buffer_distance - position.x;
+    } else if (position.x >= engine.window_rect.size.x - buffer_distance) {
+        boundary_avoidance_force.x = engine.window_rect.size.x - buffer_distance - position.x;
+    }
+
+    if (position.y <= buffer_distance) {
+        boundary_avoidance_force.y = buffer_distance - position.y;
+    } else if (position.y >= engine.window_rect.size.y - buffer_distance) {
+        boundary_avoidance_force.y = engine.window_rect.size.y - buffer_distance - position.y;
+    }
+
+    boundary_avoidance_force *= 20.0f;
+
+    flee_force += boundary_avoidance_force;
+    return flee_force;
+}
+
+// Queues the giraffe's sprite transform, facing the way it's moving, or on its back when it's dead.
+void transform_giraffe_sprite(Game &game, const engine::AtlasFrame *giraffe_frame, uint64_t sprite_id, const glm::vec2 position, const glm::vec2 velocity, bool dead) {
+    bool flip_x = velocity.x <= 0.0f;
+    bool flip_y = dead;
+
+    float x_offset = giraffe_frame->rect.size.x * giraffe_frame->pivot.x;
+    float y_offset = giraffe_frame->rect.size.y * (1.0f - giraffe_frame->pivot.y);
+
+    if (flip_x) {
+        x_offset *= -1.0f;
+    }
+
+    if (flip_y) {
+        y_offset *= -1.0f;
+    }
+
+    sprite_transforms::add(game.game_state.sprite_transforms, sprite_id,
+                           {floorf(position.x - x_offset), floorf(position.y - y_offset)},
+                           {(flip_x ? -1.0f : 1.0f) * giraffe_frame->rect.size.x, (flip_y ? -1.0f : 1.0f) * giraffe_frame->rect.size.y},
+                           (float)GIRAFFE_Z_LAYER);
+}
+
 void update_giraffe(Giraffe &giraffe, engine::Engine &engine, Game &game, float dt) {
     glm::vec2 arrival_force = {0.0f, 0.0f};
     const float arrival_weight = 1.0f;
@@ -297,122 +769,364 @@ void update_giraffe(Giraffe &giraffe, engine::Engine &engine, Game &game, float
     glm::vec2 avoidance_force = {0.0f, 0.0f};
     const float avoidance_weight = 10.0f;
 
-    if (!giraffe.dead) {
-        bool is_hunted = false;
+    bool is_hunted = false;
+
+    float distance = glm::length(game.game_state.lion.mob.position - giraffe.mob.position);
+    if (distance <= 300.0f) {
+        is_hunted = true;
+    }
+
+    // flee
+    if (is_hunted) {
+        const glm::vec2 flee_direction = giraffe.mob.position - game.game_state.lion.mob.position;
+        const glm::vec2 steering_target = giraffe.mob.position + flee_direction;
+        giraffe.mob.steering_target = steering_target;
+
+        flee_force = flee_behavior(giraffe.mob.position, giraffe.mob.velocity, giraffe.mob.max_speed, game.game_state.lion.mob.position, engine);
+        flee_force *= flee_weight;
+    } else {
+        // arrival
+        giraffe.mob.steering_target = game.game_state.food.position;
+        arrival_force = arrival_behavior(giraffe.mob, game.game_state.food.position, 100.0f);
+        arrival_force *= arrival_weight;
+    }
 
-        float distance = glm::length(game.game_state.lion.mob.position - giraffe.mob.position);
-        if (distance <= 300.0f) {
-            is_hunted = true;
+    // separation
+    {
+        if (game.game_state.separation_mode == SeparationMode::Grid) {
+            separation_force = separation_behavior_grid(giraffe, game);
+        } else {
+            separation_force = separation_behavior_brute_force(giraffe, game);
         }
 
-        // flee
-        if (is_hunted) {
-            const glm::vec2 flee_direction = giraffe.mob.position - game.game_state.lion.mob.position;
-            const glm::vec2 steering_target = giraffe.mob.position + flee_direction;
-            giraffe.mob.steering_target = steering_target;
+        if (game.verify) {
+            const glm::vec2 grid_force = separation_behavior_grid(giraffe, game);
+            const glm::vec2 brute_force = separation_behavior_brute_force(giraffe, game);
+            if (glm::length(grid_force - brute_force) > SEPARATION_VERIFY_TOLERANCE * (1.0f + glm::length(brute_force))) {
+                log_fatal("Separation mismatch for giraffe %u: grid (%f, %f), brute force (%f, %f)",
+                          (uint32_t)(&giraffe - array::begin(game.game_state.giraffes)),
+                          grid_force.x, grid_force.y, brute_force.x, brute_force.y);
+            }
+        }
+
+        separation_force *= separation_weight;
+    }
+
+    // avoidance
+    {
+        avoidance_force = avoidance_behavior(giraffe.mob, engine, game);
+        avoidance_force *= avoidance_weight;
+    }
 
-            glm::vec2 desired_velocity = glm::normalize(flee_direction) * giraffe.mob.max_speed;
-            flee_force = desired_velocity - giraffe.mob.velocity;
+    giraffe.mob.steering_direction = truncate(arrival_force + flee_force + separation_force + avoidance_force, giraffe.mob.max_force);
 
-            glm::vec2 boundary_avoidance_force = {0.0f, 0.0f};
-            const float buffer_distance = 100.0f;
+    update_mob(giraffe.mob, game, dt);
+}
 
-            if (giraffe.mob.position.x <= buffer_distance) {
-                boundary_avoidance_force.x = buffer_distance - giraffe.mob.position.x;
-            } else if (giraffe.mob.position.x >= engine.window_rect.size.x - buffer_distance) {
-                boundary_avoidance_force.x = engine.window_rect.size.x - buffer_distance - giraffe.mob.position.x;
-            }
+// The arrival or flee force of a giraffe stored as a structure of arrays, which also sets where it's steering to.
+glm::vec2 giraffe_goal_force_soa(uint32_t index, engine::Engine &engine, Game &game) {
+    GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
 
-            if (giraffe.mob.position.y <= buffer_distance) {
-                boundary_avoidance_force.y = buffer_distance - giraffe.mob.position.y;
-            } else if (giraffe.mob.position.y >= engine.window_rect.size.y - buffer_distance) {
-                boundary_avoidance_force.y = engine.window_rect.size.y - buffer_distance - giraffe.mob.position.y;
-            }
+    glm::vec2 arrival_force = {0.0f, 0.0f};
+    const float arrival_weight = 1.0f;
+
+    glm::vec2 flee_force = {0.0f, 0.0f};
+    float flee_weight = 1.0f;
+
+    const glm::vec2 position = {giraffes.position_x[index], giraffes.position_y[index]};
+    const glm::vec2 velocity = {giraffes.velocity_x[index], giraffes.velocity_y[index]};
+    const glm::vec2 lion_position = game.game_state.lion.mob.position;
+
+    glm::vec2 steering_target;
+
+    // flee
+    if (glm::length(lion_position - position) <= 300.0f) {
+        steering_target = position + (position - lion_position);
+        flee_force = flee_behavior(position, velocity, species.max_speed, lion_position, engine);
+        flee_force *= flee_weight;
+    } else {
+        // arrival
+        steering_target = game.game_state.food.position;
+        arrival_force = arrival_behavior(position, velocity, species.max_speed, game.game_state.food.position, 100.0f);
+        arrival_force *= arrival_weight;
+    }
 
-            boundary_avoidance_force *= 20.0f;
+    giraffes.steering_target_x[index] = steering_target.x;
+    giraffes.steering_target_y[index] = steering_target.y;
 
-            flee_force += boundary_avoidance_force;
-            flee_force *= flee_weight;
-        } else {
-            // arrival
-            giraffe.mob.steering_target = game.game_state.food.position;
-            arrival_force = arrival_behavior(giraffe.mob, game.game_state.food.position, 100.0f);
-            arrival_force *= arrival_weight;
+    return arrival_force + flee_force;
+}
+
+// The weighted separation force of a giraffe stored as a structure of arrays.
+glm::vec2 giraffe_separation_force_soa(uint32_t index, Game &game) {
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
+    const float separation_weight = 10.0f;
+
+    glm::vec2 separation_force;
+    if (game.game_state.simd_kernels) {
+        separation_force = separation_behavior_simd_soa(index, species, game);
+    } else if (game.game_state.separation_mode == SeparationMode::Grid) {
+        separation_force = separation_behavior_grid_soa(index, species, game);
+    } else {
+        separation_force = separation_behavior_brute_force_soa(index, species, game);
+    }
+
+    if (game.verify) {
+        const glm::vec2 brute_force = separation_behavior_brute_force_soa(index, species, game);
+        if (glm::length(separation_force - brute_force) > SEPARATION_VERIFY_TOLERANCE * (1.0f + glm::length(brute_force))) {
+            log_fatal("Separation mismatch for giraffe %u: (%f, %f), brute force (%f, %f)",
+                      index, separation_force.x, separation_force.y, brute_force.x, brute_force.y);
         }
+    }
 
-        // separation
-        {
-            for (Giraffe *other_giraffe = array::begin(game.game_state.giraffes); other_giraffe != array::end(game.game_state.giraffes); ++other_giraffe) {
-                if (other_giraffe != &giraffe && !other_giraffe->dead) {
-                    glm::vec2 offset = other_giraffe->mob.position - giraffe.mob.position;
-                    const float distance_squared = glm::length2(offset);
-                    const float near_distance_squared = (giraffe.mob.radius + other_giraffe->mob.radius) * (giraffe.mob.radius + other_giraffe->mob.radius);
-                    if (distance_squared <= near_distance_squared) {
-                        float distance = sqrt(distance_squared);
-                        offset /= distance;
-                        offset *= (giraffe.mob.radius + other_giraffe->mob.radius);
-                        separation_force -= offset;
-                    }
-                }
-            }
+    return separation_force * separation_weight;
+}
+
+// The weighted avoidance force of a giraffe stored as a structure of arrays, towards the target giraffe_goal_force_soa set.
+glm::vec2 giraffe_avoidance_force_soa(uint32_t index, engine::Engine &engine, Game &game) {
+    const GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
+    const float avoidance_weight = 10.0f;
+
+    const glm::vec2 position = {giraffes.position_x[index], giraffes.position_y[index]};
+    const glm::vec2 steering_target = {giraffes.steering_target_x[index], giraffes.steering_target_y[index]};
+
+    return avoidance_behavior(position, steering_target, species.radius, engine, game) * avoidance_weight;
+}
+
+// The summed steering forces of a giraffe stored as a structure of arrays, before they're truncated to its max force.
+glm::vec2 giraffe_steering_soa(uint32_t index, engine::Engine &engine, Game &game) {
+    glm::vec2 steering = giraffe_goal_force_soa(index, engine, game);
+    steering += giraffe_separation_force_soa(index, game);
+    steering += giraffe_avoidance_force_soa(index, engine, game);
+    return steering;
+}
+
+// Sums the steering forces of the giraffes in [begin, end) into their steering directions, and reads their drag. Each
+// behavior runs over all of them before the next one, so it's timed once for the range. No giraffe may move meanwhile.
+void steer_giraffes_soa(uint32_t begin, uint32_t end, engine::Engine &engine, Game &game) {
+    GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+
+    for (uint32_t i = begin; i < end; ++i) {
+        const glm::vec2 goal = giraffe_goal_force_soa(i, engine, game);
+        giraffes.steering_direction_x[i] = goal.x;
+        giraffes.steering_direction_y[i] = goal.y;
+        giraffes.drag[i] = obstacle_drag(game, {giraffes.position_x[i], giraffes.position_y[i]});
+    }
 
-            separation_force *= separation_weight;
+    {
+        ProfileScope scope(game.profiler, ProfilePhase::Separation);
+        for (uint32_t i = begin; i < end; ++i) {
+            const glm::vec2 separation = giraffe_separation_force_soa(i, game);
+            giraffes.steering_direction_x[i] += separation.x;
+            giraffes.steering_direction_y[i] += separation.y;
         }
+    }
 
-        // avoidance
-        {
-            avoidance_force = avoidance_behavior(giraffe.mob, engine, game);
-            avoidance_force *= avoidance_weight;
+    {
+        ProfileScope scope(game.profiler, ProfilePhase::Avoidance);
+        for (uint32_t i = begin; i < end; ++i) {
+            const glm::vec2 avoidance = giraffe_avoidance_force_soa(i, engine, game);
+            giraffes.steering_direction_x[i] += avoidance.x;
+            giraffes.steering_direction_y[i] += avoidance.y;
         }
     }
+}
 
-    giraffe.mob.steering_direction = truncate(arrival_force + flee_force + separation_force + avoidance_force, giraffe.mob.max_force);
+void update_giraffe_soa(uint32_t index, engine::Engine &engine, Game &game, float dt) {
+    GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
 
-    update_mob(giraffe.mob, game, dt);
+    const glm::vec2 steering_direction = truncate(giraffe_steering_soa(index, engine, game), species.max_force);
+    giraffes.steering_direction_x[index] = steering_direction.x;
+    giraffes.steering_direction_y[index] = steering_direction.y;
+
+    update_mob_soa(giraffes, index, species, game, dt);
+}
+
+// Updates every giraffe stored as a structure of arrays in passes, so truncation and integration run as SIMD kernels over all of them.
+void update_giraffes_soa_batched(engine::Engine &engine, Game &game, float dt) {
+    GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
+    const simd::Kernels &kernels = *game.game_state.simd_kernels;
+    const uint32_t count = array::size(giraffes.sprite_id);
+
+    // Steering, while every position is still where it was at the start of the frame.
+    steer_giraffes_soa(0, count, engine, game);
+
+    ProfileScope scope(game.profiler, ProfilePhase::Integration);
+
+    kernels.truncate(array::begin(giraffes.steering_direction_x), array::begin(giraffes.steering_direction_y), count, species.max_force);
+
+    kernels.integrate(array::begin(giraffes.position_x), array::begin(giraffes.position_y),
+                      array::begin(giraffes.velocity_x), array::begin(giraffes.velocity_y),
+                      array::begin(giraffes.steering_direction_x), array::begin(giraffes.steering_direction_y),
+                      array::begin(giraffes.drag), count, species.mass, species.max_force, species.max_speed, dt);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const glm::vec2 velocity = {giraffes.velocity_x[i], giraffes.velocity_y[i]};
+        if (glm::length(velocity) > 0.001f) {
+            giraffes.orientation[i] = atan2f(-velocity.x, velocity.y);
+        }
+    }
+}
+
+// What every range of update_giraffes_soa_parallel needs, handed to the thread pool as the job's context.
+struct GiraffesSoAParallelUpdate {
+    engine::Engine *engine;
+    Game *game;
+    const simd::Kernels *kernels;
+    float dt;
+};
+
+// Steers and integrates the giraffes in [begin, end), writing their new positions and velocities to the next buffers.
+void update_giraffes_soa_range(void *context, uint32_t begin, uint32_t end) {
+    const GiraffesSoAParallelUpdate &update = *static_cast<const GiraffesSoAParallelUpdate *>(context);
+    Game &game = *update.game;
+    GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+    const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
+    const simd::Kernels &kernels = *update.kernels;
+
+    TraceScope trace_scope(game.tracer, "update_giraffes_soa_parallel range");
+    const uint32_t range_count = end - begin;
+
+    steer_giraffes_soa(begin, end, *update.engine, game);
+
+    ProfileScope scope(game.profiler, ProfilePhase::Integration);
+
+    memcpy(array::begin(giraffes.next_position_x) + begin, array::begin(giraffes.position_x) + begin, sizeof(float) * range_count);
+    memcpy(array::begin(giraffes.next_position_y) + begin, array::begin(giraffes.position_y) + begin, sizeof(float) * range_count);
+    memcpy(array::begin(giraffes.next_velocity_x) + begin, array::begin(giraffes.velocity_x) + begin, sizeof(float) * range_count);
+    memcpy(array::begin(giraffes.next_velocity_y) + begin, array::begin(giraffes.velocity_y) + begin, sizeof(float) * range_count);
+
+    kernels.truncate(array::begin(giraffes.steering_direction_x) + begin, array::begin(giraffes.steering_direction_y) + begin, range_count, species.max_force);
+
+    kernels.integrate(array::begin(giraffes.next_position_x) + begin, array::begin(giraffes.next_position_y) + begin,
+                      array::begin(giraffes.next_velocity_x) + begin, array::begin(giraffes.next_velocity_y) + begin,
+                      array::begin(giraffes.steering_direction_x) + begin, array::begin(giraffes.steering_direction_y) + begin,
+                      array::begin(giraffes.drag) + begin, range_count, species.mass, species.max_force, species.max_speed, update.dt);
+
+    for (uint32_t i = begin; i < end; ++i) {
+        const glm::vec2 velocity = {giraffes.next_velocity_x[i], giraffes.next_velocity_y[i]};
+        if (glm::length(velocity) > 0.001f) {
+            giraffes.orientation[i] = atan2f(-velocity.x, velocity.y);
+        }
+    }
+}
+
+// Updates every giraffe stored as a structure of arrays on the thread pool. Each giraffe only reads the others'
+// positions from the previous frame, and only writes its own slots, so the result is the same for any number of threads.
+void update_giraffes_soa_parallel(engine::Engine &engine, Game &game, float dt) {
+    GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+
+    GiraffesSoAParallelUpdate update;
+    update.engine = &engine;
+    update.game = &game;
+    update.kernels = game.game_state.simd_kernels ? game.game_state.simd_kernels : &simd::kernels(simd::Isa::Scalar);
+    update.dt = dt;
+
+    thread_pool::parallel_for(*game.game_state.thread_pool, array::size(giraffes.sprite_id), update_giraffes_soa_range, &update);
+
+    foundation::swap(giraffes.position_x, giraffes.next_position_x);
+    foundation::swap(giraffes.position_y, giraffes.next_position_y);
+    foundation::swap(giraffes.velocity_x, giraffes.next_velocity_x);
+    foundation::swap(giraffes.velocity_y, giraffes.next_velocity_y);
+}
+
+// Leaves the giraffe's sprite behind as a gray corpse lying on its back, and removes it from the live giraffes.
+void kill_giraffe(Game &game, Handle handle) {
+    GameState &game_state = game.game_state;
+    const uint32_t index = handle_pool::destroy(game_state.giraffe_handles, handle);
 
-    const engine::AtlasFrame *giraffe_frame = engine::atlas_frame(*game.sprites->atlas, "giraffe");
+    const engine::AtlasFrame *giraffe_frame = atlas_frames::frame(game.atlas_frames, AtlasFrameHash::GIRAFFE);
     assert(giraffe_frame);
 
-    glm::mat4 transform = glm::mat4(1.0f);
-    bool flip_x = giraffe.mob.velocity.x <= 0.0f;
-    bool flip_y = giraffe.dead;
+    if (game_state.layout == MobLayout::ArrayOfStructs) {
+        const Giraffe &giraffe = game_state.giraffes[index];
+        transform_giraffe_sprite(game, giraffe_frame, giraffe.sprite_id, giraffe.mob.position, giraffe.mob.velocity, true);
+        engine::color_sprite(*game.sprites, giraffe.sprite_id, engine::color::pico8::light_gray);
+
+        swap_pop(game_state.giraffes, index);
+    } else {
+        GiraffesSoA &giraffes = game_state.giraffes_soa;
+        transform_giraffe_sprite(game, giraffe_frame, giraffes.sprite_id[index], {giraffes.position_x[index], giraffes.position_y[index]}, {giraffes.velocity_x[index], giraffes.velocity_y[index]}, true);
+        engine::color_sprite(*game.sprites, giraffes.sprite_id[index], engine::color::pico8::light_gray);
+
+        swap_pop(giraffes.sprite_id, index);
+        swap_pop(giraffes.spawn_id, index);
+        swap_pop(giraffes.position_x, index);
+        swap_pop(giraffes.position_y, index);
+        swap_pop(giraffes.velocity_x, index);
+        swap_pop(giraffes.velocity_y, index);
+        swap_pop(giraffes.steering_direction_x, index);
+        swap_pop(giraffes.steering_direction_y, index);
+        swap_pop(giraffes.steering_target_x, index);
+        swap_pop(giraffes.steering_target_y, index);
+        swap_pop(giraffes.orientation, index);
+        swap_pop(giraffes.drag, index);
+        swap_pop(giraffes.previous_position_x, index);
+        swap_pop(giraffes.previous_position_y, index);
+        swap_pop(giraffes.next_position_x, index);
+        swap_pop(giraffes.next_position_y, index);
+        swap_pop(giraffes.next_velocity_x, index);
+        swap_pop(giraffes.next_velocity_y, index);
+    }
+}
 
-    float x_offset = giraffe_frame->rect.size.x * giraffe_frame->pivot.x;
-    float y_offset = giraffe_frame->rect.size.y * (1.0f - giraffe_frame->pivot.y);
+uint32_t nearest_giraffe_brute_force(const glm::vec2 position, Game &game, float &distance) {
+    uint32_t nearest = NO_GIRAFFE;
+    distance = FLT_MAX;
+    const uint32_t count = giraffe_count(game.game_state);
+    for (uint32_t i = 0; i < count; ++i) {
+        const float d = glm::length(giraffe_position(game.game_state, i) - position);
+        if (d < distance) {
+            distance = d;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
 
-    if (flip_x) {
-        x_offset *= -1.0f;
+// The index of the nearest giraffe, or NO_GIRAFFE if there are none. Must be called before any giraffe is killed
+// in the frame, while the grid's indices are current.
+uint32_t nearest_giraffe(const glm::vec2 position, Game &game) {
+    if (game.game_state.separation_mode != SeparationMode::Grid) {
+        float distance;
+        return nearest_giraffe_brute_force(position, game, distance);
     }
 
-    if (flip_y) {
-        y_offset *= -1.0f;
+    auto giraffe_distance = [&game, position](uint32_t index) {
+        return glm::length(giraffe_position(game.game_state, index) - position);
+    };
+
+    uint32_t nearest = NO_GIRAFFE;
+    float distance = FLT_MAX;
+    spatial_grid::k_nearest(game.game_state.separation_grid, position, game.game_state.separation_grid_drift, 1, giraffe_distance, &nearest, &distance);
+
+    if (game.verify) {
+        float brute_force_distance;
+        const uint32_t brute_force = nearest_giraffe_brute_force(position, game, brute_force_distance);
+        if (distance != brute_force_distance) {
+            log_fatal("Nearest giraffe mismatch at (%f, %f): %u at %f, brute force %u at %f", position.x, position.y,
+                      nearest, distance, brute_force, brute_force_distance);
+        }
     }
 
-    transform = glm::translate(transform, glm::vec3(
-                                              floorf(giraffe.mob.position.x - x_offset),
-                                              floorf(giraffe.mob.position.y - y_offset),
-                                              GIRAFFE_Z_LAYER));
-    transform = glm::scale(transform, {(flip_x ? -1.0f : 1.0f) * giraffe_frame->rect.size.x, (flip_y ? -1.0f : 1.0f) * giraffe_frame->rect.size.y, 1.0f});
-    engine::transform_sprite(*game.sprites, giraffe.sprite_id, Matrix4f(glm::value_ptr(transform)));
+    return nearest;
 }
 
 void update_lion(Lion &lion, engine::Engine &engine, Game &game, float t, float dt) {
-    if (!lion.locked_giraffe) {
+    const HandlePool &giraffe_handles = game.game_state.giraffe_handles;
+
+    if (!handle_pool::alive(giraffe_handles, lion.locked_giraffe)) {
+        lion.locked_giraffe = NO_HANDLE;
+
         if (lion.energy >= lion.max_energy) {
-            Giraffe *found_giraffe = nullptr;
-            float distance = FLT_MAX;
-            for (Giraffe *giraffe = array::begin(game.game_state.giraffes); giraffe != array::end(game.game_state.giraffes); ++giraffe) {
-                if (!giraffe->dead) {
-                    float d = glm::length(giraffe->mob.position - lion.mob.position);
-                    if (d < distance) {
-                        distance = d;
-                        found_giraffe = giraffe;
-                    }
-                }
-            }
+            const uint32_t found_giraffe = nearest_giraffe(lion.mob.position, game);
 
-            if (found_giraffe) {
-                lion.locked_giraffe = found_giraffe;
+            if (found_giraffe != NO_GIRAFFE) {
+                lion.locked_giraffe = handle_pool::handle(giraffe_handles, found_giraffe);
                 lion.energy = lion.max_energy;
             }
         } else {
@@ -420,8 +1134,9 @@ void update_lion(Lion &lion, engine::Engine &engine, Game &game, float t, float
         }
     }
 
-    if (lion.locked_giraffe) {
-        lion.mob.steering_target = lion.locked_giraffe->mob.position;
+    if (handle_pool::alive(giraffe_handles, lion.locked_giraffe)) {
+        const glm::vec2 locked_position = giraffe_position(game.game_state, handle_pool::dense_index(giraffe_handles, lion.locked_giraffe));
+        lion.mob.steering_target = locked_position;
 
         glm::vec2 pursue_force = {0.0f, 0.0f};
         float pursue_weight = 1.0f;
@@ -431,7 +1146,7 @@ void update_lion(Lion &lion, engine::Engine &engine, Game &game, float t, float
 
         // Pursue
         {
-            glm::vec2 desired_velocity = glm::normalize(lion.locked_giraffe->mob.position - lion.mob.position) * lion.mob.max_speed;
+            glm::vec2 desired_velocity = glm::normalize(locked_position - lion.mob.position) * lion.mob.max_speed;
             pursue_force = desired_velocity - lion.mob.velocity;
             pursue_force *= pursue_weight;
         }
@@ -444,18 +1159,17 @@ void update_lion(Lion &lion, engine::Engine &engine, Game &game, float t, float
 
         lion.mob.steering_direction = truncate(pursue_force + avoidance_force, lion.mob.max_force);
 
-        if (glm::length(lion.locked_giraffe->mob.position - lion.mob.position) <= lion.mob.radius) {
-            lion.locked_giraffe->dead = true;
-            engine::color_sprite(*game.sprites, lion.locked_giraffe->sprite_id, engine::color::pico8::light_gray);
+        if (glm::length(locked_position - lion.mob.position) <= lion.mob.radius) {
+            kill_giraffe(game, lion.locked_giraffe);
 
-            lion.locked_giraffe = nullptr;
+            lion.locked_giraffe = NO_HANDLE;
             lion.energy = 0.0f;
             lion.mob.steering_direction = {0.0f, 0.0f};
 
         } else {
             lion.energy -= dt;
             if (lion.energy <= 0.0f) {
-                lion.locked_giraffe = nullptr;
+                lion.locked_giraffe = NO_HANDLE;
                 lion.energy = 0.0f;
                 lion.mob.steering_direction = {0.0f, 0.0f};
             }
@@ -463,36 +1177,110 @@ void update_lion(Lion &lion, engine::Engine &engine, Game &game, float t, float
     }
 
     update_mob(lion.mob, game, dt);
+}
 
-    const engine::AtlasFrame *lion_frame = engine::atlas_frame(*game.sprites->atlas, "lion");
+// Queues the lion's sprite transform, facing the giraffe it's hunting.
+void transform_lion_sprite(Game &game, const Lion &lion, const glm::vec2 position) {
+    const HandlePool &giraffe_handles = game.game_state.giraffe_handles;
+    const engine::AtlasFrame *lion_frame = atlas_frames::frame(game.atlas_frames, AtlasFrameHash::LION);
     assert(lion_frame);
 
-    glm::mat4 transform = glm::mat4(1.0f);
-    bool flip = lion.locked_giraffe && lion.locked_giraffe->mob.position.x < lion.mob.position.x;
+    bool flip = handle_pool::alive(giraffe_handles, lion.locked_giraffe) && giraffe_position(game.game_state, handle_pool::dense_index(giraffe_handles, lion.locked_giraffe)).x < position.x;
     float x_offset = lion_frame->rect.size.x * lion_frame->pivot.x;
     if (flip) {
         x_offset *= -1.0f;
     }
-    transform = glm::translate(transform, glm::vec3(
-                                              floorf(lion.mob.position.x - x_offset),
-                                              floorf(lion.mob.position.y - lion_frame->rect.size.y * (1.0f - lion_frame->pivot.y)),
-                                              LION_Z_LAYER));
-    transform = glm::scale(transform, {(flip ? -1.0f : 1.0f) * lion_frame->rect.size.x, lion_frame->rect.size.y, 1.0f});
-    engine::transform_sprite(*game.sprites, lion.sprite_id, Matrix4f(glm::value_ptr(transform)));
+    sprite_transforms::add(game.game_state.sprite_transforms, lion.sprite_id,
+                           {floorf(position.x - x_offset), floorf(position.y - lion_frame->rect.size.y * (1.0f - lion_frame->pivot.y))},
+                           {(flip ? -1.0f : 1.0f) * lion_frame->rect.size.x, lion_frame->rect.size.y},
+                           (float)LION_Z_LAYER);
+}
+
+// Keeps the positions from before this tick, for the sprites to be interpolated from.
+void store_previous_positions(GameState &game_state) {
+    if (game_state.layout == MobLayout::ArrayOfStructs) {
+        for (Giraffe *giraffe = array::begin(game_state.giraffes); giraffe != array::end(game_state.giraffes); ++giraffe) {
+            giraffe->mob.previous_position = giraffe->mob.position;
+        }
+    } else {
+        GiraffesSoA &giraffes = game_state.giraffes_soa;
+        const uint32_t count = array::size(giraffes.sprite_id);
+        memcpy(array::begin(giraffes.previous_position_x), array::begin(giraffes.position_x), sizeof(float) * count);
+        memcpy(array::begin(giraffes.previous_position_y), array::begin(giraffes.position_y), sizeof(float) * count);
+    }
+
+    game_state.lion.mob.previous_position = game_state.lion.mob.position;
 }
 
 void game_state_playing_update(engine::Engine &engine, Game &game, float t, float dt) {
-    for (Giraffe *giraffe = array::begin(game.game_state.giraffes); giraffe != array::end(game.game_state.giraffes); ++giraffe) {
-        update_giraffe(*giraffe, engine, game, dt);
+    ProfileScope scope(game.profiler, ProfilePhase::Update);
+
+    store_previous_positions(game.game_state);
+
+    if (game.game_state.separation_mode == SeparationMode::Grid || game.verify) {
+        ProfileScope separation_scope(game.profiler, ProfilePhase::Separation);
+        rebuild_separation_grid(game, dt);
+    }
+
+    // The phases are timed once per pass over the giraffes. These two paths steer and move every giraffe before the
+    // next one, which the ones after it see, so their phases can't be split into passes and only count as update.
+    if (game.game_state.layout == MobLayout::ArrayOfStructs) {
+        for (Giraffe *giraffe = array::begin(game.game_state.giraffes); giraffe != array::end(game.game_state.giraffes); ++giraffe) {
+            update_giraffe(*giraffe, engine, game, dt);
+        }
+    } else if (game.game_state.thread_pool) {
+        update_giraffes_soa_parallel(engine, game, dt);
+    } else if (game.game_state.simd_kernels) {
+        update_giraffes_soa_batched(engine, game, dt);
+    } else {
+        const uint32_t count = giraffe_count(game.game_state);
+        for (uint32_t i = 0; i < count; ++i) {
+            update_giraffe_soa(i, engine, game, dt);
+        }
     }
 
     update_lion(game.game_state.lion, engine, game, t, dt);
+}
+
+void game_state_playing_interpolate(engine::Engine &engine, Game &game, float t, float dt, float alpha) {
+    (void)engine;
+
+    GameState &game_state = game.game_state;
+
+    {
+        ProfileScope scope(game.profiler, ProfilePhase::Transforms);
+
+        const engine::AtlasFrame *giraffe_frame = atlas_frames::frame(game.atlas_frames, AtlasFrameHash::GIRAFFE);
+        assert(giraffe_frame);
+
+        // Sprites aren't safe to touch from several threads, so they're all transformed here.
+        if (game_state.layout == MobLayout::ArrayOfStructs) {
+            for (const Giraffe *giraffe = array::begin(game_state.giraffes); giraffe != array::end(game_state.giraffes); ++giraffe) {
+                transform_giraffe_sprite(game, giraffe_frame, giraffe->sprite_id, glm::mix(giraffe->mob.previous_position, giraffe->mob.position, alpha), giraffe->mob.velocity, false);
+            }
+        } else {
+            const GiraffesSoA &giraffes = game_state.giraffes_soa;
+            const uint32_t count = array::size(giraffes.sprite_id);
+            for (uint32_t i = 0; i < count; ++i) {
+                const glm::vec2 previous_position = {giraffes.previous_position_x[i], giraffes.previous_position_y[i]};
+                const glm::vec2 position = {giraffes.position_x[i], giraffes.position_y[i]};
+                transform_giraffe_sprite(game, giraffe_frame, giraffes.sprite_id[i], glm::mix(previous_position, position, alpha), {giraffes.velocity_x[i], giraffes.velocity_y[i]}, false);
+            }
+        }
+
+        const Lion &lion = game_state.lion;
+        transform_lion_sprite(game, lion, glm::mix(lion.mob.previous_position, lion.mob.position, alpha));
 
+        sprite_transforms::commit(game_state.sprite_transforms, *game.sprites);
+    }
+
+    ProfileScope scope(game.profiler, ProfilePhase::Sprites);
     engine::update_sprites(*game.sprites, t, dt);
     engine::commit_sprites(*game.sprites);
 }
 
 void game_state_playing_render(engine::Engine &engine, Game &game) {
+    ProfileScope scope(game.profiler, ProfilePhase::Render);
     engine::render_sprites(engine, *game.sprites);
 }
 
@@ -556,8 +1344,24 @@ void game_state_playing_render_imgui(engine::Engine &engine, Game &game) {
         };
 
         for (Giraffe *giraffe = array::begin(game.game_state.giraffes); giraffe != array::end(game.game_state.giraffes); ++giraffe) {
-            if (!giraffe->dead) {
-                debug_draw_mob(giraffe->mob);
+            debug_draw_mob(giraffe->mob);
+        }
+
+        {
+            const GiraffesSoA &giraffes = game.game_state.giraffes_soa;
+            const MobSpecies &species = MOB_SPECIES[(int)Species::Giraffe];
+            for (uint32_t i = 0; i < array::size(giraffes.sprite_id); ++i) {
+                Mob mob;
+                mob.mass = species.mass;
+                mob.max_force = species.max_force;
+                mob.max_speed = species.max_speed;
+                mob.radius = species.radius;
+                mob.position = {giraffes.position_x[i], giraffes.position_y[i]};
+                mob.velocity = {giraffes.velocity_x[i], giraffes.velocity_y[i]};
+                mob.steering_direction = {giraffes.steering_direction_x[i], giraffes.steering_direction_y[i]};
+                mob.steering_target = {giraffes.steering_target_x[i], giraffes.steering_target_y[i]};
+                mob.orientation = giraffes.orientation[i];
+                debug_draw_mob(mob);
             }
         }
 
@@ -591,14 +1395,147 @@ void game_state_playing_render_imgui(engine::Engine &engine, Game &game) {
         Buffer ss(ta);
         printf(ss, "KEY_F1: Debug Draw %s\n", game.game_state.debug_draw ? "on" : "off");
         printf(ss, "KEY_F2: Debug Avoidance %s\n", game.game_state.debug_avoidance ? "on" : "off");
+        printf(ss, "KEY_F4: Profiler %s\n", game.profiler.enabled ? "on" : "off");
         printf(ss, "KEY_1: Spawn 1 giraffe\n");
         printf(ss, "KEY_5: Spawn 5 giraffes\n");
         printf(ss, "KEY_0: Spawn 10 giraffes\n");
         printf(ss, "MOUSE_LEFT: Move food\n");
-        printf(ss, "Giraffes: %u\n", array::size(game.game_state.giraffes));
+        printf(ss, "Giraffes: %u\n", giraffe_count(game.game_state));
+        printf(ss, "Separation: %s\n", game.game_state.separation_mode == SeparationMode::Grid ? "grid" : "brute force");
+        printf(ss, "Layout: %s\n", game.game_state.layout == MobLayout::ArrayOfStructs ? "aos" : "soa");
+        printf(ss, "Threads: %u\n", game.game_state.thread_pool ? game.game_state.thread_pool->num_threads : 1);
+        printf(ss, "SIMD: %s\n", game.game_state.simd_kernels ? simd::isa_name(game.game_state.simd_kernels->isa) : "off");
 
         draw_list->AddText(ImVec2(8, 8), IM_COL32_WHITE, c_str(ss));
     }
 }
 
+void game_state_playing_hash_state(engine::Engine &engine, Game &game) {
+    (void)engine;
+
+    GameState &game_state = game.game_state;
+    StateHasher &hasher = game.state_hasher;
+
+    const Lion &lion = game_state.lion;
+    state_hash::lion(hasher, lion.mob.position.x, lion.mob.position.y, lion.mob.velocity.x, lion.mob.velocity.y, lion.energy);
+    state_hash::food(hasher, game_state.food.position.x, game_state.food.position.y);
+
+    // Giraffes are identified by their spawn id, like the scripts identify them by their spawn order. Killed giraffes
+    // are swap_popped, so the live ones are looked up by id, and the ids left without one are dead.
+    Array<uint32_t> &hashed = game_state.hashed_giraffes;
+    array::resize(hashed, game_state.giraffes_spawned);
+    for (uint32_t id = 0; id < game_state.giraffes_spawned; ++id) {
+        hashed[id] = NO_GIRAFFE;
+    }
+
+    const uint32_t count = giraffe_count(game_state);
+    for (uint32_t index = 0; index < count; ++index) {
+        if (game_state.layout == MobLayout::ArrayOfStructs) {
+            hashed[game_state.giraffes[index].spawn_id] = index;
+        } else {
+            hashed[game_state.giraffes_soa.spawn_id[index]] = index;
+        }
+    }
+
+    for (uint32_t id = 0; id < game_state.giraffes_spawned; ++id) {
+        const uint32_t index = hashed[id];
+        if (index == NO_GIRAFFE) {
+            state_hash::giraffe(hasher, id, true, 0.0f, 0.0f, 0.0f, 0.0f);
+        } else if (game_state.layout == MobLayout::ArrayOfStructs) {
+            const Mob &mob = game_state.giraffes[index].mob;
+            state_hash::giraffe(hasher, id, false, mob.position.x, mob.position.y, mob.velocity.x, mob.velocity.y);
+        } else {
+            const GiraffesSoA &giraffes = game_state.giraffes_soa;
+            state_hash::giraffe(hasher, id, false, giraffes.position_x[index], giraffes.position_y[index], giraffes.velocity_x[index], giraffes.velocity_y[index]);
+        }
+    }
+}
+
+// Calls the same primitives the scripts bind, straight from C++, as the baseline for their bridge cost. The operands
+// are read from and the results written to volatiles, so the calls can't be hoisted out of the loops or dropped.
+void game_state_playing_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls) {
+    BridgeBench &bench = game.bridge_bench;
+    const uint64_t sprite_id = game.game_state.lion.sprite_id;
+    const Matrix4f transform = engine::get_sprite(*game.sprites, sprite_id)->transform;
+
+    volatile float operand = 1.0f;
+    volatile float sink = 0.0f;
+    volatile const void *pointer_sink = nullptr;
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        sink = operand;
+    }
+    bridge_bench::end(bench, "loop", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        const glm::vec2 v = glm::vec2(operand, 2.0f) + glm::vec2(3.0f, 4.0f);
+        sink = v.x;
+    }
+    bridge_bench::end(bench, "vec2 add", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        const glm::vec2 v = glm::vec2(operand, 2.0f) * 2.0f;
+        sink = v.x;
+    }
+    bridge_bench::end(bench, "vec2 mul", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        const glm::vec2 v = glm::normalize(glm::vec2(operand, 2.0f));
+        sink = v.x;
+    }
+    bridge_bench::end(bench, "normalize", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        const glm::vec2 v = truncate(glm::vec2(3.0f, operand), 1.0f);
+        sink = v.x;
+    }
+    bridge_bench::end(bench, "truncate", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        glm::vec2 intersection;
+        ray_circle_intersection(glm::vec2(0.0f, 0.0f), glm::vec2(operand, 0.0f), glm::vec2(10.0f, 0.0f), 5.0f, intersection);
+        sink = intersection.x;
+    }
+    bridge_bench::end(bench, "ray_circle_intersection", calls);
+
+    const float center_x = 10.0f;
+    const float center_y = 0.0f;
+    const float radius = 5.0f;
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        float distance = 0.0f;
+        simd::best_kernels().ray_circles(0.0f, 0.0f, operand, 0.0f, &center_x, &center_y, &radius, 1, 100.0f, &distance);
+        sink = distance;
+    }
+    bridge_bench::end(bench, "ray_circles_intersection", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        engine::transform_sprite(*game.sprites, sprite_id, transform);
+    }
+    bridge_bench::end(bench, "transform_sprite", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        pointer_sink = engine::atlas_frame(*game.sprites->atlas, "giraffe");
+    }
+    bridge_bench::end(bench, "atlas_frame", calls);
+
+    bridge_bench::begin(bench);
+    for (uint32_t i = 0; i < calls; ++i) {
+        const math::Rect *window_rect = &engine.window_rect;
+        sink = (float)window_rect->size.x;
+    }
+    bridge_bench::end(bench, "window_rect", calls);
+
+    (void)sink;
+    (void)pointer_sink;
+}
+
 } // namespace game
@@ -0,0 +1,71 @@
+#include "handle_pool.h"
+
+#include <array.h>
+
+namespace game {
+using namespace foundation;
+
+HandlePool::HandlePool(Allocator &allocator)
+: generations(allocator)
+, dense_indices(allocator)
+, slots(allocator)
+, free_slots(allocator) {}
+
+namespace handle_pool {
+
+Handle create(HandlePool &pool) {
+    uint32_t slot;
+    if (array::empty(pool.free_slots)) {
+        slot = array::size(pool.generations);
+        array::push_back(pool.generations, 0u);
+        array::push_back(pool.dense_indices, 0u);
+    } else {
+        slot = array::back(pool.free_slots);
+        array::pop_back(pool.free_slots);
+    }
+
+    pool.dense_indices[slot] = array::size(pool.slots);
+    array::push_back(pool.slots, slot);
+
+    return {slot, pool.generations[slot]};
+}
+
+uint32_t destroy(HandlePool &pool, Handle handle) {
+    assert(alive(pool, handle));
+
+    const uint32_t index = pool.dense_indices[handle.slot];
+
+    // The last entity moves into the removed one's place.
+    const uint32_t last_slot = array::back(pool.slots);
+    pool.dense_indices[last_slot] = index;
+    swap_pop(pool.slots, index);
+
+    ++pool.generations[handle.slot];
+    array::push_back(pool.free_slots, handle.slot);
+
+    return index;
+}
+
+bool alive(const HandlePool &pool, Handle handle) {
+    // Destroying bumps the generation, so only the slot's current handle matches.
+    return handle.slot < array::size(pool.generations) && pool.generations[handle.slot] == handle.generation;
+}
+
+uint32_t dense_index(const HandlePool &pool, Handle handle) {
+    assert(alive(pool, handle));
+    return pool.dense_indices[handle.slot];
+}
+
+Handle handle(const HandlePool &pool, uint32_t dense_index) {
+    assert(dense_index < array::size(pool.slots));
+    const uint32_t slot = pool.slots[dense_index];
+    return {slot, pool.generations[slot]};
+}
+
+uint32_t size(const HandlePool &pool) {
+    return array::size(pool.slots);
+}
+
+} // namespace handle_pool
+
+} // namespace game
@@ -0,0 +1,106 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief Refers to an entity in a HandlePool, and can tell when that entity is gone even if its slot is reused.
+ *
+ */
+struct Handle {
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// A handle that never refers to anything.
+const Handle NO_HANDLE = {UINT32_MAX, 0};
+
+/**
+ * @brief Hands out generational handles to entities kept packed in dense arrays owned by the caller.
+ *
+ * Each handle has a slot in the sparse index, which maps it to a dense index. Removing an entity moves the last
+ * one into its place, the same as foundation::swap_pop, so the caller keeps its dense arrays packed by calling
+ * swap_pop with the dense index that destroy returns. Destroying bumps the slot's generation, so handles to the
+ * removed entity stop being alive instead of dangling.
+ */
+struct HandlePool {
+    HandlePool(foundation::Allocator &allocator);
+    ~HandlePool(){};
+    DELETE_COPY_AND_MOVE(HandlePool)
+
+    // The current generation of each slot.
+    foundation::Array<uint32_t> generations;
+
+    // The dense index of each slot, only meaningful while the slot is in use.
+    foundation::Array<uint32_t> dense_indices;
+
+    // The slot of each dense index.
+    foundation::Array<uint32_t> slots;
+
+    // Slots that can be reused.
+    foundation::Array<uint32_t> free_slots;
+};
+
+namespace handle_pool {
+
+/**
+ * @brief Creates a handle for an entity the caller appends to the end of its dense arrays.
+ *
+ * @param pool The pool.
+ * @return Handle The handle, whose dense index is the number of entities before it.
+ */
+Handle create(HandlePool &pool);
+
+/**
+ * @brief Destroys a handle to an alive entity.
+ *
+ * @param pool The pool.
+ * @param handle The handle to destroy.
+ * @return uint32_t The dense index the caller must swap_pop from its dense arrays.
+ */
+uint32_t destroy(HandlePool &pool, Handle handle);
+
+/**
+ * @brief Whether a handle refers to an entity that hasn't been destroyed.
+ *
+ * @param pool The pool.
+ * @param handle The handle.
+ * @return true If the handle is alive.
+ */
+bool alive(const HandlePool &pool, Handle handle);
+
+/**
+ * @brief The dense index of an alive handle's entity, which changes when other entities are destroyed.
+ *
+ * @param pool The pool.
+ * @param handle The alive handle.
+ * @return uint32_t The dense index.
+ */
+uint32_t dense_index(const HandlePool &pool, Handle handle);
+
+/**
+ * @brief The handle of the entity at a dense index.
+ *
+ * @param pool The pool.
+ * @param dense_index The dense index.
+ * @return Handle The handle.
+ */
+Handle handle(const HandlePool &pool, uint32_t dense_index);
+
+/**
+ * @brief The number of alive entities, which is the size of the caller's dense arrays.
+ *
+ * @param pool The pool.
+ * @return uint32_t The number of alive entities.
+ */
+uint32_t size(const HandlePool &pool);
+
+} // namespace handle_pool
+
+} // namespace game
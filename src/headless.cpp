@@ -0,0 +1,385 @@
+#include "headless.h"
+#include "game.h"
+
+#include <engine/engine.h>
+#include <engine/input.h>
+#include <engine/log.h>
+
+#include <array.h>
+#include <memory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+uint64_t now_ns() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Nearest-rank percentile of sorted samples.
+uint64_t percentile(const foundation::Array<uint64_t> &sorted_samples, double q) {
+    const uint32_t count = foundation::array::size(sorted_samples);
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t rank = (uint32_t)ceil(q * count);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > count) {
+        rank = count;
+    }
+
+    return sorted_samples[rank - 1];
+}
+
+// The gameplay implementation this build runs, the same as the SCRIPT it was configured with.
+const char *backend_name() {
+#if defined(HAS_LUA51)
+    return "LUA51";
+#elif defined(HAS_LUAJIT)
+    return "LUAJIT";
+#elif defined(HAS_LUAU)
+    return "LUAU";
+#elif defined(HAS_ANGELSCRIPT)
+    return "ANGELSCRIPT";
+#elif defined(HAS_ZIG)
+    return "ZIG";
+#else
+    return "LUA";
+#endif
+}
+
+// The most memory the process has had resident so far, 0 if the platform can't tell.
+uint64_t peak_memory_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (uint64_t)counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return (uint64_t)usage.ru_maxrss;
+#else
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// Closes the outputs of the run, and leaves the same way the engine does when the window closes.
+void leave(engine::Engine &engine, game::Game &game, float t, float dt) {
+    game::state_hash::close(game.state_hasher);
+    game::input_recording::close(game.input_recorder);
+
+    game::on_shutdown(engine, &game);
+    game::update(engine, &game, t, dt);
+}
+
+// Hands the game every recorded input that arrived before its next tick.
+void replay_inputs(engine::Engine &engine, game::Game &game, game::InputReplay &replay) {
+    engine::InputCommand input_command;
+    while (game::input_recording::next(replay, game.playing_ticks, input_command)) {
+        game::on_input(engine, &game, input_command);
+    }
+}
+
+} // namespace
+
+namespace headless {
+
+using namespace foundation;
+
+bool parse_options(int argc, char *argv[], Options &options) {
+    bool valid = true;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "--headless") == 0) {
+            options.enabled = true;
+        } else if (strcmp(arg, "--frames") == 0 && has_value) {
+            options.frames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--warmup") == 0 && has_value) {
+            options.warmup_frames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--dt") == 0 && has_value) {
+            options.dt = strtof(argv[++i], nullptr);
+        } else if (strcmp(arg, "--seed") == 0 && has_value) {
+            options.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--giraffes") == 0 && has_value) {
+            options.giraffes = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--verify") == 0) {
+            options.verify = true;
+        } else if (strcmp(arg, "--profile") == 0 && has_value) {
+            options.profile_path = argv[++i];
+        } else if (strcmp(arg, "--trace") == 0 && has_value) {
+            options.trace_path = argv[++i];
+        } else if (strcmp(arg, "--counters") == 0) {
+            options.counters = true;
+        } else if (strcmp(arg, "--report") == 0 && has_value) {
+            options.report_path = argv[++i];
+        } else if (strcmp(arg, "--state-hash") == 0 && has_value) {
+            options.state_hash_path = argv[++i];
+        } else if (strcmp(arg, "--state-tolerance") == 0 && has_value) {
+            options.state_tolerance = strtof(argv[++i], nullptr);
+        } else if (strcmp(arg, "--record-input") == 0 && has_value) {
+            options.record_input_path = argv[++i];
+        } else if (strcmp(arg, "--replay-input") == 0 && has_value) {
+            options.replay_input_path = argv[++i];
+        } else if (strcmp(arg, "--bridge-bench") == 0 && has_value) {
+            options.bridge_bench_path = argv[++i];
+        } else if (strcmp(arg, "--bridge-calls") == 0 && has_value) {
+            options.bridge_calls = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--startup") == 0 && has_value) {
+            options.startup_path = argv[++i];
+        } else if (strcmp(arg, "--lua-allocator") == 0 && has_value) {
+            options.lua_allocator = argv[++i];
+        } else if (strcmp(arg, "--diff-state") == 0 && i + 2 < argc) {
+            options.diff_state_a = argv[++i];
+            options.diff_state_b = argv[++i];
+        } else {
+            log_info("Unknown argument %s", arg);
+            valid = false;
+        }
+    }
+
+    if (options.dt <= 0.0f) {
+        log_info("Invalid --dt, must be positive");
+        valid = false;
+    }
+
+    if (options.state_tolerance < 0.0f) {
+        log_info("Invalid --state-tolerance, must be 0 or more");
+        valid = false;
+    }
+
+    if (options.bridge_calls == 0) {
+        log_info("Invalid --bridge-calls, must be positive");
+        valid = false;
+    }
+
+    if (options.lua_allocator && strcmp(options.lua_allocator, "slab") != 0 && strcmp(options.lua_allocator, "foundation") != 0) {
+        log_info("Invalid --lua-allocator, must be slab or foundation");
+        valid = false;
+    }
+
+    if (options.seed == 0) {
+        log_info("Invalid --seed, 0 means seeding from the clock");
+        valid = false;
+    }
+
+    return valid;
+}
+
+int run(engine::Engine &engine, game::Game &game, const Options &options) {
+    log_info("Running headless: %u warmup frames, %u frames, dt %f, seed %u", options.warmup_frames, options.frames, options.dt, options.seed);
+    if (options.verify) {
+        log_info("Verifying optimized paths against their reference implementations");
+    }
+
+    float t = 0.0f;
+
+    if (options.state_hash_path) {
+        if (!game::state_hash::open(game.state_hasher, options.state_hash_path, options.state_tolerance)) {
+            log_fatal("Could not open %s for writing", options.state_hash_path);
+        }
+        log_info("Hashing the simulation state of every frame to %s", options.state_hash_path);
+    }
+
+    if (options.record_input_path) {
+        if (!game::input_recording::open(game.input_recorder, options.record_input_path)) {
+            log_fatal("Could not open %s for writing", options.record_input_path);
+        }
+        log_info("Recording inputs to %s", options.record_input_path);
+    }
+
+    game::InputReplay replay(game.allocator);
+    if (options.replay_input_path) {
+        if (!game::input_recording::load(replay, options.replay_input_path)) {
+            log_fatal("Could not replay %s", options.replay_input_path);
+        }
+        log_info("Replaying %u inputs from %s", array::size(replay.inputs), options.replay_input_path);
+    }
+
+    // The first update transitions through Initializing into Playing, which enters the gameplay state of the active backend.
+    game::update(engine, &game, t, options.dt);
+    if (game.app_state != game::AppState::Playing) {
+        log_fatal("Headless run could not enter the playing state");
+    }
+
+    // Nothing is rendered headless, so the first frame ends with the first update.
+    game::startup::first_frame();
+    if (options.startup_path) {
+        game::startup::log();
+        if (!game::startup::write_json(backend_name(), options.startup_path)) {
+            log_fatal("Could not open %s for writing", options.startup_path);
+        }
+        log_info("Wrote startup phases to %s", options.startup_path);
+    }
+
+    if (options.bridge_bench_path) {
+        log_info("Timing %u calls to every bound primitive", options.bridge_calls);
+        game::run_bridge_bench(engine, game, options.bridge_calls);
+        game::bridge_bench::log(game.bridge_bench);
+
+        if (!game::bridge_bench::write_json(game.bridge_bench, backend_name(), options.bridge_bench_path)) {
+            log_fatal("Could not open %s for writing", options.bridge_bench_path);
+        }
+        log_info("Wrote bridge benchmark to %s", options.bridge_bench_path);
+
+        leave(engine, game, t, options.dt);
+        return 0;
+    }
+
+    // Frame 0 is the state the giraffes were spawned in.
+    game::hash_state(engine, game);
+
+    for (uint32_t i = 0; i < options.warmup_frames; ++i) {
+        t += options.dt;
+        replay_inputs(engine, game, replay);
+        game::update(engine, &game, t, options.dt);
+        game::profiler::end_frame(game.profiler);
+        game::hash_state(engine, game);
+    }
+
+    FILE *profile_file = nullptr;
+    if (options.profile_path) {
+        profile_file = fopen(options.profile_path, "w");
+        if (!profile_file) {
+            log_fatal("Could not open %s for writing", options.profile_path);
+        }
+        game::profiler::write_csv_header(game.profiler, profile_file);
+    }
+
+    Array<uint64_t> samples(game.allocator);
+    array::reserve(samples, options.frames);
+
+    // Only the measured frames count towards the totals.
+    game::profiler::reset_totals(game.profiler);
+
+    // Allocations made by the measured updates, through the allocator the game was given.
+    game::AllocationCounts allocations = {0, 0, 0};
+    const game::CountingAllocator *counting_allocator = game.profiler.allocator;
+
+    const uint64_t run_start = now_ns();
+
+    for (uint32_t i = 0; i < options.frames; ++i) {
+        t += options.dt;
+
+        game::AllocationCounts allocations_start = {0, 0, 0};
+        if (counting_allocator) {
+            allocations_start = game::counting_allocator::totals(*counting_allocator);
+        }
+
+        const uint64_t frame_start = now_ns();
+        replay_inputs(engine, game, replay);
+        game::update(engine, &game, t, options.dt);
+        array::push_back(samples, now_ns() - frame_start);
+
+        if (counting_allocator) {
+            const game::AllocationCounts end = game::counting_allocator::totals(*counting_allocator);
+            const game::AllocationCounts frame_allocations = game::counting_allocator::difference(allocations_start, end);
+            allocations.allocations += frame_allocations.allocations;
+            allocations.frees += frame_allocations.frees;
+            allocations.bytes += frame_allocations.bytes;
+        }
+
+        game::profiler::end_frame(game.profiler);
+        game::hash_state(engine, game);
+        if (profile_file) {
+            game::profiler::write_csv_row(game.profiler, profile_file);
+        }
+    }
+
+    if (profile_file) {
+        fclose(profile_file);
+        log_info("Wrote phase times to %s", options.profile_path);
+    }
+
+    const uint64_t run_time = now_ns() - run_start;
+
+    std::sort(array::begin(samples), array::end(samples));
+
+    if (array::any(samples)) {
+        log_info("Headless frames: %u", array::size(samples));
+        log_info("ns/frame: %" PRIu64, run_time / array::size(samples));
+        log_info("min: %" PRIu64 " ns", array::front(samples));
+        log_info("p50: %" PRIu64 " ns", percentile(samples, 0.50));
+        log_info("p99: %" PRIu64 " ns", percentile(samples, 0.99));
+        log_info("max: %" PRIu64 " ns", array::back(samples));
+    }
+
+    const uint64_t peak_memory = peak_memory_bytes();
+    if (peak_memory) {
+        log_info("Peak memory: %" PRIu64 " bytes", peak_memory);
+    }
+
+    if (counting_allocator && array::any(samples)) {
+        const double frames = (double)array::size(samples);
+        log_info("Allocations per frame: %.2f, frees per frame: %.2f, bytes per frame: %.1f", (double)allocations.allocations / frames,
+                 (double)allocations.frees / frames, (double)allocations.bytes / frames);
+    }
+
+    game::profiler::log_counters(game.profiler);
+    game::profiler::log_allocations(game.profiler);
+    game::profiler::log_gc(game.profiler);
+
+    if (options.report_path) {
+        FILE *report_file = fopen(options.report_path, "w");
+        if (!report_file) {
+            log_fatal("Could not open %s for writing", options.report_path);
+        }
+
+        const uint32_t count = array::size(samples);
+        fprintf(report_file, "{\"backend\":\"%s\",\"giraffes\":%u,\"warmup_frames\":%u,\"frames\":%u,\"dt\":%f,\"seed\":%u,",
+                backend_name(), options.giraffes, options.warmup_frames, count, options.dt, options.seed);
+        fprintf(report_file, "\"ns_per_frame\":%" PRIu64 ",\"min_ns\":%" PRIu64 ",\"p50_ns\":%" PRIu64 ",\"p99_ns\":%" PRIu64 ",\"max_ns\":%" PRIu64 ",",
+                count ? run_time / count : 0, count ? array::front(samples) : 0, percentile(samples, 0.50), percentile(samples, 0.99), count ? array::back(samples) : 0);
+        fprintf(report_file, "\"allocations_per_frame\":%f,\"frees_per_frame\":%f,\"bytes_per_frame\":%f,",
+                count ? (double)allocations.allocations / count : 0.0, count ? (double)allocations.frees / count : 0.0,
+                count ? (double)allocations.bytes / count : 0.0);
+        fprintf(report_file, "\"peak_memory_bytes\":%" PRIu64 ",", peak_memory);
+
+        // Every measured frame, sorted, so runs can be compared with a rank test instead of a single statistic.
+        fprintf(report_file, "\"frame_ns\":[");
+        for (const uint64_t *it = array::begin(samples); it != array::end(samples); ++it) {
+            fprintf(report_file, "%s%" PRIu64, it == array::begin(samples) ? "" : ",", *it);
+        }
+        fprintf(report_file, "]}\n");
+        fclose(report_file);
+
+        log_info("Wrote report to %s", options.report_path);
+    }
+
+    const uint32_t unplayed = array::size(replay.inputs) - replay.next;
+    if (unplayed) {
+        log_info("%u recorded inputs came after the last frame and weren't replayed", unplayed);
+    }
+
+    leave(engine, game, t, options.dt);
+
+    return 0;
+}
+
+} // namespace headless
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace engine {
+struct Engine;
+} // namespace engine
+
+namespace game {
+struct Game;
+} // namespace game
+
+namespace headless {
+
+/**
+ * @brief Options for running the simulation without the engine's render loop.
+ *
+ */
+struct Options {
+    // Whether to run headless at all.
+    bool enabled = false;
+
+    // Number of measured frames.
+    uint32_t frames = 1000;
+
+    // Number of frames to run before measuring.
+    uint32_t warmup_frames = 100;
+
+    // The fixed delta time fed to every update.
+    float dt = 1.0f / 60.0f;
+
+    // The random seed handed to the gameplay implementation.
+    uint32_t seed = 1;
+
+    // Number of giraffes to spawn, 0 uses the gameplay implementation's default.
+    uint32_t giraffes = 0;
+
+    // Whether the gameplay implementation cross-checks its optimized paths every frame.
+    bool verify = false;
+
+    // Where to write the phase times of every measured frame as CSV, nullptr to not profile.
+    const char *profile_path = nullptr;
+
+    // Where to write a Chrome trace of the run when it's done, nullptr to use [game] trace from the config.
+    const char *trace_path = nullptr;
+
+    // Whether to read hardware counters around the profiled phases, when they're available.
+    bool counters = false;
+
+    // Where to write the frame time statistics and peak memory of the run as a JSON object, nullptr to only log them.
+    const char *report_path = nullptr;
+
+    // Where to write the hash of the simulation state after every frame, nullptr to not hash it.
+    const char *state_hash_path = nullptr;
+
+    // Floats are rounded to multiples of this before they're hashed, 0 hashes their exact bits.
+    float state_tolerance = 0.0f;
+
+    // Where to record the inputs the game gets, nullptr to use [game] record_input from the config.
+    const char *record_input_path = nullptr;
+
+    // An input recording to replay into game::on_input before the same ticks it was recorded at, nullptr to not replay.
+    const char *replay_input_path = nullptr;
+
+    // Where to write the time and allocations per call of every bound primitive, nullptr to run the frames instead.
+    const char *bridge_bench_path = nullptr;
+
+    // Number of calls to each primitive in the bridge benchmark.
+    uint32_t bridge_calls = 100000;
+
+    // Where to write the time each startup phase took and the time to the first frame, nullptr to not write it.
+    const char *startup_path = nullptr;
+
+    // The allocator Lua allocates with, slab or foundation, nullptr to use [game] lua_allocator from the config.
+    const char *lua_allocator = nullptr;
+
+    // Two state hash files to compare instead of running the game, nullptr unless both are set.
+    const char *diff_state_a = nullptr;
+    const char *diff_state_b = nullptr;
+};
+
+/**
+ * @brief Parses the headless options from the command line.
+ *
+ * @param argc The argument count from main.
+ * @param argv The arguments from main.
+ * @param options The options to fill in.
+ * @return true If all arguments were recognized.
+ */
+bool parse_options(int argc, char *argv[], Options &options);
+
+/**
+ * @brief Drives game::update with a fixed dt for a number of frames and reports frame time statistics.
+ *
+ * @param engine The engine, which is never run.
+ * @param game The game to update.
+ * @param options The headless options.
+ * @return int The process exit status.
+ */
+int run(engine::Engine &engine, game::Game &game, const Options &options);
+
+} // namespace headless
@@ -23,6 +23,9 @@ extern "C" {
 #include "hash.h"
 #include "util.h"
 #include "rnd.h"
+#include "simd.h"
+#include "slab_allocator.h"
+#include "sprite_transforms.h"
 
 #include <engine/sprites.h>
 #include <engine/engine.h>
@@ -36,6 +39,7 @@ extern "C" {
 #include <engine/math.inl>
 #include <engine/atlas.h>
 #include <engine/color.inl>
+#include <engine/config.h>
 #include <engine/file.h>
 
 #include <tuple>
@@ -44,6 +48,8 @@ extern "C" {
 #include <imgui.h>
 #include <inttypes.h>
 #include <cstdarg>
+#include <stdlib.h>
+#include <string.h>
 
 #include <iostream>
 
@@ -119,6 +125,10 @@ extern "C" {
         return hit;
     }
 
+    __declspec(dllexport) bool glm_ray_circles_intersection(const Vec2Wrapper ray_origin, const Vec2Wrapper ray_direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance) {
+        return simd::best_kernels().ray_circles(ray_origin.vec.x, ray_origin.vec.y, ray_direction.vec.x, ray_direction.vec.y, center_x, center_y, radius, count, max_distance, distance);
+    }
+
     __declspec(dllexport) bool glm_ray_line_intersection(const Vec2Wrapper ray_origin, const Vec2Wrapper ray_direction, const Vec2Wrapper p1, const Vec2Wrapper p2, Vec2Wrapper *intersection) {
         glm::vec2 result;
         bool hit = ray_line_intersection(ray_origin.vec, ray_direction.vec, p1.vec, p2.vec, result);
@@ -432,6 +442,25 @@ namespace lua_glm {
 static const char *VEC2_METATABLE = "Glm.vec2";
 static const char *VEC3_METATABLE = "Glm.vec3";
 static const char *MAT4_METATABLE = "Glm.mat4";
+static const char *CIRCLES_METATABLE = "Glm.circles";
+
+// Circles laid out as arrays for ray_circles_intersection, in one userdata with the center x, center y, and radius
+// arrays following the count.
+struct Circles {
+    uint32_t count;
+};
+
+float *circles_center_x(Circles *circles) {
+    return reinterpret_cast<float *>(circles + 1);
+}
+
+float *circles_center_y(Circles *circles) {
+    return circles_center_x(circles) + circles->count;
+}
+
+float *circles_radius(Circles *circles) {
+    return circles_center_y(circles) + circles->count;
+}
 
 // Constructors for glm::vec2
 int glm_vec2_new(lua_State* L) {
@@ -667,6 +696,55 @@ int glm_ray_circle_intersection(lua_State* L) {
     return 1;  // Just one return value: boolean
 }
 
+// Copies a table of vec2 centers and a table of radii into a Glm.circles, built once for circles that don't move.
+int glm_circles_new(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
+
+    const uint32_t count = (uint32_t)lua_objlen(L, 1);
+    luaL_argcheck(L, lua_objlen(L, 2) == count, 2, "expected one radius per center");
+
+    Circles *circles = static_cast<Circles *>(lua_newuserdata(L, sizeof(Circles) + sizeof(float) * 3 * count));
+    circles->count = count;
+
+    float *center_x = circles_center_x(circles);
+    float *center_y = circles_center_y(circles);
+    float *radius = circles_radius(circles);
+    for (uint32_t i = 0; i < count; ++i) {
+        lua_rawgeti(L, 1, i + 1);
+        glm::vec2* center = static_cast<glm::vec2*>(luaL_checkudata(L, -1, VEC2_METATABLE));
+        center_x[i] = center->x;
+        center_y[i] = center->y;
+        lua_pop(L, 1);
+
+        lua_rawgeti(L, 2, i + 1);
+        radius[i] = (float)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+
+    luaL_getmetatable(L, CIRCLES_METATABLE);
+    lua_setmetatable(L, -2);
+    return 1;
+}
+
+int glm_ray_circles_intersection(lua_State* L) {
+    glm::vec2* ray_origin = static_cast<glm::vec2*>(luaL_checkudata(L, 1, VEC2_METATABLE));
+    glm::vec2* ray_direction = static_cast<glm::vec2*>(luaL_checkudata(L, 2, VEC2_METATABLE));
+    Circles* circles = static_cast<Circles*>(luaL_checkudata(L, 3, CIRCLES_METATABLE));
+    float max_distance = luaL_checknumber(L, 4);
+
+    float distance;
+    bool result = simd::best_kernels().ray_circles(ray_origin->x, ray_origin->y, ray_direction->x, ray_direction->y, circles_center_x(circles), circles_center_y(circles), circles_radius(circles), circles->count, max_distance, &distance);
+
+    lua_pushboolean(L, result);
+    if (result) {
+        lua_pushnumber(L, distance);
+        return 2;  // Two return values: boolean and the distance to the nearest hit
+    }
+
+    return 1;  // Just one return value: boolean
+}
+
 int glm_ray_line_intersection(lua_State* L) {
     glm::vec2* ray_origin = static_cast<glm::vec2*>(luaL_checkudata(L, 1, VEC2_METATABLE));
     glm::vec2* ray_direction = static_cast<glm::vec2*>(luaL_checkudata(L, 2, VEC2_METATABLE));
@@ -728,6 +806,91 @@ int glm_length2(lua_State *L) {
     return 1;
 }
 
+// The unboxed vec2 functions take and return plain numbers, so they don't allocate a userdata for every result.
+
+int glm_add2(lua_State *L) {
+    float ax = luaL_checknumber(L, 1);
+    float ay = luaL_checknumber(L, 2);
+    float bx = luaL_checknumber(L, 3);
+    float by = luaL_checknumber(L, 4);
+
+    lua_pushnumber(L, ax + bx);
+    lua_pushnumber(L, ay + by);
+    return 2;
+}
+
+int glm_sub2(lua_State *L) {
+    float ax = luaL_checknumber(L, 1);
+    float ay = luaL_checknumber(L, 2);
+    float bx = luaL_checknumber(L, 3);
+    float by = luaL_checknumber(L, 4);
+
+    lua_pushnumber(L, ax - bx);
+    lua_pushnumber(L, ay - by);
+    return 2;
+}
+
+int glm_mul2(lua_State *L) {
+    float x = luaL_checknumber(L, 1);
+    float y = luaL_checknumber(L, 2);
+    float scalar = luaL_checknumber(L, 3);
+
+    lua_pushnumber(L, x * scalar);
+    lua_pushnumber(L, y * scalar);
+    return 2;
+}
+
+int glm_div2(lua_State *L) {
+    float x = luaL_checknumber(L, 1);
+    float y = luaL_checknumber(L, 2);
+    float scalar = luaL_checknumber(L, 3);
+
+    lua_pushnumber(L, x / scalar);
+    lua_pushnumber(L, y / scalar);
+    return 2;
+}
+
+int glm_truncate2(lua_State *L) {
+    glm::vec2 vector(luaL_checknumber(L, 1), luaL_checknumber(L, 2));
+    float max_length = luaL_checknumber(L, 3);
+
+    glm::vec2 result = truncate(vector, max_length);
+
+    lua_pushnumber(L, result.x);
+    lua_pushnumber(L, result.y);
+    return 2;
+}
+
+int glm_normalize2(lua_State *L) {
+    glm::vec2 vector(luaL_checknumber(L, 1), luaL_checknumber(L, 2));
+
+    glm::vec2 result = glm::normalize(vector);
+
+    lua_pushnumber(L, result.x);
+    lua_pushnumber(L, result.y);
+    return 2;
+}
+
+int glm_ray_circles_intersection2(lua_State* L) {
+    float ray_origin_x = luaL_checknumber(L, 1);
+    float ray_origin_y = luaL_checknumber(L, 2);
+    float ray_direction_x = luaL_checknumber(L, 3);
+    float ray_direction_y = luaL_checknumber(L, 4);
+    Circles* circles = static_cast<Circles*>(luaL_checkudata(L, 5, CIRCLES_METATABLE));
+    float max_distance = luaL_checknumber(L, 6);
+
+    float distance;
+    bool result = simd::best_kernels().ray_circles(ray_origin_x, ray_origin_y, ray_direction_x, ray_direction_y, circles_center_x(circles), circles_center_y(circles), circles_radius(circles), circles->count, max_distance, &distance);
+
+    lua_pushboolean(L, result);
+    if (result) {
+        lua_pushnumber(L, distance);
+        return 2;  // Two return values: boolean and the distance to the nearest hit
+    }
+
+    return 1;  // Just one return value: boolean
+}
+
 int glm_translate(lua_State *L) {
     glm::mat4* matrix = static_cast<glm::mat4*>(luaL_checkudata(L, 1, MAT4_METATABLE));
     glm::vec3* vector = static_cast<glm::vec3*>(luaL_checkudata(L, 2, VEC3_METATABLE));
@@ -826,6 +989,12 @@ void init_module(lua_State *L) {
         lua_pop(L, 1);  // Pop the metatable off the stack
     }
 
+    // Glm.circles, only checked by type so it has no metamethods
+    {
+        luaL_newmetatable(L, CIRCLES_METATABLE);
+        lua_pop(L, 1);  // Pop the metatable off the stack
+    }
+
     // Create a table for 'Glm'
     lua_getglobal(L, "Glm");
     if (lua_isnil(L, -1)) {
@@ -848,6 +1017,12 @@ void init_module(lua_State *L) {
     lua_pushcfunc(L, glm_ray_circle_intersection, "glm_ray_circle_intersection");
     lua_setfield(L, -2, "ray_circle_intersection");
 
+    lua_pushcfunc(L, glm_circles_new, "glm_circles_new");
+    lua_setfield(L, -2, "circles");
+
+    lua_pushcfunc(L, glm_ray_circles_intersection, "glm_ray_circles_intersection");
+    lua_setfield(L, -2, "ray_circles_intersection");
+
     lua_pushcfunc(L, glm_ray_line_intersection, "glm_ray_line_intersection");
     lua_setfield(L, -2, "ray_line_intersection");
 
@@ -863,6 +1038,27 @@ void init_module(lua_State *L) {
     lua_pushcfunc(L, glm_length2, "glm_length2");
     lua_setfield(L, -2, "length2");
 
+    lua_pushcfunc(L, glm_add2, "glm_add2");
+    lua_setfield(L, -2, "add2");
+
+    lua_pushcfunc(L, glm_sub2, "glm_sub2");
+    lua_setfield(L, -2, "sub2");
+
+    lua_pushcfunc(L, glm_mul2, "glm_mul2");
+    lua_setfield(L, -2, "mul2");
+
+    lua_pushcfunc(L, glm_div2, "glm_div2");
+    lua_setfield(L, -2, "div2");
+
+    lua_pushcfunc(L, glm_truncate2, "glm_truncate2");
+    lua_setfield(L, -2, "truncate2");
+
+    lua_pushcfunc(L, glm_normalize2, "glm_normalize2");
+    lua_setfield(L, -2, "normalize2");
+
+    lua_pushcfunc(L, glm_ray_circles_intersection2, "glm_ray_circles_intersection2");
+    lua_setfield(L, -2, "ray_circles_intersection2");
+
     lua_pushcfunc(L, glm_translate, "glm_translate");
     lua_setfield(L, -2, "translate");
 
@@ -1042,6 +1238,7 @@ static const char *ENGINE_METATABLE = "Engine.Engine";
 static const char *SPRITES_METATABLE = "Engine.Sprites";
 static const char *SPRITE_METATABLE = "Engine.Sprite";
 static const char *ATLASFRAME_METATABLE = "Engine.AtlasFrame";
+static const char *ATLASFRAME_CACHE = "Engine.AtlasFrameCache";
 static const char *INPUT_COMMAND_METATABLE = "Engine.InputCommand";
 static const char *KEY_STATE_METATABLE = "Engine.KeyState";
 static const char *MOUSE_STATE_METATABLE = "Engine.MouseState";
@@ -1073,10 +1270,40 @@ int engine_atlas_frame(lua_State *L) {
 
     const char *sprite_name = luaL_checkstring(L, 2);
 
+    // Frames don't change once the atlas is loaded, so each one is pushed once and handed out from the registry after
+    // that, from a table per atlas so two atlases with a frame of the same name get their own. Every call for the same
+    // frame returns the same table, which scripts must treat as read only.
+    lua_getfield(L, LUA_REGISTRYINDEX, ATLASFRAME_CACHE);
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushvalue(L, -1);
+        lua_setfield(L, LUA_REGISTRYINDEX, ATLASFRAME_CACHE);
+    }
+
+    lua_pushlightuserdata(L, atlas);
+    lua_rawget(L, -2);
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushlightuserdata(L, atlas);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, -4);
+    }
+
+    lua_getfield(L, -1, sprite_name);
+    if (!lua_isnil(L, -1)) {
+        return 1;
+    }
+    lua_pop(L, 1);
+
     const engine::AtlasFrame *atlas_frame = engine::atlas_frame(*atlas, sprite_name);
     assert(atlas_frame != nullptr);
 
-    return push_atlas_frame(L, *atlas_frame);
+    push_atlas_frame(L, *atlas_frame);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -3, sprite_name);
+    return 1;
 }
 
 int push_sprite(lua_State *L, engine::Sprite sprite) {
@@ -1164,6 +1391,49 @@ int engine_transform_sprite(lua_State *L) {
     return 0;
 }
 
+// Transforms every sprite in a table of the fields count, sprite_id, x, y, scale_x, scale_y, and z, where all
+// but count are arrays, in one call.
+int engine_transform_sprites(lua_State *L) {
+    engine::Sprites **sprites = static_cast<engine::Sprites **>(luaL_checkudata(L, 1, SPRITES_METATABLE));
+    luaL_checktype(L, 2, LUA_TTABLE);
+    lua_settop(L, 2);
+
+    lua_getfield(L, 2, "count");
+    const uint32_t count = static_cast<uint32_t>(luaL_checkinteger(L, -1));
+    lua_pop(L, 1);
+
+    TempAllocator4096 ta;
+    Array<uint64_t> sprite_ids(ta);
+    Array<float> fields[5] = {Array<float>(ta), Array<float>(ta), Array<float>(ta), Array<float>(ta), Array<float>(ta)};
+    const char *field_names[5] = {"x", "y", "scale_x", "scale_y", "z"};
+
+    lua_getfield(L, 2, "sprite_id");
+    luaL_checktype(L, 3, LUA_TTABLE);
+    array::resize(sprite_ids, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        lua_rawgeti(L, 3, i + 1);
+        sprite_ids[i] = lua_utilities::get_identifier(L, 4).value;
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+
+    for (int field = 0; field < 5; ++field) {
+        lua_getfield(L, 2, field_names[field]);
+        luaL_checktype(L, 3, LUA_TTABLE);
+        array::resize(fields[field], count);
+        for (uint32_t i = 0; i < count; ++i) {
+            lua_rawgeti(L, 3, i + 1);
+            fields[field][i] = static_cast<float>(lua_tonumber(L, 4));
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+
+    game::transform_sprites(**sprites, array::begin(sprite_ids), array::begin(fields[0]), array::begin(fields[1]),
+                            array::begin(fields[2]), array::begin(fields[3]), array::begin(fields[4]), count);
+    return 0;
+}
+
 int engine_color_sprite(lua_State *L) {
     engine::Sprites **sprites = static_cast<engine::Sprites **>(luaL_checkudata(L, 1, SPRITES_METATABLE));
     lua_utilities::Identifier id = lua_utilities::get_identifier(L, 2);
@@ -1423,6 +1693,9 @@ void init_module(lua_State *L) {
         lua_pushcfunc(L, engine_transform_sprite, "engine_transform_sprite");
         lua_setfield(L, -2, "transform_sprite");
     
+        lua_pushcfunc(L, engine_transform_sprites, "engine_transform_sprites");
+        lua_setfield(L, -2, "transform_sprites");
+    
         lua_pushcfunc(L, engine_color_sprite, "engine_color_sprite");
         lua_setfield(L, -2, "color_sprite");
     
@@ -1670,6 +1943,12 @@ int game_index(lua_State* L) {
         return lua_engine::push_sprites(L, game->sprites);
     } else if (strcmp(key, "action_binds") == 0) {
         return lua_engine::push_action_binds(L, *game->action_binds);
+    } else if (strcmp(key, "random_seed") == 0) {
+        lua_pushnumber(L, game->random_seed);
+        return 1;
+    } else if (strcmp(key, "initial_giraffes") == 0) {
+        lua_pushnumber(L, game->initial_giraffes);
+        return 1;
     }
 
     return 0;
@@ -1709,6 +1988,10 @@ void init_module(lua_State *L) {
     lua_setfield(L, -2, "ADD_FIVE");
     lua_utilities::push_identifier(L, static_cast<uint64_t>(game::ActionHash::ADD_TEN));
     lua_setfield(L, -2, "ADD_TEN");
+    lua_utilities::push_identifier(L, static_cast<uint64_t>(game::ActionHash::TRACE));
+    lua_setfield(L, -2, "TRACE");
+    lua_utilities::push_identifier(L, static_cast<uint64_t>(game::ActionHash::PROFILER));
+    lua_setfield(L, -2, "PROFILER");
 
     lua_setfield(L, -2, "ActionHash");
 
@@ -1738,6 +2021,43 @@ void init_module(lua_State *L) {
     }, "Engine.transition");
     lua_setfield(L, -2, "transition");
 
+    lua_pushcfunc(L, [](lua_State *L) -> int {
+        game::Game **game = static_cast<game::Game**>(luaL_checkudata(L, 1, GAME_METATABLE));
+        game::state_hash::lion((*game)->state_hasher, (float)luaL_checknumber(L, 2), (float)luaL_checknumber(L, 3),
+                               (float)luaL_checknumber(L, 4), (float)luaL_checknumber(L, 5), (float)luaL_checknumber(L, 6));
+        return 0;
+    }, "Game.hash_lion");
+    lua_setfield(L, -2, "hash_lion");
+
+    lua_pushcfunc(L, [](lua_State *L) -> int {
+        game::Game **game = static_cast<game::Game**>(luaL_checkudata(L, 1, GAME_METATABLE));
+        game::state_hash::food((*game)->state_hasher, (float)luaL_checknumber(L, 2), (float)luaL_checknumber(L, 3));
+        return 0;
+    }, "Game.hash_food");
+    lua_setfield(L, -2, "hash_food");
+
+    lua_pushcfunc(L, [](lua_State *L) -> int {
+        game::Game **game = static_cast<game::Game**>(luaL_checkudata(L, 1, GAME_METATABLE));
+        game::state_hash::giraffe((*game)->state_hasher, (uint32_t)luaL_checkinteger(L, 2), lua_toboolean(L, 3) != 0,
+                                  (float)luaL_checknumber(L, 4), (float)luaL_checknumber(L, 5), (float)luaL_checknumber(L, 6), (float)luaL_checknumber(L, 7));
+        return 0;
+    }, "Game.hash_giraffe");
+    lua_setfield(L, -2, "hash_giraffe");
+
+    lua_pushcfunc(L, [](lua_State *L) -> int {
+        game::Game **game = static_cast<game::Game**>(luaL_checkudata(L, 1, GAME_METATABLE));
+        game::bridge_bench::begin((*game)->bridge_bench);
+        return 0;
+    }, "Game.bench_begin");
+    lua_setfield(L, -2, "bench_begin");
+
+    lua_pushcfunc(L, [](lua_State *L) -> int {
+        game::Game **game = static_cast<game::Game**>(luaL_checkudata(L, 1, GAME_METATABLE));
+        game::bridge_bench::end((*game)->bridge_bench, luaL_checkstring(L, 2), (uint32_t)luaL_checkinteger(L, 3));
+        return 0;
+    }, "Game.bench_end");
+    lua_setfield(L, -2, "bench_end");
+
     // Pop Game table
     lua_setglobal(L, "Game");
 }
@@ -1894,29 +2214,102 @@ static void *l_alloc (void *ud, void *ptr, size_t osize, size_t nsize) {
     return new_ptr;
 }
 
-void lua::initialize(foundation::Allocator &allocator) {
+#if !defined(HAS_LUAJIT)
+// Small blocks come from size class slabs, and resizes within a class stay in place.
+static void *l_alloc_slab(void *ud, void *ptr, size_t osize, size_t nsize) {
+    game::SlabAllocator &slab = *(static_cast<game::SlabAllocator *>(ud));
+
+    if (nsize == 0) {
+        if (ptr) {
+            game::slab_allocator::deallocate(slab, ptr, osize);
+        }
+
+        return nullptr;
+    }
+
+    void *new_ptr = game::slab_allocator::reallocate(slab, ptr, osize, nsize);
+    if (!new_ptr) {
+        log_fatal("Could not allocate memory");
+    }
+
+    return new_ptr;
+}
+
+namespace {
+// The allocator the Lua state was created with, which owns the slabs and outlives the state.
+foundation::Allocator *slab_backing = nullptr;
+
+// What Lua allocates through when [game] lua_allocator is slab.
+game::SlabAllocator *lua_slab = nullptr;
+} // namespace
+#endif
+
+void lua::initialize(foundation::Allocator &allocator, bool slab_allocator, game::CountingAllocator *counting) {
     log_info("Initializing lua");
 
+    {
+        game::StartupScope startup_scope("lua_newstate");
 #if defined(HAS_LUAJIT)
-    L = luaL_newstate();
+        if (slab_allocator) {
+            log_info("LuaJIT keeps its own allocator, [game] lua_allocator is ignored");
+        }
+        (void)counting;
+        L = luaL_newstate();
 #else
-    L = lua_newstate(l_alloc, &allocator);
+        if (slab_allocator) {
+            log_info("Lua allocates small blocks from slabs");
+            slab_backing = &allocator;
+            lua_slab = MAKE_NEW(allocator, game::SlabAllocator, allocator, counting);
+            L = lua_newstate(l_alloc_slab, lua_slab);
+        } else {
+            L = lua_newstate(l_alloc, &allocator);
+        }
 #endif
+    }
 
-    luaL_openlibs(L);
+    {
+        game::StartupScope startup_scope("luaL_openlibs");
+        luaL_openlibs(L);
+    }
 
     lua_pushcfunc(L, my_print, "print");
     lua_setglobal(L, "print");
 
-    lua_utilities::init_module(L);
-    lua_glm::init_module(L);
-    lua_math::init_module(L);
-    lua_engine::init_module(L);
-    lua_game::init_module(L);
-    lua_imgui::init_module(L);
+    {
+        game::StartupScope startup_scope("init_module");
+        {
+            game::StartupScope module_scope("lua_utilities");
+            lua_utilities::init_module(L);
+        }
+        {
+            game::StartupScope module_scope("lua_glm");
+            lua_glm::init_module(L);
+        }
+        {
+            game::StartupScope module_scope("lua_math");
+            lua_math::init_module(L);
+        }
+        {
+            game::StartupScope module_scope("lua_engine");
+            lua_engine::init_module(L);
+        }
+        {
+            game::StartupScope module_scope("lua_game");
+            lua_game::init_module(L);
+        }
+        {
+            game::StartupScope module_scope("lua_imgui");
+            lua_imgui::init_module(L);
+        }
+    }
 
-	require(L, "scripts/main.lua");
+    {
+        // Reading and compiling, with luau_compile on Luau and luaL_loadfile otherwise.
+        game::StartupScope startup_scope("require scripts/main.lua");
+        require(L, "scripts/main.lua");
+    }
 
+    game::StartupScope startup_scope("run scripts/main.lua");
     int exec_status = lua_pcall(L, 0, 0, 0);
     if (exec_status) {
         log_fatal("Could not run scripts/main.lua: %s", lua_tostring(L, -1));
@@ -1926,8 +2319,100 @@ void lua::initialize(foundation::Allocator &allocator) {
 void lua::close() {
     lua_close(L);
     L = nullptr;
+
+#if !defined(HAS_LUAJIT)
+    if (lua_slab) {
+        game::slab_allocator::log(*lua_slab);
+        foundation::Allocator &backing = *slab_backing;
+        MAKE_DELETE(backing, SlabAllocator, lua_slab);
+        lua_slab = nullptr;
+        slab_backing = nullptr;
+    }
+#endif
 }
 
+namespace {
+// Whether automatic collection is stopped while playing, and the collector only runs in steps after every update.
+bool gc_stepped = false;
+
+// Work done by every step, the data of LUA_GCSTEP, in kilobytes.
+int gc_step_kb = 16;
+
+// Longest time spent stepping the collector after an update.
+uint64_t gc_budget_ns = 1000000;
+
+// Size of the Lua heap in bytes.
+uint64_t gc_bytes() {
+    return (uint64_t)lua_gc(L, LUA_GCCOUNT, 0) * 1024 + (uint64_t)lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+// Reports the change of the Lua heap from its construction to its destruction to the profiler.
+struct GcScope {
+    GcScope(game::Profiler &profiler)
+    : profiler(profiler)
+    , start_bytes(0)
+    , start_ns(0) {
+        if (profiler.enabled) {
+            start_bytes = gc_bytes();
+            start_ns = game::profiler::now_ns();
+        }
+    }
+
+    ~GcScope() {
+        if (profiler.enabled) {
+            const uint64_t ns = game::profiler::now_ns() - start_ns;
+            game::profiler::add_gc(profiler, start_bytes, gc_bytes(), ns);
+        }
+    }
+
+    DELETE_COPY_AND_MOVE(GcScope)
+
+    game::Profiler &profiler;
+    uint64_t start_bytes;
+    uint64_t start_ns;
+};
+
+// Reads [game] lua_gc, lua_gc_step, and lua_gc_budget.
+void read_gc_config(const game::Game &game) {
+    const char *gc = engine::config::read_property(game.config, "game", "lua_gc");
+    if (gc && strcmp(gc, "step") == 0) {
+        gc_stepped = true;
+    } else if (gc && strcmp(gc, "auto") != 0) {
+        log_fatal("Invalid config file, [game] lua_gc must be auto or step");
+    }
+
+    const char *step = engine::config::read_property(game.config, "game", "lua_gc_step");
+    if (step) {
+        gc_step_kb = atoi(step);
+        if (gc_step_kb <= 0) {
+            log_fatal("Invalid config file, [game] lua_gc_step must be a positive number of kilobytes");
+        }
+    }
+
+    const char *budget = engine::config::read_property(game.config, "game", "lua_gc_budget");
+    if (budget) {
+        const float ms = strtof(budget, nullptr);
+        if (ms <= 0.0f) {
+            log_fatal("Invalid config file, [game] lua_gc_budget must be a positive number of milliseconds");
+        }
+        gc_budget_ns = (uint64_t)((double)ms * 1000000.0);
+    }
+}
+
+// Steps the collector until it finishes a cycle or the budget is spent. A step lets the collector run automatically
+// again, so it's stopped after.
+void step_gc(game::Game &game) {
+    game::ProfileScope scope(game.profiler, game::ProfilePhase::Gc);
+    GcScope gc_scope(game.profiler);
+
+    const uint64_t deadline = game::profiler::now_ns() + gc_budget_ns;
+    while (!lua_gc(L, LUA_GCSTEP, gc_step_kb) && game::profiler::now_ns() < deadline) {
+    }
+
+    lua_gc(L, LUA_GCSTOP, 0);
+}
+} // namespace
+
 // These are the implementation of the functions declared in game.cpp so that all the gameplay implementation runs in Lua.
 namespace game {
 
@@ -1936,13 +2421,23 @@ void game_state_playing_enter(engine::Engine &engine, Game &game) {
         return;
     }
 
+    read_gc_config(game);
+
     lua_getglobal(L, "on_enter");
     lua_engine::push_engine(L, engine);
     lua_game::push_game(L, game);
+    TraceScope trace_scope(game.tracer, "lua on_enter");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+    GcScope gc_scope(game.profiler);
     if (lua_pcall(L, 2, 0, 0) != 0) {
         const char *error_msg = lua_tostring(L, -1);
         log_fatal("[LUA] Error in on_enter: %s", error_msg);
     }
+
+    if (gc_stepped) {
+        log_info("Stepping the Lua collector by %d KB for up to %.3f ms after every update", gc_step_kb, (double)gc_budget_ns / 1000000.0);
+        lua_gc(L, LUA_GCSTOP, 0);
+    }
 }
 
 void game_state_playing_leave(engine::Engine &engine, Game &game) {
@@ -1953,10 +2448,16 @@ void game_state_playing_leave(engine::Engine &engine, Game &game) {
     lua_getglobal(L, "on_leave");
     lua_engine::push_engine(L, engine);
     lua_game::push_game(L, game);
+    TraceScope trace_scope(game.tracer, "lua on_leave");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
     if (lua_pcall(L, 2, 0, 0) != 0) {
         const char *error_msg = lua_tostring(L, -1);
         log_fatal("[LUA] Error in on_leave: %s", error_msg);
     }
+
+    if (gc_stepped) {
+        lua_gc(L, LUA_GCRESTART, 0);
+    }
 }
 
 void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::InputCommand &input_command) {
@@ -1968,6 +2469,9 @@ void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::Inp
     lua_engine::push_engine(L, engine);
     lua_game::push_game(L, game);
     lua_engine::push_input_command(L, input_command);
+    TraceScope trace_scope(game.tracer, "lua on_input");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+    GcScope gc_scope(game.profiler);
     if (lua_pcall(L, 3, 0, 0) != 0) {
         const char *error_msg = lua_tostring(L, -1);
         log_fatal("[LUA] Error in on_input: %s", error_msg);
@@ -1979,14 +2483,48 @@ void game_state_playing_update(engine::Engine &engine, Game &game, float t, floa
         return;
     }
 
+    ProfileScope scope(game.profiler, ProfilePhase::Update);
+
     lua_getglobal(L, "update");
     lua_engine::push_engine(L, engine);
     lua_game::push_game(L, game);
     lua_pushnumber(L, t);
     lua_pushnumber(L, dt);
-    if (lua_pcall(L, 4, 0, 0) != 0) {
+    {
+        TraceScope trace_scope(game.tracer, "lua update");
+        ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+        GcScope gc_scope(game.profiler);
+        if (lua_pcall(L, 4, 0, 0) != 0) {
+            const char *error_msg = lua_tostring(L, -1);
+            log_fatal("[LUA] Error in update: %s", error_msg);
+        }
+    }
+
+    if (gc_stepped) {
+        TraceScope trace_scope(game.tracer, "lua gc step");
+        step_gc(game);
+    }
+}
+
+void game_state_playing_interpolate(engine::Engine &engine, Game &game, float t, float dt, float alpha) {
+    if (!L) {
+        return;
+    }
+
+    ProfileScope scope(game.profiler, ProfilePhase::Transforms);
+
+    lua_getglobal(L, "interpolate");
+    lua_engine::push_engine(L, engine);
+    lua_game::push_game(L, game);
+    lua_pushnumber(L, t);
+    lua_pushnumber(L, dt);
+    lua_pushnumber(L, alpha);
+    TraceScope trace_scope(game.tracer, "lua interpolate");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+    GcScope gc_scope(game.profiler);
+    if (lua_pcall(L, 5, 0, 0) != 0) {
         const char *error_msg = lua_tostring(L, -1);
-        log_fatal("[LUA] Error in update: %s", error_msg);
+        log_fatal("[LUA] Error in interpolate: %s", error_msg);
     }
 }
 
@@ -1995,9 +2533,14 @@ void game_state_playing_render(engine::Engine &engine, Game &game) {
         return;
     }
 
+    ProfileScope scope(game.profiler, ProfilePhase::Render);
+
     lua_getglobal(L, "render");
     lua_engine::push_engine(L, engine);
     lua_game::push_game(L, game);
+    TraceScope trace_scope(game.tracer, "lua render");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+    GcScope gc_scope(game.profiler);
     if (lua_pcall(L, 2, 0, 0) != 0) {
         const char *error_msg = lua_tostring(L, -1);
         log_fatal("[LUA] Error in render: %s", error_msg);
@@ -2012,12 +2555,46 @@ void game_state_playing_render_imgui(engine::Engine &engine, Game &game) {
     lua_getglobal(L, "render_imgui");
     lua_engine::push_engine(L, engine);
     lua_game::push_game(L, game);
+    TraceScope trace_scope(game.tracer, "lua render_imgui");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+    GcScope gc_scope(game.profiler);
     if (lua_pcall(L, 2, 0, 0) != 0) {
         const char *error_msg = lua_tostring(L, -1);
         log_fatal("[LUA] Error in render_imgui: %s", error_msg);
     }
 }
 
+void game_state_playing_hash_state(engine::Engine &engine, Game &game) {
+    if (!L) {
+        return;
+    }
+
+    lua_getglobal(L, "hash_state");
+    lua_engine::push_engine(L, engine);
+    lua_game::push_game(L, game);
+    TraceScope trace_scope(game.tracer, "lua hash_state");
+    if (lua_pcall(L, 2, 0, 0) != 0) {
+        const char *error_msg = lua_tostring(L, -1);
+        log_fatal("[LUA] Error in hash_state: %s", error_msg);
+    }
+}
+
+void game_state_playing_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls) {
+    if (!L) {
+        return;
+    }
+
+    lua_getglobal(L, "bridge_bench");
+    lua_engine::push_engine(L, engine);
+    lua_game::push_game(L, game);
+    lua_pushinteger(L, calls);
+    TraceScope trace_scope(game.tracer, "lua bridge_bench");
+    if (lua_pcall(L, 3, 0, 0) != 0) {
+        const char *error_msg = lua_tostring(L, -1);
+        log_fatal("[LUA] Error in bridge_bench: %s", error_msg);
+    }
+}
+
 } // namespace game
 
 #endif // HAS_LUA
@@ -4,9 +4,13 @@
 
 #if defined(HAS_LUA)
 
+namespace game {
+class CountingAllocator;
+} // namespace game
+
 namespace lua {
 
-void initialize(foundation::Allocator &allocator);
+void initialize(foundation::Allocator &allocator, bool slab_allocator, game::CountingAllocator *counting);
 void close();
 
 } // namespace lua
@@ -0,0 +1,225 @@
+#include "input_recording.h"
+
+#include <engine/log.h>
+
+#include <array.h>
+
+#include <string.h>
+
+namespace {
+// Identifies an input recording.
+const char INPUT_RECORDING_MAGIC[8] = {'G', 'I', 'N', 'P', 'U', 'T', '0', '1'};
+
+// Bits of the modifier byte of a recorded key.
+const uint8_t MODIFIER_SHIFT = 1;
+const uint8_t MODIFIER_ALT = 2;
+const uint8_t MODIFIER_CTRL = 4;
+
+void write_u8(FILE *file, uint8_t value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+void write_i16(FILE *file, int16_t value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+void write_u32(FILE *file, uint32_t value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+void write_f32(FILE *file, float value) {
+    fwrite(&value, sizeof(value), 1, file);
+}
+
+bool read_u8(FILE *file, uint8_t &value) {
+    return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+bool read_i16(FILE *file, int16_t &value) {
+    return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+bool read_u32(FILE *file, uint32_t &value) {
+    return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+bool read_f32(FILE *file, float &value) {
+    return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+// Reads the fields of an input of the given type, false if the file ends first or the type is unknown.
+bool read_input(FILE *file, uint8_t input_type, engine::InputCommand &input_command) {
+    input_command.input_type = (engine::InputType)input_type;
+
+    switch (input_command.input_type) {
+    case engine::InputType::Key: {
+        engine::KeyState &key_state = input_command.key_state;
+        uint8_t trigger_state;
+        uint8_t modifiers;
+        if (!read_i16(file, key_state.keycode) || !read_u8(file, trigger_state) || !read_u8(file, modifiers)) {
+            return false;
+        }
+
+        key_state.trigger_state = (engine::TriggerState)trigger_state;
+        key_state.shift_state = (modifiers & MODIFIER_SHIFT) != 0;
+        key_state.alt_state = (modifiers & MODIFIER_ALT) != 0;
+        key_state.ctrl_state = (modifiers & MODIFIER_CTRL) != 0;
+        return true;
+    }
+    case engine::InputType::Mouse: {
+        engine::MouseState &mouse_state = input_command.mouse_state;
+        uint8_t mouse_action;
+        uint8_t left_state;
+        uint8_t right_state;
+        if (!read_u8(file, mouse_action) || !read_u8(file, left_state) || !read_u8(file, right_state) ||
+            !read_f32(file, mouse_state.mouse_position.x) || !read_f32(file, mouse_state.mouse_position.y) ||
+            !read_f32(file, mouse_state.mouse_relative_motion.x) || !read_f32(file, mouse_state.mouse_relative_motion.y)) {
+            return false;
+        }
+
+        mouse_state.mouse_action = (engine::MouseAction)mouse_action;
+        mouse_state.mouse_left_state = (engine::TriggerState)left_state;
+        mouse_state.mouse_right_state = (engine::TriggerState)right_state;
+        return true;
+    }
+    case engine::InputType::Scroll: {
+        engine::ScrollState &scroll_state = input_command.scroll_state;
+        return read_f32(file, scroll_state.x_offset) && read_f32(file, scroll_state.y_offset);
+    }
+    default: {
+        return false;
+    }
+    }
+}
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+InputRecorder::InputRecorder()
+: file(nullptr)
+, count(0) {}
+
+InputReplay::InputReplay(Allocator &allocator)
+: inputs(allocator)
+, next(0) {}
+
+namespace input_recording {
+
+bool open(InputRecorder &recorder, const char *path) {
+    close(recorder);
+
+    recorder.file = fopen(path, "wb");
+    if (!recorder.file) {
+        return false;
+    }
+
+    recorder.count = 0;
+    fwrite(INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC), 1, recorder.file);
+
+    return true;
+}
+
+void close(InputRecorder &recorder) {
+    if (recorder.file) {
+        fclose(recorder.file);
+        recorder.file = nullptr;
+    }
+}
+
+void record(InputRecorder &recorder, uint32_t frame, const engine::InputCommand &input_command) {
+    if (!recorder.file) {
+        return;
+    }
+
+    FILE *file = recorder.file;
+
+    switch (input_command.input_type) {
+    case engine::InputType::Key: {
+        const engine::KeyState &key_state = input_command.key_state;
+        write_u32(file, frame);
+        write_u8(file, (uint8_t)input_command.input_type);
+        write_i16(file, key_state.keycode);
+        write_u8(file, (uint8_t)key_state.trigger_state);
+        write_u8(file, (key_state.shift_state ? MODIFIER_SHIFT : 0) | (key_state.alt_state ? MODIFIER_ALT : 0) | (key_state.ctrl_state ? MODIFIER_CTRL : 0));
+        break;
+    }
+    case engine::InputType::Mouse: {
+        const engine::MouseState &mouse_state = input_command.mouse_state;
+        write_u32(file, frame);
+        write_u8(file, (uint8_t)input_command.input_type);
+        write_u8(file, (uint8_t)mouse_state.mouse_action);
+        write_u8(file, (uint8_t)mouse_state.mouse_left_state);
+        write_u8(file, (uint8_t)mouse_state.mouse_right_state);
+        write_f32(file, mouse_state.mouse_position.x);
+        write_f32(file, mouse_state.mouse_position.y);
+        write_f32(file, mouse_state.mouse_relative_motion.x);
+        write_f32(file, mouse_state.mouse_relative_motion.y);
+        break;
+    }
+    case engine::InputType::Scroll: {
+        const engine::ScrollState &scroll_state = input_command.scroll_state;
+        write_u32(file, frame);
+        write_u8(file, (uint8_t)input_command.input_type);
+        write_f32(file, scroll_state.x_offset);
+        write_f32(file, scroll_state.y_offset);
+        break;
+    }
+    default: {
+        return;
+    }
+    }
+
+    ++recorder.count;
+}
+
+bool load(InputReplay &replay, const char *path) {
+    array::clear(replay.inputs);
+    replay.next = 0;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        log_info("Could not open %s", path);
+        return false;
+    }
+
+    char magic[sizeof(INPUT_RECORDING_MAGIC)];
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, INPUT_RECORDING_MAGIC, sizeof(magic)) != 0) {
+        log_info("%s is not an input recording", path);
+        fclose(file);
+        return false;
+    }
+
+    bool valid = true;
+
+    RecordedInput input;
+    uint8_t input_type;
+    while (read_u32(file, input.frame)) {
+        memset(&input.input_command, 0, sizeof(input.input_command));
+
+        if (!read_u8(file, input_type) || !read_input(file, input_type, input.input_command)) {
+            log_info("%s is truncated or corrupt after %u inputs", path, array::size(replay.inputs));
+            valid = false;
+            break;
+        }
+
+        array::push_back(replay.inputs, input);
+    }
+
+    fclose(file);
+    return valid;
+}
+
+bool next(InputReplay &replay, uint32_t frame, engine::InputCommand &input_command) {
+    if (replay.next >= array::size(replay.inputs) || replay.inputs[replay.next].frame > frame) {
+        return false;
+    }
+
+    input_command = replay.inputs[replay.next].input_command;
+    ++replay.next;
+    return true;
+}
+
+} // namespace input_recording
+
+} // namespace game
@@ -0,0 +1,109 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <engine/input.h>
+#include <stdint.h>
+#include <stdio.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief Writes every input the playing state gets to a file, with the gameplay tick it arrived before.
+ *
+ * The file is "GINPUT01" followed by one record per input: the frame as a uint32, the input type as a uint8, and then
+ * only the fields of that type. Keys are the keycode as an int16, the trigger state, and the shift, alt, and ctrl
+ * states as bits of a uint8. Mouse inputs are the action and the left and right trigger states as uint8s, and the
+ * position and relative motion as floats. Scrolls are the two offsets as floats.
+ */
+struct InputRecorder {
+    InputRecorder();
+    ~InputRecorder(){};
+    DELETE_COPY_AND_MOVE(InputRecorder)
+
+    // The file being written, nullptr when not recording.
+    FILE *file;
+
+    // Number of inputs recorded.
+    uint32_t count;
+};
+
+/**
+ * @brief An input read from a recording.
+ *
+ */
+struct RecordedInput {
+    // Number of gameplay ticks in the playing state before the input arrived.
+    uint32_t frame;
+
+    engine::InputCommand input_command;
+};
+
+/**
+ * @brief A recording read into memory, so replaying it doesn't touch the file.
+ *
+ */
+struct InputReplay {
+    InputReplay(foundation::Allocator &allocator);
+    ~InputReplay(){};
+    DELETE_COPY_AND_MOVE(InputReplay)
+
+    // Every recorded input, in the order they arrived.
+    foundation::Array<RecordedInput> inputs;
+
+    // The first input that hasn't been replayed.
+    uint32_t next;
+};
+
+namespace input_recording {
+
+/**
+ * @brief Starts recording inputs to a file.
+ *
+ * @param recorder The recorder.
+ * @param path The file to write.
+ * @return bool Whether the file could be opened.
+ */
+bool open(InputRecorder &recorder, const char *path);
+
+/**
+ * @brief Stops recording and closes the file.
+ *
+ * @param recorder The recorder.
+ */
+void close(InputRecorder &recorder);
+
+/**
+ * @brief Records an input, if the recorder is open.
+ *
+ * @param recorder The recorder.
+ * @param frame Number of gameplay ticks in the playing state before the input arrived.
+ * @param input_command The input.
+ */
+void record(InputRecorder &recorder, uint32_t frame, const engine::InputCommand &input_command);
+
+/**
+ * @brief Reads a recording to replay.
+ *
+ * @param replay The replay, which starts over from the first input.
+ * @param path The recording.
+ * @return bool Whether the file could be read, it's logged why not.
+ */
+bool load(InputReplay &replay, const char *path);
+
+/**
+ * @brief Takes the next input to replay, if it arrived before the given tick.
+ *
+ * @param replay The replay.
+ * @param frame Number of gameplay ticks in the playing state so far.
+ * @param input_command Set to the input.
+ * @return bool Whether there was an input, call again until there isn't.
+ */
+bool next(InputReplay &replay, uint32_t frame, engine::InputCommand &input_command);
+
+} // namespace input_recording
+
+} // namespace game
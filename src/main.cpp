@@ -8,6 +8,7 @@
 
 #include <backward.hpp>
 #include <memory.h>
+#include <string.h>
 
 #if defined(LIVE_PP)
 #define WIN32_LEAN_AND_MEAN
@@ -18,11 +19,9 @@
 #pragma warning(pop)
 
 #include "game.h"
+#include "headless.h"
 
 int main(int argc, char *argv[]) {
-    (void)argc;
-    (void)argv;
-
     // Validate platform
     {
         unsigned int x = 1;
@@ -40,21 +39,56 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    headless::Options headless_options;
+    if (!headless::parse_options(argc, argv, headless_options)) {
+        log_fatal("Usage: %s [--headless] [--frames N] [--warmup N] [--dt SECONDS] [--seed N] [--giraffes N] [--verify] [--profile CSV] [--trace JSON] [--counters] [--report JSON] [--state-hash FILE] [--state-tolerance T] [--record-input FILE] [--replay-input FILE] [--bridge-bench JSON] [--bridge-calls N] [--startup JSON] [--lua-allocator slab|foundation] [--diff-state FILE FILE]", argv[0]);
+    }
+
+    if (headless_options.diff_state_a) {
+        return game::state_hash::diff(headless_options.diff_state_a, headless_options.diff_state_b);
+    }
+
 #if defined(LIVE_PP)
     lpp::LppDefaultAgent lpp_agent = lpp::LppCreateDefaultAgent(nullptr, L"LivePP");
     lpp_agent.EnableModule(lpp::LppGetCurrentModulePath(), lpp::LPP_MODULES_OPTION_ALL_IMPORT_MODULES, nullptr, nullptr);
 #endif
 
+    game::startup::start();
+
     int status = 0;
     backward::SignalHandling sh;
     foundation::memory_globals::init();
-    foundation::Allocator &allocator = foundation::memory_globals::default_allocator();
 
     {
+        // Everything the engine, the game, and the script VMs allocate goes through this, so the profiler can count it.
+        game::CountingAllocator allocator(foundation::memory_globals::default_allocator());
+
         const char *config_path = "assets/config.ini";
+        game::startup::begin("engine init");
         engine::Engine engine(allocator, config_path);
+        game::startup::end();
 
+        game::startup::begin("game init");
         game::Game game(allocator, config_path);
+        game::startup::end();
+        game::profiler::count_allocations(game.profiler, allocator);
+        if (headless_options.enabled) {
+            game.random_seed = headless_options.seed;
+            game.initial_giraffes = headless_options.giraffes;
+            game.verify = headless_options.verify;
+            game.profiler.enabled = headless_options.profile_path != nullptr || headless_options.counters;
+            if (headless_options.counters) {
+                game::profiler::enable_counters(game.profiler);
+            }
+            if (headless_options.lua_allocator) {
+                game.lua_slab_allocator = strcmp(headless_options.lua_allocator, "slab") == 0;
+            }
+            if (headless_options.trace_path) {
+                game.tracer.path = headless_options.trace_path;
+                game.tracer.enabled = true;
+            }
+        }
+
         engine::EngineCallbacks engine_callbacks;
         engine_callbacks.on_input = game::on_input;
         engine_callbacks.update = game::update;
@@ -64,7 +98,11 @@ int main(int argc, char *argv[]) {
         engine.engine_callbacks = &engine_callbacks;
         engine.game_object = &game;
 
-        status = engine::run(engine);
+        if (headless_options.enabled) {
+            status = headless::run(engine, game, headless_options);
+        } else {
+            status = engine::run(engine);
+        }
     }
 
     foundation::memory_globals::shutdown();
@@ -0,0 +1,121 @@
+#include "obstacle_grid.h"
+
+#include <array.h>
+
+#include <float.h>
+#include <string.h>
+
+namespace {
+// Keeps the grid bounded when circles are spread far apart, by growing the cells instead.
+const uint32_t MAX_CELLS_PER_AXIS = 256;
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+ObstacleGrid::ObstacleGrid(Allocator &allocator)
+: cell_size(1.0f)
+, origin({0.0f, 0.0f})
+, columns(0)
+, rows(0)
+, circles(allocator)
+, cell_starts(allocator)
+, center_x(allocator)
+, center_y(allocator)
+, radius(allocator) {}
+
+namespace obstacle_grid {
+
+void add(ObstacleGrid &grid, glm::vec2 center, float radius) {
+    array::push_back(grid.circles, {center, radius});
+}
+
+void commit(ObstacleGrid &grid, float cell_size) {
+    assert(cell_size > 0.0f);
+
+    grid.cell_size = cell_size;
+    grid.origin = {0.0f, 0.0f};
+    grid.columns = 0;
+    grid.rows = 0;
+    array::clear(grid.cell_starts);
+    array::clear(grid.center_x);
+    array::clear(grid.center_y);
+    array::clear(grid.radius);
+
+    if (array::empty(grid.circles)) {
+        return;
+    }
+
+    glm::vec2 min = {FLT_MAX, FLT_MAX};
+    glm::vec2 max = {-FLT_MAX, -FLT_MAX};
+    for (const ObstacleGrid::Circle *circle = array::begin(grid.circles); circle != array::end(grid.circles); ++circle) {
+        min = glm::min(min, circle->center - glm::vec2(circle->radius));
+        max = glm::max(max, circle->center + glm::vec2(circle->radius));
+    }
+
+    const glm::vec2 extent = max - min;
+    const float largest_extent = extent.x > extent.y ? extent.x : extent.y;
+    if (largest_extent / grid.cell_size >= (float)MAX_CELLS_PER_AXIS) {
+        grid.cell_size = largest_extent / (float)(MAX_CELLS_PER_AXIS - 1);
+    }
+
+    grid.origin = min;
+    grid.columns = (uint32_t)(extent.x / grid.cell_size) + 1;
+    grid.rows = (uint32_t)(extent.y / grid.cell_size) + 1;
+
+    // The range of cells overlapped by a circle's bounding box.
+    auto cell_range = [&grid](const ObstacleGrid::Circle &circle, uint32_t &min_x, uint32_t &min_y, uint32_t &max_x, uint32_t &max_y) {
+        min_x = (uint32_t)((circle.center.x - circle.radius - grid.origin.x) / grid.cell_size);
+        min_y = (uint32_t)((circle.center.y - circle.radius - grid.origin.y) / grid.cell_size);
+        max_x = (uint32_t)((circle.center.x + circle.radius - grid.origin.x) / grid.cell_size);
+        max_y = (uint32_t)((circle.center.y + circle.radius - grid.origin.y) / grid.cell_size);
+        max_x = max_x < grid.columns ? max_x : grid.columns - 1;
+        max_y = max_y < grid.rows ? max_y : grid.rows - 1;
+    };
+
+    const uint32_t cell_count = grid.columns * grid.rows;
+    array::resize(grid.cell_starts, cell_count + 1);
+    memset(array::begin(grid.cell_starts), 0, sizeof(uint32_t) * (cell_count + 1));
+
+    for (const ObstacleGrid::Circle *circle = array::begin(grid.circles); circle != array::end(grid.circles); ++circle) {
+        uint32_t min_x, min_y, max_x, max_y;
+        cell_range(*circle, min_x, min_y, max_x, max_y);
+        for (uint32_t y = min_y; y <= max_y; ++y) {
+            for (uint32_t x = min_x; x <= max_x; ++x) {
+                ++grid.cell_starts[y * grid.columns + x + 1];
+            }
+        }
+    }
+
+    for (uint32_t i = 1; i <= cell_count; ++i) {
+        grid.cell_starts[i] += grid.cell_starts[i - 1];
+    }
+
+    const uint32_t copies = grid.cell_starts[cell_count];
+    array::resize(grid.center_x, copies);
+    array::resize(grid.center_y, copies);
+    array::resize(grid.radius, copies);
+
+    // Fill each cell from its start, moving the start forward, then shift the starts back in place.
+    for (const ObstacleGrid::Circle *circle = array::begin(grid.circles); circle != array::end(grid.circles); ++circle) {
+        uint32_t min_x, min_y, max_x, max_y;
+        cell_range(*circle, min_x, min_y, max_x, max_y);
+        for (uint32_t y = min_y; y <= max_y; ++y) {
+            for (uint32_t x = min_x; x <= max_x; ++x) {
+                const uint32_t copy = grid.cell_starts[y * grid.columns + x]++;
+                grid.center_x[copy] = circle->center.x;
+                grid.center_y[copy] = circle->center.y;
+                grid.radius[copy] = circle->radius;
+            }
+        }
+    }
+
+    for (uint32_t i = cell_count; i > 0; --i) {
+        grid.cell_starts[i] = grid.cell_starts[i - 1];
+    }
+    grid.cell_starts[0] = 0;
+}
+
+} // namespace obstacle_grid
+
+} // namespace game
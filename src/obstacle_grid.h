@@ -0,0 +1,106 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <glm/glm.hpp>
+#include <math.h>
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief A uniform grid over static circles, built once after they're spawned.
+ *
+ * Every cell holds its own copy of each circle whose bounding box overlaps it, laid out as contiguous arrays, so
+ * a query walks a few runs of circles without indirection. A circle can show up in several cells, which is
+ * harmless for queries that look for the nearest hit or any hit.
+ */
+struct ObstacleGrid {
+    struct Circle {
+        glm::vec2 center;
+        float radius;
+    };
+
+    ObstacleGrid(foundation::Allocator &allocator);
+    ~ObstacleGrid(){};
+    DELETE_COPY_AND_MOVE(ObstacleGrid)
+
+    float cell_size;
+    glm::vec2 origin;
+    uint32_t columns;
+    uint32_t rows;
+
+    // Circles added since the last commit.
+    foundation::Array<Circle> circles;
+
+    // The start of each cell's run of circle copies, with one extra element for the end of the last cell.
+    foundation::Array<uint32_t> cell_starts;
+
+    // Circle copies sorted by cell.
+    foundation::Array<float> center_x;
+    foundation::Array<float> center_y;
+    foundation::Array<float> radius;
+};
+
+namespace obstacle_grid {
+
+/**
+ * @brief Adds a circle, which is not queryable until the grid is committed.
+ *
+ * @param grid The grid to add to.
+ * @param center The center of the circle.
+ * @param radius The radius of the circle.
+ */
+void add(ObstacleGrid &grid, glm::vec2 center, float radius);
+
+/**
+ * @brief Sorts every added circle into the cells its bounding box overlaps.
+ *
+ * @param grid The grid to commit.
+ * @param cell_size The side of a cell.
+ */
+void commit(ObstacleGrid &grid, float cell_size);
+
+/**
+ * @brief Calls the callback with every run of circle copies in the cells overlapping a box.
+ *
+ * @param grid The committed grid to query.
+ * @param min The lower left corner of the box.
+ * @param max The upper right corner of the box.
+ * @param callback Called with the [begin, end) range of each run in the center and radius arrays.
+ */
+template <typename F>
+void query(const ObstacleGrid &grid, glm::vec2 min, glm::vec2 max, F callback) {
+    if (grid.columns == 0 || grid.rows == 0) {
+        return;
+    }
+
+    const int32_t x0 = (int32_t)floorf((min.x - grid.origin.x) / grid.cell_size);
+    const int32_t x1 = (int32_t)floorf((max.x - grid.origin.x) / grid.cell_size);
+    const int32_t y0 = (int32_t)floorf((min.y - grid.origin.y) / grid.cell_size);
+    const int32_t y1 = (int32_t)floorf((max.y - grid.origin.y) / grid.cell_size);
+
+    if (x1 < 0 || y1 < 0 || x0 >= (int32_t)grid.columns || y0 >= (int32_t)grid.rows) {
+        return;
+    }
+
+    const uint32_t min_x = x0 < 0 ? 0 : (uint32_t)x0;
+    const uint32_t max_x = x1 >= (int32_t)grid.columns ? grid.columns - 1 : (uint32_t)x1;
+    const uint32_t min_y = y0 < 0 ? 0 : (uint32_t)y0;
+    const uint32_t max_y = y1 >= (int32_t)grid.rows ? grid.rows - 1 : (uint32_t)y1;
+
+    for (uint32_t y = min_y; y <= max_y; ++y) {
+        const uint32_t begin = grid.cell_starts[y * grid.columns + min_x];
+        const uint32_t end = grid.cell_starts[y * grid.columns + max_x + 1];
+        if (begin < end) {
+            callback(begin, end);
+        }
+    }
+}
+
+} // namespace obstacle_grid
+
+} // namespace game
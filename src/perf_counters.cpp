@@ -0,0 +1,163 @@
+#include "perf_counters.h"
+
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// The name of every game::PerfCounter.
+const char *COUNTER_NAMES[(int)game::PerfCounter::Count] = {
+    "cycles",
+    "instructions",
+    "l1d_misses",
+    "llc_misses",
+    "branch_misses",
+};
+
+#if defined(__linux__)
+// The perf event type and config of every game::PerfCounter.
+const struct {
+    uint32_t type;
+    uint64_t config;
+} COUNTER_EVENTS[(int)game::PerfCounter::Count] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+/**
+ * @brief The counters of one thread, as one perf event group led by the cycle counter so they're read together.
+ *
+ */
+struct ThreadCounters {
+    ThreadCounters()
+    : opened(false)
+    , group_size(0) {
+        for (int i = 0; i < (int)game::PerfCounter::Count; ++i) {
+            fds[i] = -1;
+            slots[i] = -1;
+        }
+    }
+
+    ~ThreadCounters() {
+        for (int i = 0; i < (int)game::PerfCounter::Count; ++i) {
+            if (fds[i] >= 0) {
+                close(fds[i]);
+            }
+        }
+    }
+
+    // Whether opening has been tried, it isn't retried after failing.
+    bool opened;
+
+    // The event of every counter, -1 if it couldn't be opened.
+    int fds[(int)game::PerfCounter::Count];
+
+    // Where every counter is in a group read, -1 if it couldn't be opened.
+    int slots[(int)game::PerfCounter::Count];
+
+    // Number of counters in the group.
+    int group_size;
+};
+
+thread_local ThreadCounters thread_counters;
+
+int open_event(uint32_t type, uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // Counts the calling thread on any CPU.
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+} // namespace
+
+namespace game {
+
+namespace perf_counters {
+
+#if defined(__linux__)
+
+bool open() {
+    ThreadCounters &counters = thread_counters;
+    if (counters.opened) {
+        return counters.group_size > 0;
+    }
+
+    counters.opened = true;
+
+    const int leader = (int)PerfCounter::Cycles;
+    counters.fds[leader] = open_event(COUNTER_EVENTS[leader].type, COUNTER_EVENTS[leader].config, -1);
+    if (counters.fds[leader] < 0) {
+        return false;
+    }
+    counters.slots[leader] = counters.group_size++;
+
+    // Not every CPU, or virtual machine, has every counter. The ones missing read as 0.
+    for (int i = 0; i < (int)PerfCounter::Count; ++i) {
+        if (i == leader) {
+            continue;
+        }
+
+        counters.fds[i] = open_event(COUNTER_EVENTS[i].type, COUNTER_EVENTS[i].config, counters.fds[leader]);
+        if (counters.fds[i] >= 0) {
+            counters.slots[i] = counters.group_size++;
+        }
+    }
+
+    return true;
+}
+
+bool read(PerfCounterValues &values) {
+    if (!open()) {
+        return false;
+    }
+
+    const ThreadCounters &counters = thread_counters;
+
+    // With PERF_FORMAT_GROUP a read is the number of counters followed by their values, in the order they joined.
+    uint64_t group[1 + (int)PerfCounter::Count];
+    const ssize_t size = (ssize_t)((1 + counters.group_size) * sizeof(uint64_t));
+    if (::read(counters.fds[(int)PerfCounter::Cycles], group, (size_t)size) != size) {
+        return false;
+    }
+
+    for (int i = 0; i < (int)PerfCounter::Count; ++i) {
+        values.values[i] = counters.slots[i] >= 0 ? group[1 + counters.slots[i]] : 0;
+    }
+
+    return true;
+}
+
+#else
+
+bool open() {
+    return false;
+}
+
+bool read(PerfCounterValues &values) {
+    (void)values;
+    return false;
+}
+
+#endif
+
+const char *counter_name(PerfCounter counter) {
+    return COUNTER_NAMES[(int)counter];
+}
+
+} // namespace perf_counters
+
+} // namespace game
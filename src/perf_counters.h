@@ -0,0 +1,66 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief The hardware counters read for profiled phases.
+ *
+ */
+enum class PerfCounter {
+    Cycles,
+    Instructions,
+
+    // Level 1 data cache read misses.
+    L1DMisses,
+
+    // Last level cache misses.
+    LLCMisses,
+
+    BranchMisses,
+
+    Count,
+};
+
+/**
+ * @brief A reading of every PerfCounter, counters that couldn't be opened read as 0.
+ *
+ */
+struct PerfCounterValues {
+    uint64_t values[(int)PerfCounter::Count];
+};
+
+namespace perf_counters {
+
+/**
+ * @brief Opens the counters for the calling thread, if they aren't already.
+ *
+ * Uses perf_event_open on Linux, and needs a perf_event_paranoid setting that allows counting user space. Every
+ * other platform has no counters.
+ *
+ * @return bool Whether the calling thread has counters.
+ */
+bool open();
+
+/**
+ * @brief Reads the counters of the calling thread, opening them the first time.
+ *
+ * @param values The counters, as counted by the calling thread since they were opened.
+ * @return bool Whether the calling thread has counters, values is only set if it does.
+ */
+bool read(PerfCounterValues &values);
+
+/**
+ * @brief The name of a counter, in lowercase.
+ *
+ * @param counter The counter.
+ * @return const char* The name.
+ */
+const char *counter_name(PerfCounter counter);
+
+} // namespace perf_counters
+
+} // namespace game
@@ -0,0 +1,420 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <float.h>
+#include <engine/log.h>
+#include <imgui.h>
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+
+namespace {
+// The name of every game::ProfilePhase.
+const char *PHASE_NAMES[(int)game::ProfilePhase::Count] = {
+    "update",
+    "separation",
+    "avoidance",
+    "integration",
+    "transforms",
+    "sprites",
+    "render",
+    "script",
+    "gc",
+};
+
+// Events per thousand instructions, 0 without instructions.
+double per_kilo_instruction(const uint64_t *counters, game::PerfCounter counter) {
+    const uint64_t instructions = counters[(int)game::PerfCounter::Instructions];
+    return instructions ? 1000.0 * (double)counters[(int)counter] / (double)instructions : 0.0;
+}
+
+// Instructions per cycle, 0 without cycles.
+double instructions_per_cycle(const uint64_t *counters) {
+    const uint64_t cycles = counters[(int)game::PerfCounter::Cycles];
+    return cycles ? (double)counters[(int)game::PerfCounter::Instructions] / (double)cycles : 0.0;
+}
+
+// Adds one count of allocations to another.
+void accumulate(game::AllocationCounts &to, const game::AllocationCounts &counts) {
+    to.allocations += counts.allocations;
+    to.frees += counts.frees;
+    to.bytes += counts.bytes;
+}
+
+// The histogram bucket of a garbage collection pause.
+uint32_t gc_pause_bucket(uint64_t ns) {
+    uint32_t bucket = 0;
+    uint64_t limit = game::PROFILER_GC_PAUSE_FIRST_NS;
+    while (ns > limit && bucket < game::PROFILER_GC_PAUSE_BUCKETS - 1) {
+        limit *= 2;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Logs allocations per frame over a number of frames.
+void log_allocations_per_frame(const char *name, const game::AllocationCounts &counts, uint64_t frames) {
+    log_info("%s: %.2f allocations, %.2f frees, %.1f bytes per frame", name, (double)counts.allocations / (double)frames,
+             (double)counts.frees / (double)frames, (double)counts.bytes / (double)frames);
+}
+} // namespace
+
+namespace game {
+
+Profiler::Profiler()
+: enabled(false)
+, history_start(0)
+, history_count(0)
+, frames(0)
+, total_frames(0)
+, counters_enabled(false)
+, allocator(nullptr)
+, gc_counted(false)
+, frame_gc_allocated_bytes(0)
+, frame_gc_collected_bytes(0)
+, last_frame_gc_allocated_bytes(0)
+, last_frame_gc_collected_bytes(0)
+, total_gc_allocated_bytes(0)
+, total_gc_collected_bytes(0)
+, gc_heap_bytes(0) {
+    for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+        frame_ns[i].store(0, std::memory_order_relaxed);
+        last_frame_ns[i] = 0;
+
+        for (int j = 0; j < (int)PerfCounter::Count; ++j) {
+            frame_counters[i][j].store(0, std::memory_order_relaxed);
+        }
+
+        frame_allocations[i].store(0, std::memory_order_relaxed);
+        frame_frees[i].store(0, std::memory_order_relaxed);
+        frame_allocated_bytes[i].store(0, std::memory_order_relaxed);
+    }
+    memset(history_ms, 0, sizeof(history_ms));
+    memset(last_frame_counters, 0, sizeof(last_frame_counters));
+    memset(total_counters, 0, sizeof(total_counters));
+    memset(last_frame_allocations, 0, sizeof(last_frame_allocations));
+    memset(total_allocations, 0, sizeof(total_allocations));
+    memset(&frame_start_allocations, 0, sizeof(frame_start_allocations));
+    memset(&last_frame_total_allocations, 0, sizeof(last_frame_total_allocations));
+    memset(&total_frame_allocations, 0, sizeof(total_frame_allocations));
+    memset(gc_pauses, 0, sizeof(gc_pauses));
+}
+
+ProfileScope::ProfileScope(Profiler &profiler, ProfilePhase phase)
+: profiler(profiler)
+, phase(phase)
+, start_ns(0)
+, counting(false)
+, start_allocations() {
+    if (profiler.enabled) {
+        if (profiler.allocator) {
+            start_allocations = counting_allocator::thread_totals();
+        }
+        counting = profiler.counters_enabled && perf_counters::read(start_counters);
+        start_ns = profiler::now_ns();
+    }
+}
+
+ProfileScope::~ProfileScope() {
+    if (profiler.enabled) {
+        profiler::add(profiler, phase, profiler::now_ns() - start_ns);
+
+        PerfCounterValues end_counters;
+        if (counting && perf_counters::read(end_counters)) {
+            for (int i = 0; i < (int)PerfCounter::Count; ++i) {
+                end_counters.values[i] -= start_counters.values[i];
+            }
+            profiler::add_counters(profiler, phase, end_counters);
+        }
+
+        if (profiler.allocator) {
+            profiler::add_allocations(profiler, phase, counting_allocator::difference(start_allocations, counting_allocator::thread_totals()));
+        }
+    }
+}
+
+namespace profiler {
+
+uint64_t now_ns() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void add(Profiler &profiler, ProfilePhase phase, uint64_t ns) {
+    profiler.frame_ns[(int)phase].fetch_add(ns, std::memory_order_relaxed);
+}
+
+void add_counters(Profiler &profiler, ProfilePhase phase, const PerfCounterValues &counters) {
+    for (int i = 0; i < (int)PerfCounter::Count; ++i) {
+        profiler.frame_counters[(int)phase][i].fetch_add(counters.values[i], std::memory_order_relaxed);
+    }
+}
+
+void add_allocations(Profiler &profiler, ProfilePhase phase, const AllocationCounts &allocations) {
+    if (allocations.allocations) {
+        profiler.frame_allocations[(int)phase].fetch_add(allocations.allocations, std::memory_order_relaxed);
+        profiler.frame_allocated_bytes[(int)phase].fetch_add(allocations.bytes, std::memory_order_relaxed);
+    }
+    if (allocations.frees) {
+        profiler.frame_frees[(int)phase].fetch_add(allocations.frees, std::memory_order_relaxed);
+    }
+}
+
+void add_gc(Profiler &profiler, uint64_t before_bytes, uint64_t after_bytes, uint64_t ns) {
+    profiler.gc_counted = true;
+    profiler.gc_heap_bytes = after_bytes;
+
+    if (after_bytes >= before_bytes) {
+        profiler.frame_gc_allocated_bytes += after_bytes - before_bytes;
+    } else {
+        profiler.frame_gc_collected_bytes += before_bytes - after_bytes;
+        ++profiler.gc_pauses[gc_pause_bucket(ns)];
+    }
+}
+
+void count_allocations(Profiler &profiler, CountingAllocator &allocator) {
+    profiler.allocator = &allocator;
+    profiler.frame_start_allocations = counting_allocator::totals(allocator);
+}
+
+bool enable_counters(Profiler &profiler) {
+    profiler.counters_enabled = perf_counters::open();
+    if (!profiler.counters_enabled) {
+        log_info("Hardware counters are unavailable, profiling without them");
+    }
+
+    return profiler.counters_enabled;
+}
+
+void end_frame(Profiler &profiler) {
+    if (!profiler.enabled) {
+        return;
+    }
+
+    const uint32_t index = (profiler.history_start + profiler.history_count) % PROFILER_HISTORY;
+
+    for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+        const uint64_t ns = profiler.frame_ns[i].exchange(0, std::memory_order_relaxed);
+        profiler.last_frame_ns[i] = ns;
+        profiler.history_ms[i][index] = (float)((double)ns / 1000000.0);
+
+        for (int j = 0; j < (int)PerfCounter::Count; ++j) {
+            const uint64_t count = profiler.frame_counters[i][j].exchange(0, std::memory_order_relaxed);
+            profiler.last_frame_counters[i][j] = count;
+            profiler.total_counters[i][j] += count;
+        }
+
+        AllocationCounts &allocations = profiler.last_frame_allocations[i];
+        allocations.allocations = profiler.frame_allocations[i].exchange(0, std::memory_order_relaxed);
+        allocations.frees = profiler.frame_frees[i].exchange(0, std::memory_order_relaxed);
+        allocations.bytes = profiler.frame_allocated_bytes[i].exchange(0, std::memory_order_relaxed);
+        accumulate(profiler.total_allocations[i], allocations);
+    }
+
+    if (profiler.allocator) {
+        const AllocationCounts totals = counting_allocator::totals(*profiler.allocator);
+        profiler.last_frame_total_allocations = counting_allocator::difference(profiler.frame_start_allocations, totals);
+        profiler.frame_start_allocations = totals;
+        accumulate(profiler.total_frame_allocations, profiler.last_frame_total_allocations);
+    }
+
+    profiler.last_frame_gc_allocated_bytes = profiler.frame_gc_allocated_bytes;
+    profiler.last_frame_gc_collected_bytes = profiler.frame_gc_collected_bytes;
+    profiler.total_gc_allocated_bytes += profiler.frame_gc_allocated_bytes;
+    profiler.total_gc_collected_bytes += profiler.frame_gc_collected_bytes;
+    profiler.frame_gc_allocated_bytes = 0;
+    profiler.frame_gc_collected_bytes = 0;
+
+    if (profiler.history_count < PROFILER_HISTORY) {
+        ++profiler.history_count;
+    } else {
+        profiler.history_start = (profiler.history_start + 1) % PROFILER_HISTORY;
+    }
+
+    ++profiler.frames;
+    ++profiler.total_frames;
+}
+
+void reset_totals(Profiler &profiler) {
+    memset(profiler.total_counters, 0, sizeof(profiler.total_counters));
+    memset(profiler.total_allocations, 0, sizeof(profiler.total_allocations));
+    memset(&profiler.total_frame_allocations, 0, sizeof(profiler.total_frame_allocations));
+    memset(profiler.gc_pauses, 0, sizeof(profiler.gc_pauses));
+    profiler.total_gc_allocated_bytes = 0;
+    profiler.total_gc_collected_bytes = 0;
+    profiler.total_frames = 0;
+}
+
+const char *phase_name(ProfilePhase phase) {
+    return PHASE_NAMES[(int)phase];
+}
+
+void render_imgui(const Profiler &profiler) {
+    if (!profiler.enabled) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(8, 200), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing)) {
+        const uint32_t count = profiler.history_count;
+        ImGui::Text("Last %u frames, in ms", count);
+        if (profiler.allocator) {
+            const AllocationCounts &allocations = profiler.last_frame_total_allocations;
+            ImGui::Text("Last frame: %" PRIu64 " allocations, %" PRIu64 " frees, %" PRIu64 " bytes", allocations.allocations,
+                        allocations.frees, allocations.bytes);
+        }
+        if (profiler.gc_counted) {
+            ImGui::Text("Script heap: %.1f KB, last frame %.1f KB garbage, %.1f KB collected", (double)profiler.gc_heap_bytes / 1024.0,
+                        (double)profiler.last_frame_gc_allocated_bytes / 1024.0, (double)profiler.last_frame_gc_collected_bytes / 1024.0);
+
+            float pauses[PROFILER_GC_PAUSE_BUCKETS];
+            for (uint32_t i = 0; i < PROFILER_GC_PAUSE_BUCKETS; ++i) {
+                pauses[i] = (float)profiler.gc_pauses[i];
+            }
+            ImGui::Text("GC pauses, from %.3f ms doubling", (double)PROFILER_GC_PAUSE_FIRST_NS / 1000000.0);
+            ImGui::PlotHistogram("##gc_pauses", pauses, (int)PROFILER_GC_PAUSE_BUCKETS, 0, nullptr, 0.0f, FLT_MAX, ImVec2(320, 32));
+        }
+
+        for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+            float sorted[PROFILER_HISTORY];
+            double sum = 0.0;
+            for (uint32_t j = 0; j < count; ++j) {
+                sorted[j] = profiler.history_ms[i][(profiler.history_start + j) % PROFILER_HISTORY];
+                sum += sorted[j];
+            }
+            std::sort(sorted, sorted + count);
+
+            const float average = count ? (float)(sum / count) : 0.0f;
+            const float p99 = count ? sorted[(uint32_t)ceilf(0.99f * count) - 1] : 0.0f;
+            const float max = count ? sorted[count - 1] : 0.0f;
+
+            ImGui::Separator();
+            ImGui::Text("%-12s avg %7.3f  p99 %7.3f  max %7.3f", PHASE_NAMES[i], average, p99, max);
+            if (profiler.counters_enabled) {
+                const uint64_t *counters = profiler.last_frame_counters[i];
+                ImGui::Text("IPC %.2f  per 1k instructions: L1D %.1f  LLC %.1f  branch %.1f", instructions_per_cycle(counters),
+                            per_kilo_instruction(counters, PerfCounter::L1DMisses), per_kilo_instruction(counters, PerfCounter::LLCMisses),
+                            per_kilo_instruction(counters, PerfCounter::BranchMisses));
+            }
+            if (profiler.allocator) {
+                const AllocationCounts &allocations = profiler.last_frame_allocations[i];
+                ImGui::Text("%" PRIu64 " allocations  %" PRIu64 " frees  %" PRIu64 " bytes", allocations.allocations, allocations.frees,
+                            allocations.bytes);
+            }
+            ImGui::PushID(i);
+            ImGui::PlotHistogram("", profiler.history_ms[i], (int)count, (int)profiler.history_start, nullptr, 0.0f, max, ImVec2(320, 32));
+            ImGui::PopID();
+        }
+    }
+    ImGui::End();
+}
+
+void log_counters(const Profiler &profiler) {
+    if (!profiler.counters_enabled) {
+        return;
+    }
+
+    for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+        const uint64_t *counters = profiler.total_counters[i];
+        if (counters[(int)PerfCounter::Cycles] == 0) {
+            continue;
+        }
+
+        log_info("%s: IPC %.2f, per 1k instructions L1D misses %.2f, LLC misses %.2f, branch misses %.2f", PHASE_NAMES[i],
+                 instructions_per_cycle(counters), per_kilo_instruction(counters, PerfCounter::L1DMisses),
+                 per_kilo_instruction(counters, PerfCounter::LLCMisses), per_kilo_instruction(counters, PerfCounter::BranchMisses));
+    }
+}
+
+void log_allocations(const Profiler &profiler) {
+    if (!profiler.enabled || !profiler.allocator || profiler.total_frames == 0) {
+        return;
+    }
+
+    log_allocations_per_frame("frame", profiler.total_frame_allocations, profiler.total_frames);
+
+    for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+        const AllocationCounts &allocations = profiler.total_allocations[i];
+        if (allocations.allocations == 0 && allocations.frees == 0) {
+            continue;
+        }
+
+        log_allocations_per_frame(PHASE_NAMES[i], allocations, profiler.total_frames);
+    }
+}
+
+void log_gc(const Profiler &profiler) {
+    if (!profiler.enabled || !profiler.gc_counted || profiler.total_frames == 0) {
+        return;
+    }
+
+    const double frames = (double)profiler.total_frames;
+    log_info("Script heap: %.1f KB, %.1f bytes of garbage and %.1f bytes collected per frame", (double)profiler.gc_heap_bytes / 1024.0,
+             (double)profiler.total_gc_allocated_bytes / frames, (double)profiler.total_gc_collected_bytes / frames);
+
+    uint64_t limit = PROFILER_GC_PAUSE_FIRST_NS;
+    for (uint32_t i = 0; i < PROFILER_GC_PAUSE_BUCKETS; ++i) {
+        if (i < PROFILER_GC_PAUSE_BUCKETS - 1) {
+            log_info("GC pauses up to %8.3f ms: %" PRIu64, (double)limit / 1000000.0, profiler.gc_pauses[i]);
+        } else {
+            log_info("GC pauses over  %8.3f ms: %" PRIu64, (double)(limit / 2) / 1000000.0, profiler.gc_pauses[i]);
+        }
+        limit *= 2;
+    }
+}
+
+void write_csv_header(const Profiler &profiler, FILE *file) {
+    fprintf(file, "frame");
+    for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+        fprintf(file, ",%s_ns", PHASE_NAMES[i]);
+    }
+    if (profiler.counters_enabled) {
+        for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+            for (int j = 0; j < (int)PerfCounter::Count; ++j) {
+                fprintf(file, ",%s_%s", PHASE_NAMES[i], perf_counters::counter_name((PerfCounter)j));
+            }
+        }
+    }
+    if (profiler.allocator) {
+        fprintf(file, ",frame_allocations,frame_frees,frame_bytes");
+        for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+            fprintf(file, ",%s_allocations,%s_frees,%s_bytes", PHASE_NAMES[i], PHASE_NAMES[i], PHASE_NAMES[i]);
+        }
+    }
+    if (profiler.gc_counted) {
+        fprintf(file, ",gc_heap_bytes,gc_allocated_bytes,gc_collected_bytes");
+    }
+    fprintf(file, "\n");
+}
+
+void write_csv_row(const Profiler &profiler, FILE *file) {
+    fprintf(file, "%" PRIu64, profiler.frames);
+    for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+        fprintf(file, ",%" PRIu64, profiler.last_frame_ns[i]);
+    }
+    if (profiler.counters_enabled) {
+        for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+            for (int j = 0; j < (int)PerfCounter::Count; ++j) {
+                fprintf(file, ",%" PRIu64, profiler.last_frame_counters[i][j]);
+            }
+        }
+    }
+    if (profiler.allocator) {
+        const AllocationCounts &frame = profiler.last_frame_total_allocations;
+        fprintf(file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, frame.allocations, frame.frees, frame.bytes);
+        for (int i = 0; i < (int)ProfilePhase::Count; ++i) {
+            const AllocationCounts &allocations = profiler.last_frame_allocations[i];
+            fprintf(file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, allocations.allocations, allocations.frees, allocations.bytes);
+        }
+    }
+    if (profiler.gc_counted) {
+        fprintf(file, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64, profiler.gc_heap_bytes, profiler.last_frame_gc_allocated_bytes,
+                profiler.last_frame_gc_collected_bytes);
+    }
+    fprintf(file, "\n");
+}
+
+} // namespace profiler
+
+} // namespace game
@@ -0,0 +1,310 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "counting_allocator.h"
+#include "perf_counters.h"
+#include "util.h"
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief The parts of a frame that are timed.
+ *
+ */
+enum class ProfilePhase {
+    // The whole gameplay update, including the phases below that run inside it.
+    Update,
+
+    // Separation forces between giraffes.
+    Separation,
+
+    // Avoidance rays against obstacles.
+    Avoidance,
+
+    // Truncating steering and integrating velocities and positions.
+    Integration,
+
+    // Building and applying sprite transforms.
+    Transforms,
+
+    // engine::update_sprites and engine::commit_sprites.
+    Sprites,
+
+    // The gameplay render, which draws the sprites.
+    Render,
+
+    // Calls from the engine callbacks into a script VM.
+    Script,
+
+    // Garbage collection steps a script VM is told to run, rather than runs by itself.
+    Gc,
+
+    Count,
+};
+
+// Number of frames kept for the rolling statistics.
+const uint32_t PROFILER_HISTORY = 240;
+
+// Number of buckets in the histogram of garbage collection pauses.
+const uint32_t PROFILER_GC_PAUSE_BUCKETS = 8;
+
+// Longest pause in the first bucket, every next bucket holds pauses up to twice as long, and the last holds the rest.
+const uint64_t PROFILER_GC_PAUSE_FIRST_NS = 62500;
+
+/**
+ * @brief Time spent in each ProfilePhase, summed per frame and kept for the last PROFILER_HISTORY frames.
+ *
+ * Phases can be timed from any thread. Phases timed on several threads at once add up their time on every thread,
+ * so they can add up to more than the wall clock time of the frame. The same goes for the hardware counters, which
+ * are read around every scope when counters_enabled is set, at the cost of a system call on each side, by every thread
+ * that has opened its own with perf_counters::open.
+ *
+ * When allocator is set, every scope also counts what the calling thread allocated through a CountingAllocator, and
+ * every frame counts what was allocated through allocator on any thread.
+ *
+ * Script VMs with a garbage collector report the size of their heap around every call into them with add_gc. The
+ * heap growing is counted as garbage made, and the heap shrinking as collected, with the call counted as a pause.
+ * Since only the net change of a call is seen, a call that both makes and collects garbage counts the difference.
+ */
+struct Profiler {
+    Profiler();
+    ~Profiler(){};
+    DELETE_COPY_AND_MOVE(Profiler)
+
+    // Whether ProfileScope times anything.
+    bool enabled;
+
+    // Time spent in each phase so far in this frame.
+    std::atomic<uint64_t> frame_ns[(int)ProfilePhase::Count];
+
+    // Time spent in each phase in the last finished frame.
+    uint64_t last_frame_ns[(int)ProfilePhase::Count];
+
+    // Milliseconds spent in each phase in the last frames, as a ring buffer starting at history_start.
+    float history_ms[(int)ProfilePhase::Count][PROFILER_HISTORY];
+    uint32_t history_start;
+    uint32_t history_count;
+
+    // Number of frames finished.
+    uint64_t frames;
+
+    // Number of frames finished since the totals were last reset.
+    uint64_t total_frames;
+
+    // Whether ProfileScope reads the hardware counters, only set by enable_counters if they could be opened.
+    bool counters_enabled;
+
+    // Counted events in each phase so far in this frame.
+    std::atomic<uint64_t> frame_counters[(int)ProfilePhase::Count][(int)PerfCounter::Count];
+
+    // Counted events in each phase in the last finished frame.
+    uint64_t last_frame_counters[(int)ProfilePhase::Count][(int)PerfCounter::Count];
+
+    // Counted events in each phase in every finished frame.
+    uint64_t total_counters[(int)ProfilePhase::Count][(int)PerfCounter::Count];
+
+    // The allocator whose allocations are counted per frame, which the Lua slabs count their blocks for too, nullptr
+    // when not counting allocations.
+    CountingAllocator *allocator;
+
+    // Allocations, frees, and allocated bytes in each phase so far in this frame.
+    std::atomic<uint64_t> frame_allocations[(int)ProfilePhase::Count];
+    std::atomic<uint64_t> frame_frees[(int)ProfilePhase::Count];
+    std::atomic<uint64_t> frame_allocated_bytes[(int)ProfilePhase::Count];
+
+    // Allocations in each phase in the last finished frame.
+    AllocationCounts last_frame_allocations[(int)ProfilePhase::Count];
+
+    // Allocations in each phase in every finished frame.
+    AllocationCounts total_allocations[(int)ProfilePhase::Count];
+
+    // The totals of allocator when the current frame started.
+    AllocationCounts frame_start_allocations;
+
+    // Allocations in the whole last finished frame, inside a phase or not.
+    AllocationCounts last_frame_total_allocations;
+
+    // Allocations in every finished frame, inside a phase or not.
+    AllocationCounts total_frame_allocations;
+
+    // Whether a script VM reports its heap. The garbage collection statistics are only touched by the main thread.
+    bool gc_counted;
+
+    // Bytes the script heap grew and shrank by so far in this frame.
+    uint64_t frame_gc_allocated_bytes;
+    uint64_t frame_gc_collected_bytes;
+
+    // Bytes the script heap grew and shrank by in the last finished frame.
+    uint64_t last_frame_gc_allocated_bytes;
+    uint64_t last_frame_gc_collected_bytes;
+
+    // Bytes the script heap grew and shrank by in every finished frame.
+    uint64_t total_gc_allocated_bytes;
+    uint64_t total_gc_collected_bytes;
+
+    // Size of the script heap when it was last reported.
+    uint64_t gc_heap_bytes;
+
+    // Number of calls the script heap shrank in, by how long they took, since the totals were last reset.
+    uint64_t gc_pauses[PROFILER_GC_PAUSE_BUCKETS];
+};
+
+/**
+ * @brief Adds the time from its construction to its destruction to a phase of the current frame.
+ *
+ */
+struct ProfileScope {
+    ProfileScope(Profiler &profiler, ProfilePhase phase);
+    ~ProfileScope();
+    DELETE_COPY_AND_MOVE(ProfileScope)
+
+    Profiler &profiler;
+    ProfilePhase phase;
+    uint64_t start_ns;
+
+    // Whether start_counters was read, so the counters are only added if both ends were.
+    bool counting;
+    PerfCounterValues start_counters;
+
+    // What the thread had allocated when the scope started, only read when the profiler counts allocations.
+    AllocationCounts start_allocations;
+};
+
+namespace profiler {
+
+/**
+ * @brief The current time, for timing phases.
+ *
+ * @return uint64_t Nanoseconds from an arbitrary start.
+ */
+uint64_t now_ns();
+
+/**
+ * @brief Adds time to a phase of the current frame.
+ *
+ * @param profiler The profiler.
+ * @param phase The phase.
+ * @param ns The time to add, in nanoseconds.
+ */
+void add(Profiler &profiler, ProfilePhase phase, uint64_t ns);
+
+/**
+ * @brief Adds counted events to a phase of the current frame.
+ *
+ * @param profiler The profiler.
+ * @param phase The phase.
+ * @param counters The events to add.
+ */
+void add_counters(Profiler &profiler, ProfilePhase phase, const PerfCounterValues &counters);
+
+/**
+ * @brief Adds allocations to a phase of the current frame.
+ *
+ * @param profiler The profiler.
+ * @param phase The phase.
+ * @param allocations The allocations to add.
+ */
+void add_allocations(Profiler &profiler, ProfilePhase phase, const AllocationCounts &allocations);
+
+/**
+ * @brief Adds the change of a script heap over a call into the script VM to the current frame.
+ *
+ * @param profiler The profiler.
+ * @param before_bytes Size of the heap before the call.
+ * @param after_bytes Size of the heap after the call.
+ * @param ns How long the call took, counted as a pause if the heap shrank.
+ */
+void add_gc(Profiler &profiler, uint64_t before_bytes, uint64_t after_bytes, uint64_t ns);
+
+/**
+ * @brief Starts counting the allocations made through an allocator in every frame and phase.
+ *
+ * @param profiler The profiler.
+ * @param allocator The allocator to count, which outlives the profiler.
+ */
+void count_allocations(Profiler &profiler, CountingAllocator &allocator);
+
+/**
+ * @brief Starts reading the hardware counters around every scope, if the calling thread can open them.
+ *
+ * @param profiler The profiler.
+ * @return bool Whether the counters are enabled.
+ */
+bool enable_counters(Profiler &profiler);
+
+/**
+ * @brief Moves the times of the current frame into the history, and starts a new frame.
+ *
+ * @param profiler The profiler.
+ */
+void end_frame(Profiler &profiler);
+
+/**
+ * @brief Clears the totals of the counted events, allocations, and garbage collection, so they only cover the frames
+ * that follow.
+ *
+ * @param profiler The profiler.
+ */
+void reset_totals(Profiler &profiler);
+
+/**
+ * @brief The name of a phase, in lowercase.
+ *
+ * @param phase The phase.
+ * @return const char* The name.
+ */
+const char *phase_name(ProfilePhase phase);
+
+/**
+ * @brief Shows the history of every phase in an ImGui window, with its average, p99, and max.
+ *
+ * @param profiler The profiler.
+ */
+void render_imgui(const Profiler &profiler);
+
+/**
+ * @brief Logs the instructions per cycle and the misses per thousand instructions of every counted phase.
+ *
+ * @param profiler The profiler.
+ */
+void log_counters(const Profiler &profiler);
+
+/**
+ * @brief Logs the allocations, frees, and allocated bytes per frame of the whole frame and every phase that allocated.
+ *
+ * @param profiler The profiler.
+ */
+void log_allocations(const Profiler &profiler);
+
+/**
+ * @brief Logs the garbage made and collected per frame by a script VM, and the histogram of its pauses.
+ *
+ * @param profiler The profiler.
+ */
+void log_gc(const Profiler &profiler);
+
+/**
+ * @brief Writes the CSV header for write_csv_row.
+ *
+ * @param profiler The profiler.
+ * @param file The file to write to.
+ */
+void write_csv_header(const Profiler &profiler, FILE *file);
+
+/**
+ * @brief Writes the number of the last finished frame and the nanoseconds of every phase in it as a CSV row, followed
+ * by the counted events of every phase if the counters are enabled, the allocations of the frame and every phase if
+ * allocations are counted, and the script heap if a script VM reports it.
+ *
+ * @param profiler The profiler.
+ * @param file The file to write to.
+ */
+void write_csv_row(const Profiler &profiler, FILE *file);
+
+} // namespace profiler
+
+} // namespace game
@@ -0,0 +1,645 @@
+#include "simd.h"
+#include "util.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+// MSVC emits any intrinsic without a target, GCC and Clang need the functions using them marked.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET(x)
+#else
+#define SIMD_TARGET(x) __attribute__((target(x)))
+#endif
+
+namespace {
+using namespace simd;
+
+void separation_scalar(float x, float y, float near_distance, const float *others_x, const float *others_y, uint32_t count, float *force_x, float *force_y) {
+    const float near_distance_squared = near_distance * near_distance;
+    float sum_x = 0.0f;
+    float sum_y = 0.0f;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const float offset_x = others_x[i] - x;
+        const float offset_y = others_y[i] - y;
+        const float distance_squared = offset_x * offset_x + offset_y * offset_y;
+        if (distance_squared <= near_distance_squared) {
+            const float scale = near_distance / sqrtf(distance_squared);
+            sum_x += offset_x * scale;
+            sum_y += offset_y * scale;
+        }
+    }
+
+    *force_x -= sum_x;
+    *force_y -= sum_y;
+}
+
+void truncate_scalar(float *x, float *y, uint32_t count, float max_length) {
+    for (uint32_t i = 0; i < count; ++i) {
+        const glm::vec2 v = truncate({x[i], y[i]}, max_length);
+        x[i] = v.x;
+        y[i] = v.y;
+    }
+}
+
+void integrate_scalar(float *position_x, float *position_y, float *velocity_x, float *velocity_y, const float *steering_x, const float *steering_y, const float *drag, uint32_t count, float mass, float max_force, float max_speed, float dt) {
+    for (uint32_t i = 0; i < count; ++i) {
+        const glm::vec2 velocity = {velocity_x[i], velocity_y[i]};
+        const glm::vec2 drag_force = -drag[i] * velocity;
+        const glm::vec2 steering_force = truncate({steering_x[i], steering_y[i]}, max_force) + drag_force;
+        const glm::vec2 acceleration = steering_force / mass;
+        const glm::vec2 new_velocity = truncate(velocity + acceleration, max_speed);
+
+        velocity_x[i] = new_velocity.x;
+        velocity_y[i] = new_velocity.y;
+        position_x[i] += new_velocity.x * dt;
+        position_y[i] += new_velocity.y * dt;
+    }
+}
+
+bool ray_circles_scalar(float origin_x, float origin_y, float direction_x, float direction_y, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance) {
+    return ray_circles_intersection({origin_x, origin_y}, {direction_x, direction_y}, center_x, center_y, radius, count, max_distance, *distance);
+}
+
+// Lowers nearest to the hit of the circles left over after the vector loop, and stores it if there was any hit.
+bool ray_circles_tail(float origin_x, float origin_y, const glm::vec2 direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float nearest, float *distance) {
+    float tail_distance;
+    if (ray_circles_intersection({origin_x, origin_y}, direction, center_x, center_y, radius, count, max_distance, tail_distance) && tail_distance < nearest) {
+        nearest = tail_distance;
+    }
+
+    if (nearest == FLT_MAX) {
+        return false;
+    }
+
+    *distance = nearest;
+    return true;
+}
+
+#if SIMD_X86
+
+SIMD_TARGET("sse4.1")
+inline float horizontal_sum_sse41(__m128 v) {
+    __m128 shuffled = _mm_movehdup_ps(v);
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+// Scales vectors longer than max_length down to it, vectors of length 0 are left alone since 0 > max_length is false.
+SIMD_TARGET("sse4.1")
+inline void truncate_sse41(__m128 &x, __m128 &y, __m128 max_length) {
+    const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+    const __m128 scale = _mm_blendv_ps(_mm_set1_ps(1.0f), _mm_div_ps(max_length, length), _mm_cmpgt_ps(length, max_length));
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+}
+
+SIMD_TARGET("sse4.1")
+void separation_sse41(float x, float y, float near_distance, const float *others_x, const float *others_y, uint32_t count, float *force_x, float *force_y) {
+    const __m128 px = _mm_set1_ps(x);
+    const __m128 py = _mm_set1_ps(y);
+    const __m128 near = _mm_set1_ps(near_distance);
+    const __m128 near_squared = _mm_set1_ps(near_distance * near_distance);
+
+    __m128 sum_x = _mm_setzero_ps();
+    __m128 sum_y = _mm_setzero_ps();
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 offset_x = _mm_sub_ps(_mm_loadu_ps(others_x + i), px);
+        const __m128 offset_y = _mm_sub_ps(_mm_loadu_ps(others_y + i), py);
+        const __m128 distance_squared = _mm_add_ps(_mm_mul_ps(offset_x, offset_x), _mm_mul_ps(offset_y, offset_y));
+
+        const __m128 mask = _mm_cmple_ps(distance_squared, near_squared);
+        const __m128 scale = _mm_div_ps(near, _mm_sqrt_ps(distance_squared));
+        sum_x = _mm_add_ps(sum_x, _mm_and_ps(mask, _mm_mul_ps(offset_x, scale)));
+        sum_y = _mm_add_ps(sum_y, _mm_and_ps(mask, _mm_mul_ps(offset_y, scale)));
+    }
+
+    *force_x -= horizontal_sum_sse41(sum_x);
+    *force_y -= horizontal_sum_sse41(sum_y);
+
+    separation_scalar(x, y, near_distance, others_x + i, others_y + i, count - i, force_x, force_y);
+}
+
+SIMD_TARGET("sse4.1")
+void truncate_sse41(float *x, float *y, uint32_t count, float max_length) {
+    const __m128 max = _mm_set1_ps(max_length);
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        truncate_sse41(vx, vy, max);
+        _mm_storeu_ps(x + i, vx);
+        _mm_storeu_ps(y + i, vy);
+    }
+
+    truncate_scalar(x + i, y + i, count - i, max_length);
+}
+
+SIMD_TARGET("sse4.1")
+void integrate_sse41(float *position_x, float *position_y, float *velocity_x, float *velocity_y, const float *steering_x, const float *steering_y, const float *drag, uint32_t count, float mass, float max_force, float max_speed, float dt) {
+    const __m128 inverse_mass = _mm_set1_ps(1.0f / mass);
+    const __m128 max_force_v = _mm_set1_ps(max_force);
+    const __m128 max_speed_v = _mm_set1_ps(max_speed);
+    const __m128 dt_v = _mm_set1_ps(dt);
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(velocity_x + i);
+        __m128 vy = _mm_loadu_ps(velocity_y + i);
+        __m128 sx = _mm_loadu_ps(steering_x + i);
+        __m128 sy = _mm_loadu_ps(steering_y + i);
+        const __m128 d = _mm_loadu_ps(drag + i);
+
+        truncate_sse41(sx, sy, max_force_v);
+        sx = _mm_sub_ps(sx, _mm_mul_ps(d, vx));
+        sy = _mm_sub_ps(sy, _mm_mul_ps(d, vy));
+
+        vx = _mm_add_ps(vx, _mm_mul_ps(sx, inverse_mass));
+        vy = _mm_add_ps(vy, _mm_mul_ps(sy, inverse_mass));
+        truncate_sse41(vx, vy, max_speed_v);
+
+        _mm_storeu_ps(velocity_x + i, vx);
+        _mm_storeu_ps(velocity_y + i, vy);
+        _mm_storeu_ps(position_x + i, _mm_add_ps(_mm_loadu_ps(position_x + i), _mm_mul_ps(vx, dt_v)));
+        _mm_storeu_ps(position_y + i, _mm_add_ps(_mm_loadu_ps(position_y + i), _mm_mul_ps(vy, dt_v)));
+    }
+
+    integrate_scalar(position_x + i, position_y + i, velocity_x + i, velocity_y + i, steering_x + i, steering_y + i, drag + i, count - i, mass, max_force, max_speed, dt);
+}
+
+SIMD_TARGET("sse4.1")
+inline float horizontal_min_sse41(__m128 v) {
+    __m128 shuffled = _mm_movehdup_ps(v);
+    __m128 mins = _mm_min_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, mins);
+    mins = _mm_min_ss(mins, shuffled);
+    return _mm_cvtss_f32(mins);
+}
+
+SIMD_TARGET("sse4.1")
+bool ray_circles_sse41(float origin_x, float origin_y, float direction_x, float direction_y, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance) {
+    const glm::vec2 direction = glm::normalize(glm::vec2(direction_x, direction_y));
+    const __m128 ox = _mm_set1_ps(origin_x);
+    const __m128 oy = _mm_set1_ps(origin_y);
+    const __m128 dx = _mm_set1_ps(direction.x);
+    const __m128 dy = _mm_set1_ps(direction.y);
+    const __m128 max = _mm_set1_ps(max_distance);
+    const __m128 no_hit = _mm_set1_ps(FLT_MAX);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 nearest = no_hit;
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 offset_x = _mm_sub_ps(_mm_loadu_ps(center_x + i), ox);
+        const __m128 offset_y = _mm_sub_ps(_mm_loadu_ps(center_y + i), oy);
+        const __m128 r = _mm_loadu_ps(radius + i);
+        const __m128 radius_squared = _mm_mul_ps(r, r);
+
+        const __m128 t = _mm_add_ps(_mm_mul_ps(offset_x, dx), _mm_mul_ps(offset_y, dy));
+        const __m128 center_squared = _mm_add_ps(_mm_mul_ps(offset_x, offset_x), _mm_mul_ps(offset_y, offset_y));
+        const __m128 perpendicular_squared = _mm_sub_ps(center_squared, _mm_mul_ps(t, t));
+
+        const __m128 inside = _mm_cmple_ps(center_squared, radius_squared);
+        const __m128 hit = _mm_or_ps(inside, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmple_ps(perpendicular_squared, radius_squared)));
+        const __m128 entry = _mm_sub_ps(t, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(radius_squared, perpendicular_squared), zero)));
+        const __m128 hit_distance = _mm_blendv_ps(entry, zero, inside);
+
+        const __m128 mask = _mm_and_ps(hit, _mm_cmple_ps(hit_distance, max));
+        nearest = _mm_min_ps(nearest, _mm_blendv_ps(no_hit, hit_distance, mask));
+    }
+
+    return ray_circles_tail(origin_x, origin_y, direction, center_x + i, center_y + i, radius + i, count - i, max_distance, horizontal_min_sse41(nearest), distance);
+}
+
+SIMD_TARGET("avx2")
+inline float horizontal_sum_avx2(__m256 v) {
+    __m128 sums = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    __m128 shuffled = _mm_movehdup_ps(sums);
+    sums = _mm_add_ps(sums, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+SIMD_TARGET("avx2")
+inline void truncate_avx2(__m256 &x, __m256 &y, __m256 max_length) {
+    const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+    const __m256 scale = _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_div_ps(max_length, length), _mm256_cmp_ps(length, max_length, _CMP_GT_OQ));
+    x = _mm256_mul_ps(x, scale);
+    y = _mm256_mul_ps(y, scale);
+}
+
+SIMD_TARGET("avx2")
+void separation_avx2(float x, float y, float near_distance, const float *others_x, const float *others_y, uint32_t count, float *force_x, float *force_y) {
+    const __m256 px = _mm256_set1_ps(x);
+    const __m256 py = _mm256_set1_ps(y);
+    const __m256 near = _mm256_set1_ps(near_distance);
+    const __m256 near_squared = _mm256_set1_ps(near_distance * near_distance);
+
+    __m256 sum_x = _mm256_setzero_ps();
+    __m256 sum_y = _mm256_setzero_ps();
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 offset_x = _mm256_sub_ps(_mm256_loadu_ps(others_x + i), px);
+        const __m256 offset_y = _mm256_sub_ps(_mm256_loadu_ps(others_y + i), py);
+        const __m256 distance_squared = _mm256_add_ps(_mm256_mul_ps(offset_x, offset_x), _mm256_mul_ps(offset_y, offset_y));
+
+        const __m256 mask = _mm256_cmp_ps(distance_squared, near_squared, _CMP_LE_OQ);
+        const __m256 scale = _mm256_div_ps(near, _mm256_sqrt_ps(distance_squared));
+        sum_x = _mm256_add_ps(sum_x, _mm256_and_ps(mask, _mm256_mul_ps(offset_x, scale)));
+        sum_y = _mm256_add_ps(sum_y, _mm256_and_ps(mask, _mm256_mul_ps(offset_y, scale)));
+    }
+
+    *force_x -= horizontal_sum_avx2(sum_x);
+    *force_y -= horizontal_sum_avx2(sum_y);
+
+    separation_scalar(x, y, near_distance, others_x + i, others_y + i, count - i, force_x, force_y);
+}
+
+SIMD_TARGET("avx2")
+void truncate_avx2(float *x, float *y, uint32_t count, float max_length) {
+    const __m256 max = _mm256_set1_ps(max_length);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        truncate_avx2(vx, vy, max);
+        _mm256_storeu_ps(x + i, vx);
+        _mm256_storeu_ps(y + i, vy);
+    }
+
+    truncate_scalar(x + i, y + i, count - i, max_length);
+}
+
+SIMD_TARGET("avx2")
+void integrate_avx2(float *position_x, float *position_y, float *velocity_x, float *velocity_y, const float *steering_x, const float *steering_y, const float *drag, uint32_t count, float mass, float max_force, float max_speed, float dt) {
+    const __m256 inverse_mass = _mm256_set1_ps(1.0f / mass);
+    const __m256 max_force_v = _mm256_set1_ps(max_force);
+    const __m256 max_speed_v = _mm256_set1_ps(max_speed);
+    const __m256 dt_v = _mm256_set1_ps(dt);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(velocity_x + i);
+        __m256 vy = _mm256_loadu_ps(velocity_y + i);
+        __m256 sx = _mm256_loadu_ps(steering_x + i);
+        __m256 sy = _mm256_loadu_ps(steering_y + i);
+        const __m256 d = _mm256_loadu_ps(drag + i);
+
+        truncate_avx2(sx, sy, max_force_v);
+        sx = _mm256_sub_ps(sx, _mm256_mul_ps(d, vx));
+        sy = _mm256_sub_ps(sy, _mm256_mul_ps(d, vy));
+
+        vx = _mm256_add_ps(vx, _mm256_mul_ps(sx, inverse_mass));
+        vy = _mm256_add_ps(vy, _mm256_mul_ps(sy, inverse_mass));
+        truncate_avx2(vx, vy, max_speed_v);
+
+        _mm256_storeu_ps(velocity_x + i, vx);
+        _mm256_storeu_ps(velocity_y + i, vy);
+        _mm256_storeu_ps(position_x + i, _mm256_add_ps(_mm256_loadu_ps(position_x + i), _mm256_mul_ps(vx, dt_v)));
+        _mm256_storeu_ps(position_y + i, _mm256_add_ps(_mm256_loadu_ps(position_y + i), _mm256_mul_ps(vy, dt_v)));
+    }
+
+    integrate_scalar(position_x + i, position_y + i, velocity_x + i, velocity_y + i, steering_x + i, steering_y + i, drag + i, count - i, mass, max_force, max_speed, dt);
+}
+
+SIMD_TARGET("avx2")
+inline float horizontal_min_avx2(__m256 v) {
+    __m128 mins = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    __m128 shuffled = _mm_movehdup_ps(mins);
+    mins = _mm_min_ps(mins, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, mins);
+    mins = _mm_min_ss(mins, shuffled);
+    return _mm_cvtss_f32(mins);
+}
+
+SIMD_TARGET("avx2")
+bool ray_circles_avx2(float origin_x, float origin_y, float direction_x, float direction_y, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance) {
+    const glm::vec2 direction = glm::normalize(glm::vec2(direction_x, direction_y));
+    const __m256 ox = _mm256_set1_ps(origin_x);
+    const __m256 oy = _mm256_set1_ps(origin_y);
+    const __m256 dx = _mm256_set1_ps(direction.x);
+    const __m256 dy = _mm256_set1_ps(direction.y);
+    const __m256 max = _mm256_set1_ps(max_distance);
+    const __m256 no_hit = _mm256_set1_ps(FLT_MAX);
+    const __m256 zero = _mm256_setzero_ps();
+
+    __m256 nearest = no_hit;
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 offset_x = _mm256_sub_ps(_mm256_loadu_ps(center_x + i), ox);
+        const __m256 offset_y = _mm256_sub_ps(_mm256_loadu_ps(center_y + i), oy);
+        const __m256 r = _mm256_loadu_ps(radius + i);
+        const __m256 radius_squared = _mm256_mul_ps(r, r);
+
+        const __m256 t = _mm256_add_ps(_mm256_mul_ps(offset_x, dx), _mm256_mul_ps(offset_y, dy));
+        const __m256 center_squared = _mm256_add_ps(_mm256_mul_ps(offset_x, offset_x), _mm256_mul_ps(offset_y, offset_y));
+        const __m256 perpendicular_squared = _mm256_sub_ps(center_squared, _mm256_mul_ps(t, t));
+
+        const __m256 inside = _mm256_cmp_ps(center_squared, radius_squared, _CMP_LE_OQ);
+        const __m256 hit = _mm256_or_ps(inside, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(perpendicular_squared, radius_squared, _CMP_LE_OQ)));
+        const __m256 entry = _mm256_sub_ps(t, _mm256_sqrt_ps(_mm256_max_ps(_mm256_sub_ps(radius_squared, perpendicular_squared), zero)));
+        const __m256 hit_distance = _mm256_blendv_ps(entry, zero, inside);
+
+        const __m256 mask = _mm256_and_ps(hit, _mm256_cmp_ps(hit_distance, max, _CMP_LE_OQ));
+        nearest = _mm256_min_ps(nearest, _mm256_blendv_ps(no_hit, hit_distance, mask));
+    }
+
+    return ray_circles_tail(origin_x, origin_y, direction, center_x + i, center_y + i, radius + i, count - i, max_distance, horizontal_min_avx2(nearest), distance);
+}
+
+#endif // SIMD_X86
+
+const Kernels SCALAR_KERNELS = {Isa::Scalar, separation_scalar, truncate_scalar, integrate_scalar, ray_circles_scalar};
+
+#if SIMD_X86
+const Kernels SSE41_KERNELS = {Isa::SSE41, separation_sse41, truncate_sse41, integrate_sse41, ray_circles_sse41};
+const Kernels AVX2_KERNELS = {Isa::AVX2, separation_avx2, truncate_avx2, integrate_avx2, ray_circles_avx2};
+#endif
+
+// Deterministic data for verify.
+struct VerifyRandom {
+    uint32_t state = 0x12345678;
+
+    float next(float min, float max) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return min + (max - min) * ((float)(state >> 8) / (float)(1 << 24));
+    }
+};
+
+bool within_tolerance(float value, float expected, float magnitude) {
+    return fabsf(value - expected) <= VERIFY_TOLERANCE * (1.0f + magnitude);
+}
+
+} // namespace
+
+namespace simd {
+
+bool supported(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return true;
+#if SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    case Isa::SSE41: {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0;
+    }
+    case Isa::AVX2: {
+        int info[4];
+        __cpuid(info, 0);
+        const int max_leaf = info[0];
+
+        // AVX needs both the CPU and the OS saving the ymm registers.
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (max_leaf < 7 || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+#else
+    case Isa::SSE41:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.1");
+    case Isa::AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+#endif
+    default:
+        return false;
+    }
+}
+
+Isa best_isa() {
+    if (supported(Isa::AVX2)) {
+        return Isa::AVX2;
+    }
+
+    if (supported(Isa::SSE41)) {
+        return Isa::SSE41;
+    }
+
+    return Isa::Scalar;
+}
+
+const Kernels &kernels(Isa isa) {
+    assert(supported(isa));
+
+    switch (isa) {
+#if SIMD_X86
+    case Isa::SSE41:
+        return SSE41_KERNELS;
+    case Isa::AVX2:
+        return AVX2_KERNELS;
+#endif
+    default:
+        return SCALAR_KERNELS;
+    }
+}
+
+const Kernels &best_kernels() {
+    static const Kernels &best = kernels(best_isa());
+    return best;
+}
+
+bool parse_isa(const char *name, Isa &isa) {
+    if (strcmp(name, "scalar") == 0) {
+        isa = Isa::Scalar;
+    } else if (strcmp(name, "sse41") == 0) {
+        isa = Isa::SSE41;
+    } else if (strcmp(name, "avx2") == 0) {
+        isa = Isa::AVX2;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+const char *isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::SSE41:
+        return "sse41";
+    case Isa::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+bool verify(const Kernels &kernels) {
+    // Not a multiple of any vector width, so the scalar tails are covered too.
+    const uint32_t count = 67;
+    const float near_distance = 40.0f;
+    const float mass = 100.0f;
+    const float max_force = 1000.0f;
+    const float max_speed = 300.0f;
+    const float dt = 1.0f / 60.0f;
+
+    VerifyRandom random;
+
+    float x[count];
+    float y[count];
+    float velocity_x[count];
+    float velocity_y[count];
+    float steering_x[count];
+    float steering_y[count];
+    float drag[count];
+
+    for (uint32_t i = 0; i < count; ++i) {
+        x[i] = random.next(-60.0f, 60.0f);
+        y[i] = random.next(-60.0f, 60.0f);
+        velocity_x[i] = random.next(-400.0f, 400.0f);
+        velocity_y[i] = random.next(-400.0f, 400.0f);
+        steering_x[i] = random.next(-2000.0f, 2000.0f);
+        steering_y[i] = random.next(-2000.0f, 2000.0f);
+        drag[i] = random.next(0.0f, 1.0f) < 0.2f ? 10.0f : 1.0f;
+    }
+
+    // A few vectors that truncate must leave alone.
+    steering_x[3] = steering_y[3] = 0.0f;
+    velocity_x[5] = velocity_y[5] = 0.0f;
+
+    // separation
+    {
+        glm::vec2 expected = {0.0f, 0.0f};
+        float magnitude = 0.0f;
+        for (uint32_t i = 0; i < count; ++i) {
+            glm::vec2 offset = glm::vec2(x[i], y[i]) - glm::vec2(1.0f, -2.0f);
+            if (glm::length2(offset) <= near_distance * near_distance) {
+                offset /= glm::length(offset);
+                offset *= near_distance;
+                expected -= offset;
+                magnitude += near_distance;
+            }
+        }
+
+        float force_x = 0.0f;
+        float force_y = 0.0f;
+        kernels.separation(1.0f, -2.0f, near_distance, x, y, count, &force_x, &force_y);
+
+        if (!within_tolerance(force_x, expected.x, magnitude) || !within_tolerance(force_y, expected.y, magnitude)) {
+            return false;
+        }
+    }
+
+    // truncate
+    {
+        float truncated_x[count];
+        float truncated_y[count];
+        memcpy(truncated_x, steering_x, sizeof(truncated_x));
+        memcpy(truncated_y, steering_y, sizeof(truncated_y));
+        kernels.truncate(truncated_x, truncated_y, count, max_force);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const glm::vec2 expected = truncate({steering_x[i], steering_y[i]}, max_force);
+            if (!within_tolerance(truncated_x[i], expected.x, max_force) || !within_tolerance(truncated_y[i], expected.y, max_force)) {
+                return false;
+            }
+        }
+    }
+
+    // integrate
+    {
+        float new_x[count];
+        float new_y[count];
+        float new_velocity_x[count];
+        float new_velocity_y[count];
+        memcpy(new_x, x, sizeof(new_x));
+        memcpy(new_y, y, sizeof(new_y));
+        memcpy(new_velocity_x, velocity_x, sizeof(new_velocity_x));
+        memcpy(new_velocity_y, velocity_y, sizeof(new_velocity_y));
+        kernels.integrate(new_x, new_y, new_velocity_x, new_velocity_y, steering_x, steering_y, drag, count, mass, max_force, max_speed, dt);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            glm::vec2 velocity = {velocity_x[i], velocity_y[i]};
+            const glm::vec2 drag_force = -drag[i] * velocity;
+            const glm::vec2 steering_force = truncate({steering_x[i], steering_y[i]}, max_force) + drag_force;
+            velocity = truncate(velocity + steering_force / mass, max_speed);
+            const glm::vec2 position = glm::vec2(x[i], y[i]) + velocity * dt;
+
+            if (!within_tolerance(new_velocity_x[i], velocity.x, max_speed) || !within_tolerance(new_velocity_y[i], velocity.y, max_speed) || !within_tolerance(new_x[i], position.x, glm::length(position)) || !within_tolerance(new_y[i], position.y, glm::length(position))) {
+                return false;
+            }
+        }
+    }
+
+    // ray_circles
+    {
+        const float max_distance = 200.0f;
+
+        float center_x[count];
+        float center_y[count];
+        float radius[count];
+        for (uint32_t i = 0; i < count; ++i) {
+            center_x[i] = random.next(-300.0f, 300.0f);
+            center_y[i] = random.next(-300.0f, 300.0f);
+            radius[i] = random.next(5.0f, 60.0f);
+        }
+
+        // One ray starting inside a circle, and rays with every count of circles so the vector loops and their tails
+        // both pick the nearest hit.
+        center_x[count - 1] = 1.0f;
+        center_y[count - 1] = 1.0f;
+
+        for (uint32_t ray = 0; ray < count; ++ray) {
+            const glm::vec2 origin = ray == 0 ? glm::vec2(0.0f, 0.0f) : glm::vec2(random.next(-300.0f, 300.0f), random.next(-300.0f, 300.0f));
+            const glm::vec2 direction = {random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f)};
+            const uint32_t ray_count = ray == 0 ? count : ray + 1;
+            const uint32_t first = count - ray_count;
+
+            float expected = FLT_MAX;
+            for (uint32_t i = first; i < count; ++i) {
+                glm::vec2 intersection;
+                if (ray_circle_intersection(origin, direction, {center_x[i], center_y[i]}, radius[i], intersection)) {
+                    const float hit_distance = glm::length(intersection - origin);
+                    if (hit_distance <= max_distance && hit_distance < expected) {
+                        expected = hit_distance;
+                    }
+                }
+            }
+
+            float hit_distance = FLT_MAX;
+            const bool hit = kernels.ray_circles(origin.x, origin.y, direction.x, direction.y, center_x + first, center_y + first, radius + first, ray_count, max_distance, &hit_distance);
+
+            if (hit != (expected != FLT_MAX) || (hit && !within_tolerance(hit_distance, expected, max_distance))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace simd
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace simd {
+
+/**
+ * @brief The instruction sets that kernels are compiled for.
+ *
+ */
+enum class Isa {
+    Scalar,
+    SSE41,
+    AVX2,
+};
+
+/**
+ * @brief Mob math over structure of arrays data, compiled for one instruction set.
+ *
+ * Every kernel handles any count, the tail that doesn't fill a whole vector is done with scalar math.
+ */
+struct Kernels {
+    Isa isa;
+
+    // Subtracts the separation offset from (x, y) to every mob within near_distance from the force.
+    // The arrays must not contain the mob at (x, y) itself.
+    void (*separation)(float x, float y, float near_distance, const float *others_x, const float *others_y, uint32_t count, float *force_x, float *force_y);
+
+    // Truncates every vector to max_length.
+    void (*truncate)(float *x, float *y, uint32_t count, float max_length);
+
+    // Applies steering and drag to the velocities and moves the positions, the same as update_mob.
+    void (*integrate)(float *position_x, float *position_y, float *velocity_x, float *velocity_y, const float *steering_x, const float *steering_y, const float *drag, uint32_t count, float mass, float max_force, float max_speed, float dt);
+
+    // Finds the nearest hit of a ray on the circles within max_distance, the same as ray_circles_intersection.
+    bool (*ray_circles)(float origin_x, float origin_y, float direction_x, float direction_y, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance);
+};
+
+/**
+ * @brief Whether the running CPU supports an instruction set.
+ *
+ * @param isa The instruction set.
+ * @return true If kernels for the instruction set can run.
+ */
+bool supported(Isa isa);
+
+/**
+ * @brief The widest instruction set the running CPU supports.
+ *
+ * @return Isa The instruction set.
+ */
+Isa best_isa();
+
+/**
+ * @brief The kernels for an instruction set, which must be supported.
+ *
+ * @param isa The instruction set.
+ * @return const Kernels& The kernels.
+ */
+const Kernels &kernels(Isa isa);
+
+/**
+ * @brief The kernels for the widest instruction set the running CPU supports, looked up once.
+ *
+ * @return const Kernels& The kernels.
+ */
+const Kernels &best_kernels();
+
+/**
+ * @brief Parses an instruction set from its name, one of scalar, sse41, or avx2.
+ *
+ * @param name The name.
+ * @param isa The parsed instruction set.
+ * @return true If the name was valid.
+ */
+bool parse_isa(const char *name, Isa &isa);
+
+/**
+ * @brief The name of an instruction set.
+ *
+ * @param isa The instruction set.
+ * @return const char* The name.
+ */
+const char *isa_name(Isa isa);
+
+/**
+ * @brief Runs the kernels on generated data and compares them with the glm implementation.
+ *
+ * Results may differ by VERIFY_TOLERANCE relative to their magnitude, since the vector kernels multiply by
+ * reciprocals where the glm path divides, sum separation offsets in a different order, and find ray hits from
+ * squared distances where the glm path takes lengths.
+ *
+ * @param kernels The kernels to verify.
+ * @return true If every result is within the tolerance.
+ */
+bool verify(const Kernels &kernels);
+
+// Relative tolerance used by verify.
+const float VERIFY_TOLERANCE = 0.0001f;
+
+} // namespace simd
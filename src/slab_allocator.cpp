@@ -0,0 +1,144 @@
+#include "slab_allocator.h"
+
+#include <engine/log.h>
+
+#include <array.h>
+#include <memory.h>
+
+#include <inttypes.h>
+#include <string.h>
+
+namespace {
+// The size class of a small block.
+uint32_t size_class(size_t size) {
+    return (uint32_t)((size - 1) / game::SLAB_ALLOCATOR_GRANULARITY);
+}
+
+// The size of the blocks of a size class.
+uint32_t class_size(uint32_t index) {
+    return (index + 1) * game::SLAB_ALLOCATOR_GRANULARITY;
+}
+
+// Takes a block from a size class, allocating a new chunk for it when the free list and the last chunk are empty.
+void *allocate_small(game::SlabAllocator &slab, uint32_t index) {
+    game::SlabClass &slab_class = slab.classes[index];
+
+    if (slab_class.free_list) {
+        void *p = slab_class.free_list;
+        slab_class.free_list = *static_cast<void **>(p);
+        return p;
+    }
+
+    const uint32_t size = class_size(index);
+    if (!slab_class.next || slab_class.next + size > slab_class.end) {
+        char *chunk = static_cast<char *>(slab.backing.allocate(game::SLAB_ALLOCATOR_CHUNK_SIZE, game::SLAB_ALLOCATOR_GRANULARITY));
+        if (!chunk) {
+            return nullptr;
+        }
+
+        foundation::array::push_back(slab.chunks, (void *)chunk);
+        slab_class.next = chunk;
+        slab_class.end = chunk + game::SLAB_ALLOCATOR_CHUNK_SIZE;
+    }
+
+    void *p = slab_class.next;
+    slab_class.next += size;
+    return p;
+}
+
+// Puts a block back on the free list of its size class.
+void deallocate_small(game::SlabAllocator &slab, void *p, uint32_t index) {
+    game::SlabClass &slab_class = slab.classes[index];
+    *static_cast<void **>(p) = slab_class.free_list;
+    slab_class.free_list = p;
+}
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+SlabAllocator::SlabAllocator(Allocator &backing, CountingAllocator *counting)
+: backing(backing)
+, counting(counting)
+, chunks(backing)
+, small_allocations(0)
+, large_allocations(0)
+, in_place(0) {
+    memset(classes, 0, sizeof(classes));
+}
+
+SlabAllocator::~SlabAllocator() {
+    for (void **it = array::begin(chunks); it != array::end(chunks); ++it) {
+        backing.deallocate(*it);
+    }
+}
+
+namespace slab_allocator {
+
+void *allocate(SlabAllocator &slab, size_t size) {
+    if (size > SLAB_ALLOCATOR_MAX_SIZE) {
+        ++slab.large_allocations;
+        return slab.backing.allocate((uint32_t)size, SLAB_ALLOCATOR_GRANULARITY);
+    }
+
+    ++slab.small_allocations;
+    void *p = allocate_small(slab, size_class(size));
+    if (p && slab.counting) {
+        counting_allocator::add_allocation(*slab.counting, (uint32_t)size);
+    }
+
+    return p;
+}
+
+void deallocate(SlabAllocator &slab, void *p, size_t size) {
+    if (size > SLAB_ALLOCATOR_MAX_SIZE) {
+        slab.backing.deallocate(p);
+        return;
+    }
+
+    deallocate_small(slab, p, size_class(size));
+    if (slab.counting) {
+        counting_allocator::add_free(*slab.counting);
+    }
+}
+
+void *reallocate(SlabAllocator &slab, void *p, size_t old_size, size_t new_size) {
+    if (!p) {
+        return allocate(slab, new_size);
+    }
+
+    const bool old_small = old_size <= SLAB_ALLOCATOR_MAX_SIZE;
+    const bool new_small = new_size <= SLAB_ALLOCATOR_MAX_SIZE;
+
+    // A small block can only stay within its class, since it's freed by the size it was last given.
+    if (old_small && new_small && size_class(old_size) == size_class(new_size)) {
+        ++slab.in_place;
+        return p;
+    }
+
+    // The backing allocator frees a large block without its size, so it can shrink in place, as long as that doesn't
+    // keep much more memory than asked for.
+    if (!old_small && !new_small && new_size <= old_size && new_size >= old_size / 2) {
+        ++slab.in_place;
+        return p;
+    }
+
+    void *new_p = allocate(slab, new_size);
+    if (!new_p) {
+        return nullptr;
+    }
+
+    memcpy(new_p, p, old_size < new_size ? old_size : new_size);
+    deallocate(slab, p, old_size);
+
+    return new_p;
+}
+
+void log(const SlabAllocator &slab) {
+    log_info("Slab allocator: %u chunks of %u bytes, %" PRIu64 " small and %" PRIu64 " large allocations, %" PRIu64 " resized in place",
+             array::size(slab.chunks), SLAB_ALLOCATOR_CHUNK_SIZE, slab.small_allocations, slab.large_allocations, slab.in_place);
+}
+
+} // namespace slab_allocator
+
+} // namespace game
@@ -0,0 +1,116 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "counting_allocator.h"
+#include "memory_types.h"
+#include "util.h"
+#include <stddef.h>
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+// Size classes are multiples of this, which is also the alignment of every block.
+const uint32_t SLAB_ALLOCATOR_GRANULARITY = 16;
+
+// Largest block handed out from a slab, larger ones go to the backing allocator.
+const uint32_t SLAB_ALLOCATOR_MAX_SIZE = 256;
+
+// Number of size classes, one for every multiple of the granularity up to the max size.
+const uint32_t SLAB_ALLOCATOR_CLASSES = SLAB_ALLOCATOR_MAX_SIZE / SLAB_ALLOCATOR_GRANULARITY;
+
+// Bytes allocated from the backing allocator at a time, and carved into blocks of one size class.
+const uint32_t SLAB_ALLOCATOR_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * @brief The blocks of one size class.
+ *
+ */
+struct SlabClass {
+    // Blocks that have been freed, linked through their first bytes.
+    void *free_list;
+
+    // The part of the last chunk that hasn't been handed out yet.
+    char *next;
+    char *end;
+};
+
+/**
+ * @brief Hands out small blocks from chunks split into size classes, for callers that know the size of what they free.
+ *
+ * This fits the Lua allocation function, which is told the old size of every block it frees or resizes. Blocks of up
+ * to SLAB_ALLOCATOR_MAX_SIZE bytes are rounded up to their size class and taken from its free list, or carved from
+ * its last chunk, so they never reach the backing allocator. Larger blocks are allocated from the backing allocator.
+ * Freed small blocks go back on their free list, and the chunks are only returned when the allocator is destroyed.
+ *
+ * Small blocks never reach a CountingAllocator, so when counting is set every small block handed out or freed is
+ * counted for it, and allocation counts stay comparable with allocating every block from the backing allocator.
+ */
+struct SlabAllocator {
+    SlabAllocator(foundation::Allocator &backing, CountingAllocator *counting);
+    ~SlabAllocator();
+    DELETE_COPY_AND_MOVE(SlabAllocator)
+
+    foundation::Allocator &backing;
+
+    // Where the small blocks are counted, nullptr to not count them.
+    CountingAllocator *counting;
+
+    // Every chunk allocated from the backing allocator.
+    foundation::Array<void *> chunks;
+
+    SlabClass classes[SLAB_ALLOCATOR_CLASSES];
+
+    // Number of blocks handed out from a slab, and from the backing allocator.
+    uint64_t small_allocations;
+    uint64_t large_allocations;
+
+    // Number of resizes that kept the block where it was.
+    uint64_t in_place;
+};
+
+namespace slab_allocator {
+
+/**
+ * @brief Allocates a block.
+ *
+ * @param slab The allocator.
+ * @param size The size of the block, which must be positive.
+ * @return void* The block, nullptr if the backing allocator is out of memory.
+ */
+void *allocate(SlabAllocator &slab, size_t size);
+
+/**
+ * @brief Frees a block.
+ *
+ * @param slab The allocator.
+ * @param p The block.
+ * @param size The size the block was allocated or last resized with.
+ */
+void deallocate(SlabAllocator &slab, void *p, size_t size);
+
+/**
+ * @brief Resizes a block, keeping its contents up to the smaller of the two sizes.
+ *
+ * A block stays where it is when the new size has the same size class, and a large block stays where it is when it
+ * shrinks to at least half its size and is still too large for a slab.
+ *
+ * @param slab The allocator.
+ * @param p The block, nullptr to allocate a new one.
+ * @param old_size The size the block was allocated or last resized with, ignored when p is nullptr.
+ * @param new_size The size of the block, which must be positive.
+ * @return void* The resized block, nullptr if the backing allocator is out of memory.
+ */
+void *reallocate(SlabAllocator &slab, void *p, size_t old_size, size_t new_size);
+
+/**
+ * @brief Logs the chunks and the blocks handed out so far.
+ *
+ * @param slab The allocator.
+ */
+void log(const SlabAllocator &slab);
+
+} // namespace slab_allocator
+
+} // namespace game
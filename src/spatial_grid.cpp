@@ -0,0 +1,99 @@
+#include "spatial_grid.h"
+
+#include <array.h>
+
+#include <float.h>
+#include <string.h>
+
+namespace {
+// Keeps the grid bounded when points scatter far outside the window, by growing the cells instead.
+const uint32_t MAX_CELLS_PER_AXIS = 1024;
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+SpatialGrid::SpatialGrid(Allocator &allocator)
+: cell_size(1.0f)
+, origin({0.0f, 0.0f})
+, columns(0)
+, rows(0)
+, entries(allocator)
+, cell_starts(allocator)
+, indices(allocator) {}
+
+namespace spatial_grid {
+
+void clear(SpatialGrid &grid, float cell_size) {
+    assert(cell_size > 0.0f);
+
+    grid.cell_size = cell_size;
+    grid.origin = {0.0f, 0.0f};
+    grid.columns = 0;
+    grid.rows = 0;
+    array::clear(grid.entries);
+    array::clear(grid.cell_starts);
+    array::clear(grid.indices);
+}
+
+void insert(SpatialGrid &grid, uint32_t index, glm::vec2 position) {
+    array::push_back(grid.entries, {position, index});
+}
+
+void commit(SpatialGrid &grid) {
+    const uint32_t count = array::size(grid.entries);
+    if (count == 0) {
+        return;
+    }
+
+    glm::vec2 min = {FLT_MAX, FLT_MAX};
+    glm::vec2 max = {-FLT_MAX, -FLT_MAX};
+    for (const SpatialGrid::Entry *entry = array::begin(grid.entries); entry != array::end(grid.entries); ++entry) {
+        min = glm::min(min, entry->position);
+        max = glm::max(max, entry->position);
+    }
+
+    const glm::vec2 extent = max - min;
+    const float largest_extent = extent.x > extent.y ? extent.x : extent.y;
+    if (largest_extent / grid.cell_size >= (float)MAX_CELLS_PER_AXIS) {
+        grid.cell_size = largest_extent / (float)(MAX_CELLS_PER_AXIS - 1);
+    }
+
+    grid.origin = min;
+    grid.columns = (uint32_t)(extent.x / grid.cell_size) + 1;
+    grid.rows = (uint32_t)(extent.y / grid.cell_size) + 1;
+
+    auto cell_of = [&grid](glm::vec2 position) {
+        uint32_t x = (uint32_t)((position.x - grid.origin.x) / grid.cell_size);
+        uint32_t y = (uint32_t)((position.y - grid.origin.y) / grid.cell_size);
+        x = x < grid.columns ? x : grid.columns - 1;
+        y = y < grid.rows ? y : grid.rows - 1;
+        return y * grid.columns + x;
+    };
+
+    // Counting sort. Each cell first counts up to its end, then is filled backwards down to its start,
+    // which keeps indices in insertion order within a cell.
+    const uint32_t cell_count = grid.columns * grid.rows;
+    array::resize(grid.cell_starts, cell_count + 1);
+    memset(array::begin(grid.cell_starts), 0, sizeof(uint32_t) * (cell_count + 1));
+
+    for (const SpatialGrid::Entry *entry = array::begin(grid.entries); entry != array::end(grid.entries); ++entry) {
+        ++grid.cell_starts[cell_of(entry->position)];
+    }
+
+    for (uint32_t i = 1; i < cell_count; ++i) {
+        grid.cell_starts[i] += grid.cell_starts[i - 1];
+    }
+
+    grid.cell_starts[cell_count] = count;
+    array::resize(grid.indices, count);
+
+    for (uint32_t i = count; i > 0; --i) {
+        const SpatialGrid::Entry &entry = grid.entries[i - 1];
+        grid.indices[--grid.cell_starts[cell_of(entry.position)]] = entry.index;
+    }
+}
+
+} // namespace spatial_grid
+
+} // namespace game
@@ -0,0 +1,211 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <float.h>
+#include <glm/glm.hpp>
+#include <math.h>
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief A uniform grid over a set of points, rebuilt from scratch whenever the points move.
+ *
+ * Points are inserted with an index into whatever array the caller keeps them in, and committed
+ * into a counting sort by cell. The grid only stores indices, so queries return candidates that
+ * the caller tests against its own, possibly updated, positions.
+ */
+struct SpatialGrid {
+    struct Entry {
+        glm::vec2 position;
+        uint32_t index;
+    };
+
+    SpatialGrid(foundation::Allocator &allocator);
+    ~SpatialGrid(){};
+    DELETE_COPY_AND_MOVE(SpatialGrid)
+
+    // The side of a cell.
+    float cell_size;
+
+    // The lower left corner of the first cell.
+    glm::vec2 origin;
+
+    uint32_t columns;
+    uint32_t rows;
+
+    // Points inserted since the last clear.
+    foundation::Array<Entry> entries;
+
+    // The start of each cell in indices, with one extra element for the end of the last cell.
+    foundation::Array<uint32_t> cell_starts;
+
+    // Inserted indices sorted by cell.
+    foundation::Array<uint32_t> indices;
+};
+
+namespace spatial_grid {
+
+/**
+ * @brief Clears the grid and sets the cell size for the next commit.
+ *
+ * @param grid The grid to clear.
+ * @param cell_size The side of a cell, typically the largest interaction distance.
+ */
+void clear(SpatialGrid &grid, float cell_size);
+
+/**
+ * @brief Inserts a point into the grid, which is not queryable until it's committed.
+ *
+ * @param grid The grid to insert into.
+ * @param index The index of the point in the caller's array.
+ * @param position The position of the point.
+ */
+void insert(SpatialGrid &grid, uint32_t index, glm::vec2 position);
+
+/**
+ * @brief Sorts the inserted points into their cells.
+ *
+ * @param grid The grid to commit.
+ */
+void commit(SpatialGrid &grid);
+
+/**
+ * @brief Calls the callback with the index of every point in the cells overlapping the square around a position.
+ *
+ * Candidates are not filtered by distance, and an index is visited at most once.
+ *
+ * @param grid The committed grid to query.
+ * @param position The center of the query.
+ * @param distance The half side of the query square.
+ * @param callback Called with each candidate index.
+ */
+template <typename F>
+void query(const SpatialGrid &grid, glm::vec2 position, float distance, F callback) {
+    if (grid.columns == 0 || grid.rows == 0) {
+        return;
+    }
+
+    const int32_t x0 = (int32_t)floorf((position.x - distance - grid.origin.x) / grid.cell_size);
+    const int32_t x1 = (int32_t)floorf((position.x + distance - grid.origin.x) / grid.cell_size);
+    const int32_t y0 = (int32_t)floorf((position.y - distance - grid.origin.y) / grid.cell_size);
+    const int32_t y1 = (int32_t)floorf((position.y + distance - grid.origin.y) / grid.cell_size);
+
+    if (x1 < 0 || y1 < 0 || x0 >= (int32_t)grid.columns || y0 >= (int32_t)grid.rows) {
+        return;
+    }
+
+    const uint32_t min_x = x0 < 0 ? 0 : (uint32_t)x0;
+    const uint32_t max_x = x1 >= (int32_t)grid.columns ? grid.columns - 1 : (uint32_t)x1;
+    const uint32_t min_y = y0 < 0 ? 0 : (uint32_t)y0;
+    const uint32_t max_y = y1 >= (int32_t)grid.rows ? grid.rows - 1 : (uint32_t)y1;
+
+    for (uint32_t y = min_y; y <= max_y; ++y) {
+        // Cells in a row are contiguous, so a whole span of the row is one run of indices.
+        const uint32_t begin = grid.cell_starts[y * grid.columns + min_x];
+        const uint32_t end = grid.cell_starts[y * grid.columns + max_x + 1];
+        for (uint32_t i = begin; i < end; ++i) {
+            callback(grid.indices[i]);
+        }
+    }
+}
+
+/**
+ * @brief Finds the k points nearest to a position, searching rings of cells outward from the position's cell.
+ *
+ * The distance callback measures each candidate, so the caller can measure from positions that have moved since
+ * the commit, and skip points by returning FLT_MAX. The search stops once no point in the cells left can be
+ * nearer than the k found, which holds as long as no point has moved further than drift since it was inserted.
+ *
+ * @param grid The committed grid to query.
+ * @param position The center of the search.
+ * @param drift How far any point may have moved since the commit.
+ * @param k The number of points to find.
+ * @param distance Called with a candidate index, returns its distance from the position or FLT_MAX to skip it.
+ * @param nearest Receives up to k indices, nearest first.
+ * @param nearest_distances Receives the distance of each index in nearest.
+ * @return uint32_t The number of points found, which is less than k if there weren't enough.
+ */
+template <typename F>
+uint32_t k_nearest(const SpatialGrid &grid, glm::vec2 position, float drift, uint32_t k, F distance, uint32_t *nearest, float *nearest_distances) {
+    if (grid.columns == 0 || grid.rows == 0 || k == 0) {
+        return 0;
+    }
+
+    uint32_t found = 0;
+
+    // Keeps the nearest sorted by moving farther ones up to make room.
+    auto consider = [&](uint32_t index) {
+        const float d = distance(index);
+        if (d == FLT_MAX || (found == k && d >= nearest_distances[k - 1])) {
+            return;
+        }
+
+        uint32_t slot = found < k ? found++ : k - 1;
+        for (; slot > 0 && nearest_distances[slot - 1] > d; --slot) {
+            nearest[slot] = nearest[slot - 1];
+            nearest_distances[slot] = nearest_distances[slot - 1];
+        }
+
+        nearest[slot] = index;
+        nearest_distances[slot] = d;
+    };
+
+    // Visits a span of cells in a row, which is one run of indices.
+    auto visit = [&](int32_t y, int32_t x0, int32_t x1) {
+        x0 = x0 < 0 ? 0 : x0;
+        x1 = x1 >= (int32_t)grid.columns ? (int32_t)grid.columns - 1 : x1;
+        if (x0 > x1) {
+            return;
+        }
+
+        const uint32_t begin = grid.cell_starts[y * grid.columns + x0];
+        const uint32_t end = grid.cell_starts[y * grid.columns + x1 + 1];
+        for (uint32_t i = begin; i < end; ++i) {
+            consider(grid.indices[i]);
+        }
+    };
+
+    // The position's cell, which may be outside the grid.
+    const int32_t x = (int32_t)floorf((position.x - grid.origin.x) / grid.cell_size);
+    const int32_t y = (int32_t)floorf((position.y - grid.origin.y) / grid.cell_size);
+
+    for (int32_t ring = 0;; ++ring) {
+        const int32_t x0 = x - ring;
+        const int32_t x1 = x + ring;
+        const int32_t y0 = y - ring;
+        const int32_t y1 = y + ring;
+
+        const int32_t min_y = y0 < 0 ? 0 : y0;
+        const int32_t max_y = y1 >= (int32_t)grid.rows ? (int32_t)grid.rows - 1 : y1;
+        for (int32_t row = min_y; row <= max_y; ++row) {
+            if (row == y0 || row == y1) {
+                visit(row, x0, x1);
+            } else {
+                visit(row, x0, x0);
+                if (x1 != x0) {
+                    visit(row, x1, x1);
+                }
+            }
+        }
+
+        if (x0 <= 0 && y0 <= 0 && x1 >= (int32_t)grid.columns - 1 && y1 >= (int32_t)grid.rows - 1) {
+            break;
+        }
+
+        // Points in cells outside the rings searched so far were inserted at least ring cells away.
+        if (found == k && nearest_distances[k - 1] <= (float)ring * grid.cell_size - drift) {
+            break;
+        }
+    }
+
+    return found;
+}
+
+} // namespace spatial_grid
+
+} // namespace game
@@ -0,0 +1,63 @@
+#include "sprite_transforms.h"
+
+#include <engine/math.inl>
+#include <engine/sprites.h>
+
+#include <array.h>
+
+namespace game {
+using namespace foundation;
+
+void transform_sprites(engine::Sprites &sprites, const uint64_t *sprite_ids, const float *x, const float *y, const float *scale_x, const float *scale_y, const float *z, uint32_t count) {
+    // Column major, the same as glm::scale(glm::translate(glm::mat4(1.0f), {x, y, z}), {scale_x, scale_y, 1.0f}).
+    float m[16] = {
+        0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f};
+
+    for (uint32_t i = 0; i < count; ++i) {
+        m[0] = scale_x[i];
+        m[5] = scale_y[i];
+        m[12] = x[i];
+        m[13] = y[i];
+        m[14] = z[i];
+        engine::transform_sprite(sprites, sprite_ids[i], math::Matrix4f(m));
+    }
+}
+
+SpriteTransforms::SpriteTransforms(Allocator &allocator)
+: sprite_id(allocator)
+, x(allocator)
+, y(allocator)
+, scale_x(allocator)
+, scale_y(allocator)
+, z(allocator) {}
+
+namespace sprite_transforms {
+
+void add(SpriteTransforms &transforms, uint64_t sprite_id, glm::vec2 position, glm::vec2 scale, float z) {
+    array::push_back(transforms.sprite_id, sprite_id);
+    array::push_back(transforms.x, position.x);
+    array::push_back(transforms.y, position.y);
+    array::push_back(transforms.scale_x, scale.x);
+    array::push_back(transforms.scale_y, scale.y);
+    array::push_back(transforms.z, z);
+}
+
+void commit(SpriteTransforms &transforms, engine::Sprites &sprites) {
+    transform_sprites(sprites, array::begin(transforms.sprite_id), array::begin(transforms.x), array::begin(transforms.y),
+                      array::begin(transforms.scale_x), array::begin(transforms.scale_y), array::begin(transforms.z),
+                      array::size(transforms.sprite_id));
+
+    array::clear(transforms.sprite_id);
+    array::clear(transforms.x);
+    array::clear(transforms.y);
+    array::clear(transforms.scale_x);
+    array::clear(transforms.scale_y);
+    array::clear(transforms.z);
+}
+
+} // namespace sprite_transforms
+
+} // namespace game
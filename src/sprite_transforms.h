@@ -0,0 +1,74 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace engine {
+struct Sprites;
+} // namespace engine
+
+namespace game {
+
+/**
+ * @brief Transforms a batch of sprites, each translated to a position and depth and scaled in x and y.
+ *
+ * The 2D affine transform is written straight into the sprite's matrix, without building and multiplying a
+ * glm::mat4 per sprite.
+ *
+ * @param sprites The sprites to transform.
+ * @param sprite_ids The id of each sprite.
+ * @param x The x position of each sprite.
+ * @param y The y position of each sprite.
+ * @param scale_x The x scale of each sprite, negative to flip it.
+ * @param scale_y The y scale of each sprite, negative to flip it.
+ * @param z The depth of each sprite.
+ * @param count The number of sprites.
+ */
+void transform_sprites(engine::Sprites &sprites, const uint64_t *sprite_ids, const float *x, const float *y, const float *scale_x, const float *scale_y, const float *z, uint32_t count);
+
+/**
+ * @brief Sprite transforms queued up to be applied at once with transform_sprites.
+ *
+ */
+struct SpriteTransforms {
+    SpriteTransforms(foundation::Allocator &allocator);
+    ~SpriteTransforms(){};
+    DELETE_COPY_AND_MOVE(SpriteTransforms)
+
+    foundation::Array<uint64_t> sprite_id;
+    foundation::Array<float> x;
+    foundation::Array<float> y;
+    foundation::Array<float> scale_x;
+    foundation::Array<float> scale_y;
+    foundation::Array<float> z;
+};
+
+namespace sprite_transforms {
+
+/**
+ * @brief Queues a sprite transform, which is applied when the transforms are committed.
+ *
+ * @param transforms The transforms to add to.
+ * @param sprite_id The id of the sprite.
+ * @param position The position of the sprite.
+ * @param scale The scale of the sprite, negative to flip it.
+ * @param z The depth of the sprite.
+ */
+void add(SpriteTransforms &transforms, uint64_t sprite_id, glm::vec2 position, glm::vec2 scale, float z);
+
+/**
+ * @brief Applies every queued transform in order, and clears them.
+ *
+ * @param transforms The transforms to commit.
+ * @param sprites The sprites to transform.
+ */
+void commit(SpriteTransforms &transforms, engine::Sprites &sprites);
+
+} // namespace sprite_transforms
+
+} // namespace game
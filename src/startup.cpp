@@ -0,0 +1,125 @@
+#include "startup.h"
+#include "profiler.h"
+
+#include <engine/log.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace {
+// Every phase recorded, in the order they started.
+game::StartupPhase phases[game::STARTUP_MAX_PHASES];
+uint32_t phase_count = 0;
+
+// The phases that are running, innermost last. Phases that were dropped are -1.
+int32_t running[game::STARTUP_MAX_DEPTH];
+uint32_t running_count = 0;
+
+// Phases begun past STARTUP_MAX_DEPTH, which end without popping anything.
+uint32_t overflow_count = 0;
+
+// When startup::start was called.
+uint64_t start_ns = 0;
+
+// Time from startup::start to the end of the first frame, 0 until it has ended.
+uint64_t first_frame_ns = 0;
+
+uint64_t elapsed_ns() {
+    return game::profiler::now_ns() - start_ns;
+}
+} // namespace
+
+namespace game {
+
+StartupScope::StartupScope(const char *name) {
+    startup::begin(name);
+}
+
+StartupScope::~StartupScope() {
+    startup::end();
+}
+
+namespace startup {
+
+void start() {
+    phase_count = 0;
+    running_count = 0;
+    overflow_count = 0;
+    first_frame_ns = 0;
+    start_ns = profiler::now_ns();
+}
+
+void begin(const char *name) {
+    if (running_count >= STARTUP_MAX_DEPTH) {
+        ++overflow_count;
+        return;
+    }
+
+    if (phase_count >= STARTUP_MAX_PHASES) {
+        running[running_count++] = -1;
+        return;
+    }
+
+    StartupPhase &phase = phases[phase_count];
+    phase.name = name;
+    phase.depth = running_count;
+    phase.start_ns = elapsed_ns();
+    phase.ns = 0;
+
+    running[running_count++] = (int32_t)phase_count++;
+}
+
+void end() {
+    if (overflow_count > 0) {
+        --overflow_count;
+        return;
+    }
+
+    if (running_count == 0) {
+        return;
+    }
+
+    const int32_t index = running[--running_count];
+    if (index >= 0) {
+        phases[index].ns = elapsed_ns() - phases[index].start_ns;
+    }
+}
+
+void first_frame() {
+    if (first_frame_ns == 0) {
+        first_frame_ns = elapsed_ns();
+    }
+}
+
+void log() {
+    for (uint32_t i = 0; i < phase_count; ++i) {
+        const StartupPhase &phase = phases[i];
+        log_info("%*s%-*s %10.3f ms", (int)(phase.depth * 2), "", (int)(40 - phase.depth * 2), phase.name, (double)phase.ns / 1000000.0);
+    }
+
+    if (first_frame_ns) {
+        log_info("Time to first frame: %.3f ms", (double)first_frame_ns / 1000000.0);
+    }
+}
+
+bool write_json(const char *backend, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    fprintf(file, "{\"backend\":\"%s\",\"first_frame_ns\":%" PRIu64 ",\"phases\":[", backend, first_frame_ns);
+    for (uint32_t i = 0; i < phase_count; ++i) {
+        const StartupPhase &phase = phases[i];
+        fprintf(file, "%s{\"name\":\"%s\",\"depth\":%u,\"start_ns\":%" PRIu64 ",\"ns\":%" PRIu64 "}", i ? "," : "", phase.name, phase.depth,
+                phase.start_ns, phase.ns);
+    }
+    fprintf(file, "]}\n");
+
+    fclose(file);
+    return true;
+}
+
+} // namespace startup
+
+} // namespace game
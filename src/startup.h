@@ -0,0 +1,94 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "util.h"
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+// Most startup phases recorded, the ones after are dropped.
+const uint32_t STARTUP_MAX_PHASES = 64;
+
+// Deepest nesting of startup phases.
+const uint32_t STARTUP_MAX_DEPTH = 8;
+
+/**
+ * @brief A timed part of starting the game.
+ *
+ */
+struct StartupPhase {
+    // The name of the phase, which must outlive the recording.
+    const char *name;
+
+    // Number of phases this one is nested in.
+    uint32_t depth;
+
+    // When the phase started, in nanoseconds since startup::start.
+    uint64_t start_ns;
+
+    // How long the phase took.
+    uint64_t ns;
+};
+
+/**
+ * @brief Records a startup phase from its construction to its destruction.
+ *
+ */
+struct StartupScope {
+    StartupScope(const char *name);
+    ~StartupScope();
+    DELETE_COPY_AND_MOVE(StartupScope)
+};
+
+/**
+ * @brief Times the phases of starting the game, from main to the end of the first frame.
+ *
+ * The phases are kept in static storage, since the first ones run before any allocator exists, and must be recorded
+ * on the main thread.
+ */
+namespace startup {
+
+/**
+ * @brief Starts the clock the phases and the first frame are measured from.
+ *
+ */
+void start();
+
+/**
+ * @brief Starts a phase, nested in the phase that's running.
+ *
+ * @param name The name of the phase, which must outlive the recording.
+ */
+void begin(const char *name);
+
+/**
+ * @brief Ends the phase started last.
+ *
+ */
+void end();
+
+/**
+ * @brief Records the time to the end of the first frame, only the first call counts.
+ *
+ */
+void first_frame();
+
+/**
+ * @brief Logs every phase, indented by its nesting, and the time to the first frame.
+ *
+ */
+void log();
+
+/**
+ * @brief Writes every phase and the time to the first frame as a JSON object.
+ *
+ * @param backend The name of the gameplay implementation.
+ * @param path The file to write.
+ * @return bool Whether the file could be written.
+ */
+bool write_json(const char *backend, const char *path);
+
+} // namespace startup
+
+} // namespace game
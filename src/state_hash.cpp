@@ -0,0 +1,215 @@
+#include "state_hash.h"
+
+#include <engine/log.h>
+
+#include <murmur_hash.h>
+
+#include <math.h>
+#include <string.h>
+
+namespace {
+// Identifies a state hash file.
+const char STATE_HASH_MAGIC[8] = {'G', 'S', 'T', 'A', 'T', 'E', '0', '1'};
+
+// The name of every game::StateRecordKind.
+const char *RECORD_KIND_NAMES[] = {
+    "lion",
+    "food",
+    "giraffe",
+    "end of frame",
+};
+
+// A float as an integer that's the same for every value within the tolerance, or its bits without one.
+int64_t quantize(float value, float tolerance) {
+    if (tolerance > 0.0f) {
+        return (int64_t)llround((double)value / (double)tolerance);
+    }
+
+    // 0 and -0 compare equal, so they hash the same.
+    if (value == 0.0f) {
+        return 0;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (int64_t)bits;
+}
+
+void add_record(game::StateHasher &hasher, game::StateRecordKind kind, uint32_t id, const float *values, uint32_t count) {
+    if (!hasher.file) {
+        return;
+    }
+
+    int64_t quantized[8];
+    assert(count <= 8);
+    for (uint32_t i = 0; i < count; ++i) {
+        quantized[i] = quantize(values[i], hasher.tolerance);
+    }
+
+    game::StateRecord record;
+    record.kind = kind;
+    record.id = id;
+    record.hash = foundation::murmur_hash_64(quantized, (uint32_t)(count * sizeof(int64_t)), ((uint64_t)kind << 32) | id);
+
+    hasher.frame_hash = foundation::murmur_hash_64(&record, sizeof(record), hasher.frame_hash);
+    fwrite(&record, sizeof(record), 1, hasher.file);
+}
+
+const char *record_name(const game::StateRecord &record) {
+    const uint32_t kind = (uint32_t)record.kind;
+    return kind < sizeof(RECORD_KIND_NAMES) / sizeof(RECORD_KIND_NAMES[0]) ? RECORD_KIND_NAMES[kind] : "unknown record";
+}
+
+FILE *open_for_diff(const char *path, game::StateHashHeader &header) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        log_info("Could not open %s", path);
+        return nullptr;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, STATE_HASH_MAGIC, sizeof(STATE_HASH_MAGIC)) != 0) {
+        log_info("%s is not a state hash file", path);
+        fclose(file);
+        return nullptr;
+    }
+
+    return file;
+}
+} // namespace
+
+namespace game {
+
+StateHasher::StateHasher()
+: file(nullptr)
+, tolerance(0.0f)
+, frame(0)
+, frame_hash(0) {}
+
+namespace state_hash {
+
+bool open(StateHasher &hasher, const char *path, float tolerance) {
+    close(hasher);
+
+    hasher.file = fopen(path, "wb");
+    if (!hasher.file) {
+        return false;
+    }
+
+    hasher.tolerance = tolerance;
+    hasher.frame = 0;
+    hasher.frame_hash = 0;
+
+    StateHashHeader header;
+    memcpy(header.magic, STATE_HASH_MAGIC, sizeof(STATE_HASH_MAGIC));
+    header.tolerance = tolerance;
+    header.reserved = 0;
+    fwrite(&header, sizeof(header), 1, hasher.file);
+
+    return true;
+}
+
+void close(StateHasher &hasher) {
+    if (hasher.file) {
+        fclose(hasher.file);
+        hasher.file = nullptr;
+    }
+}
+
+void lion(StateHasher &hasher, float x, float y, float velocity_x, float velocity_y, float energy) {
+    const float values[] = {x, y, velocity_x, velocity_y, energy};
+    add_record(hasher, StateRecordKind::Lion, 0, values, 5);
+}
+
+void food(StateHasher &hasher, float x, float y) {
+    const float values[] = {x, y};
+    add_record(hasher, StateRecordKind::Food, 0, values, 2);
+}
+
+void giraffe(StateHasher &hasher, uint32_t id, bool dead, float x, float y, float velocity_x, float velocity_y) {
+    if (dead) {
+        add_record(hasher, StateRecordKind::Giraffe, id, nullptr, 0);
+    } else {
+        const float values[] = {x, y, velocity_x, velocity_y};
+        add_record(hasher, StateRecordKind::Giraffe, id, values, 4);
+    }
+}
+
+void end_frame(StateHasher &hasher) {
+    if (!hasher.file) {
+        return;
+    }
+
+    StateRecord record;
+    record.kind = StateRecordKind::EndFrame;
+    record.id = hasher.frame;
+    record.hash = hasher.frame_hash;
+    fwrite(&record, sizeof(record), 1, hasher.file);
+
+    ++hasher.frame;
+    hasher.frame_hash = 0;
+}
+
+int diff(const char *path_a, const char *path_b) {
+    StateHashHeader header_a;
+    StateHashHeader header_b;
+
+    FILE *file_a = open_for_diff(path_a, header_a);
+    if (!file_a) {
+        return 2;
+    }
+
+    FILE *file_b = open_for_diff(path_b, header_b);
+    if (!file_b) {
+        fclose(file_a);
+        return 2;
+    }
+
+    if (header_a.tolerance != header_b.tolerance) {
+        log_info("The runs were hashed with different tolerances, %f and %f, and can't match", header_a.tolerance, header_b.tolerance);
+    }
+
+    int status = 0;
+    uint32_t frame = 0;
+
+    for (;;) {
+        StateRecord a;
+        StateRecord b;
+        const bool has_a = fread(&a, sizeof(a), 1, file_a) == 1;
+        const bool has_b = fread(&b, sizeof(b), 1, file_b) == 1;
+
+        if (!has_a && !has_b) {
+            log_info("The runs match for all %u frames", frame);
+            break;
+        }
+
+        if (!has_a || !has_b) {
+            log_info("The runs match for %u frames, after which only %s goes on", frame, has_a ? path_a : path_b);
+            status = 1;
+            break;
+        }
+
+        if (a.kind != b.kind || a.id != b.id) {
+            log_info("The runs diverge at frame %u, where %s has %s %u and %s has %s %u", frame, path_a, record_name(a), a.id, path_b, record_name(b), b.id);
+            status = 1;
+            break;
+        }
+
+        if (a.hash != b.hash) {
+            log_info("The runs diverge at frame %u, in %s %u", frame, record_name(a), a.id);
+            status = 1;
+            break;
+        }
+
+        if (a.kind == StateRecordKind::EndFrame) {
+            ++frame;
+        }
+    }
+
+    fclose(file_a);
+    fclose(file_b);
+    return status;
+}
+
+} // namespace state_hash
+
+} // namespace game
@@ -0,0 +1,142 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "util.h"
+#include <stdint.h>
+#include <stdio.h>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief What a StateRecord hashes.
+ *
+ */
+enum class StateRecordKind : uint32_t {
+    Lion,
+    Food,
+    Giraffe,
+
+    // Closes a frame, with the frame number as id and the hash of every record in the frame.
+    EndFrame,
+};
+
+/**
+ * @brief A hashed entity in a state hash file, which is a StateHashHeader followed by the records of every frame.
+ *
+ * Every frame has the lion, the food, and the giraffes in order of their id, and then an EndFrame record.
+ */
+struct StateRecord {
+    StateRecordKind kind;
+    uint32_t id;
+    uint64_t hash;
+};
+
+/**
+ * @brief The start of a state hash file.
+ *
+ */
+struct StateHashHeader {
+    char magic[8];
+
+    // The tolerance floats were quantized to, 0 if their bits were hashed.
+    float tolerance;
+
+    uint32_t reserved;
+};
+
+/**
+ * @brief Hashes the simulation state every frame and writes the hashes to a file, so two runs can be compared.
+ *
+ * The gameplay implementation hands over its entities with the state_hash functions, and game::hash_state ends the frame.
+ */
+struct StateHasher {
+    StateHasher();
+    ~StateHasher(){};
+    DELETE_COPY_AND_MOVE(StateHasher)
+
+    // The file being written, nullptr when not hashing.
+    FILE *file;
+
+    // When above 0, floats are rounded to a multiple of this before hashing, so runs within it hash the same.
+    float tolerance;
+
+    // The frame being hashed.
+    uint32_t frame;
+
+    // The hash of the records of the frame so far.
+    uint64_t frame_hash;
+};
+
+namespace state_hash {
+
+/**
+ * @brief Starts writing the hashes of every frame to a file.
+ *
+ * @param hasher The hasher.
+ * @param path The file to write.
+ * @param tolerance Quantizes floats to multiples of this before hashing them, 0 hashes their bits.
+ * @return bool Whether the file could be opened.
+ */
+bool open(StateHasher &hasher, const char *path, float tolerance);
+
+/**
+ * @brief Stops hashing and closes the file.
+ *
+ * @param hasher The hasher.
+ */
+void close(StateHasher &hasher);
+
+/**
+ * @brief Hashes the lion, which comes first in every frame.
+ *
+ * @param hasher The hasher.
+ * @param x The lion's x position.
+ * @param y The lion's y position.
+ * @param velocity_x The lion's x velocity.
+ * @param velocity_y The lion's y velocity.
+ * @param energy The lion's energy.
+ */
+void lion(StateHasher &hasher, float x, float y, float velocity_x, float velocity_y, float energy);
+
+/**
+ * @brief Hashes the food, which comes after the lion.
+ *
+ * @param hasher The hasher.
+ * @param x The food's x position.
+ * @param y The food's y position.
+ */
+void food(StateHasher &hasher, float x, float y);
+
+/**
+ * @brief Hashes a giraffe, which come after the food in order of their id.
+ *
+ * @param hasher The hasher.
+ * @param id The giraffe's id, which is the number of giraffes spawned before it.
+ * @param dead Whether the giraffe has been killed, in which case its position and velocity aren't hashed.
+ * @param x The giraffe's x position.
+ * @param y The giraffe's y position.
+ * @param velocity_x The giraffe's x velocity.
+ * @param velocity_y The giraffe's y velocity.
+ */
+void giraffe(StateHasher &hasher, uint32_t id, bool dead, float x, float y, float velocity_x, float velocity_y);
+
+/**
+ * @brief Writes the hash of the frame and starts the next one.
+ *
+ * @param hasher The hasher.
+ */
+void end_frame(StateHasher &hasher);
+
+/**
+ * @brief Compares two state hash files and logs the first frame and entity where they differ.
+ *
+ * @param path_a The first file.
+ * @param path_b The second file.
+ * @return int 0 if the runs are the same, 1 if they differ, and 2 if a file couldn't be read.
+ */
+int diff(const char *path_a, const char *path_b);
+
+} // namespace state_hash
+
+} // namespace game
@@ -0,0 +1,121 @@
+#include "thread_pool.h"
+
+#include <array.h>
+#include <memory.h>
+
+namespace {
+
+// The range of a thread, where thread 0 is the caller of parallel_for.
+void range(uint32_t count, uint32_t num_threads, uint32_t thread_index, uint32_t &begin, uint32_t &end) {
+    begin = (uint32_t)(((uint64_t)count * thread_index) / num_threads);
+    end = (uint32_t)(((uint64_t)count * (thread_index + 1)) / num_threads);
+}
+
+void worker_main(game::ThreadPool *pool, uint32_t thread_index) {
+    uint64_t seen_generation = 0;
+
+    for (;;) {
+        game::ThreadPool::Job job = nullptr;
+        void *context = nullptr;
+        uint32_t count = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->work_available.wait(lock, [pool, seen_generation] { return pool->quit || pool->generation != seen_generation; });
+
+            if (pool->quit) {
+                return;
+            }
+
+            seen_generation = pool->generation;
+            job = pool->job;
+            context = pool->context;
+            count = pool->count;
+        }
+
+        uint32_t begin, end;
+        range(count, pool->num_threads, thread_index, begin, end);
+        if (begin < end) {
+            job(context, begin, end);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            if (--pool->pending == 0) {
+                pool->work_done.notify_one();
+            }
+        }
+    }
+}
+
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+ThreadPool::ThreadPool(Allocator &allocator, uint32_t num_threads)
+: allocator(allocator)
+, workers(allocator)
+, num_threads(num_threads > 0 ? num_threads : 1)
+, job(nullptr)
+, context(nullptr)
+, count(0)
+, generation(0)
+, pending(0)
+, quit(false) {
+    for (uint32_t i = 1; i < this->num_threads; ++i) {
+        std::thread *worker = MAKE_NEW(allocator, std::thread, worker_main, this, i);
+        array::push_back(workers, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+
+    work_available.notify_all();
+
+    for (std::thread **worker = array::begin(workers); worker != array::end(workers); ++worker) {
+        (*worker)->join();
+        MAKE_DELETE(allocator, thread, *worker);
+    }
+}
+
+namespace thread_pool {
+
+void parallel_for(ThreadPool &pool, uint32_t count, ThreadPool::Job job, void *context) {
+    if (array::empty(pool.workers)) {
+        if (count > 0) {
+            job(context, 0, count);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.job = job;
+        pool.context = context;
+        pool.count = count;
+        pool.pending = array::size(pool.workers);
+        ++pool.generation;
+    }
+
+    pool.work_available.notify_all();
+
+    uint32_t begin, end;
+    range(count, pool.num_threads, 0, begin, end);
+    if (begin < end) {
+        job(context, begin, end);
+    }
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.work_done.wait(lock, [&pool] { return pool.pending == 0; });
+    pool.job = nullptr;
+    pool.context = nullptr;
+}
+
+} // namespace thread_pool
+
+} // namespace game
@@ -0,0 +1,68 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#pragma warning(pop)
+
+namespace game {
+
+/**
+ * @brief A fixed set of worker threads that split ranges of work with the calling thread.
+ *
+ */
+struct ThreadPool {
+    // The function called with each [begin, end) range, and the context handed to parallel_for.
+    typedef void (*Job)(void *context, uint32_t begin, uint32_t end);
+
+    ThreadPool(foundation::Allocator &allocator, uint32_t num_threads);
+    ~ThreadPool();
+    DELETE_COPY_AND_MOVE(ThreadPool)
+
+    foundation::Allocator &allocator;
+
+    // The workers, the calling thread works on the first range so there's one fewer of these than num_threads.
+    foundation::Array<std::thread *> workers;
+    uint32_t num_threads;
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    // The job being run and its context, only valid while pending is above zero.
+    Job job;
+    void *context;
+    uint32_t count;
+
+    // Increased for every job, so workers can tell a new job from a spurious wakeup.
+    uint64_t generation;
+
+    // Workers that haven't finished the current job.
+    uint32_t pending;
+
+    bool quit;
+};
+
+namespace thread_pool {
+
+/**
+ * @brief Splits [0, count) into one contiguous range per thread and calls the job with each, on the workers and the calling thread.
+ *
+ * The ranges only depend on the count and the number of threads. Returns when every range is done. The job is a plain
+ * function and a context instead of a type erased callable, so starting one never allocates.
+ *
+ * @param pool The thread pool.
+ * @param count The number of items.
+ * @param job The function to call with each range.
+ * @param context Handed to every call of the job.
+ */
+void parallel_for(ThreadPool &pool, uint32_t count, ThreadPool::Job job, void *context);
+
+} // namespace thread_pool
+
+} // namespace game
@@ -0,0 +1,124 @@
+#include "trace.h"
+#include "profiler.h"
+
+#include <array.h>
+#include <memory.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+namespace {
+// The buffer the calling thread records into, and the tracer it belongs to.
+thread_local game::TraceBuffer *thread_buffer = nullptr;
+thread_local const game::Tracer *thread_buffer_tracer = nullptr;
+
+game::TraceBuffer &buffer_for_thread(game::Tracer &tracer) {
+    if (thread_buffer_tracer != &tracer) {
+        std::lock_guard<std::mutex> lock(tracer.mutex);
+
+        game::TraceBuffer *buffer = MAKE_NEW(tracer.allocator, game::TraceBuffer);
+        buffer->thread_id = foundation::array::size(tracer.buffers);
+        buffer->count = 0;
+        foundation::array::push_back(tracer.buffers, buffer);
+
+        thread_buffer = buffer;
+        thread_buffer_tracer = &tracer;
+    }
+
+    return *thread_buffer;
+}
+
+void record(game::Tracer &tracer, const char *name, char phase) {
+    game::TraceBuffer &buffer = buffer_for_thread(tracer);
+    game::TraceEvent &event = buffer.events[buffer.count % game::TRACE_BUFFER_EVENTS];
+    event.name = name;
+    event.ns = game::profiler::now_ns() - tracer.start_ns;
+    event.phase = phase;
+    ++buffer.count;
+}
+} // namespace
+
+namespace game {
+using namespace foundation;
+
+Tracer::Tracer(Allocator &allocator)
+: allocator(allocator)
+, enabled(false)
+, path(nullptr)
+, start_ns(profiler::now_ns())
+, buffers(allocator) {}
+
+Tracer::~Tracer() {
+    for (TraceBuffer **buffer = array::begin(buffers); buffer != array::end(buffers); ++buffer) {
+        MAKE_DELETE(allocator, TraceBuffer, *buffer);
+    }
+}
+
+TraceScope::TraceScope(Tracer &tracer, const char *name)
+: tracer(tracer)
+, name(name)
+, recording(tracer.enabled) {
+    if (recording) {
+        trace::begin(tracer, name);
+    }
+}
+
+TraceScope::~TraceScope() {
+    if (recording) {
+        trace::end(tracer, name);
+    }
+}
+
+namespace trace {
+
+void begin(Tracer &tracer, const char *name) {
+    record(tracer, name, 'B');
+}
+
+void end(Tracer &tracer, const char *name) {
+    record(tracer, name, 'E');
+}
+
+bool write(Tracer &tracer, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(tracer.mutex);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    bool first = true;
+    for (TraceBuffer **it = array::begin(tracer.buffers); it != array::end(tracer.buffers); ++it) {
+        const TraceBuffer *buffer = *it;
+        const uint64_t start = buffer->count > TRACE_BUFFER_EVENTS ? buffer->count - TRACE_BUFFER_EVENTS : 0;
+
+        // Ends whose beginning was overwritten are left out, the viewers can't pair them with anything.
+        uint32_t depth = 0;
+
+        for (uint64_t i = start; i < buffer->count; ++i) {
+            const TraceEvent &event = buffer->events[i % TRACE_BUFFER_EVENTS];
+            if (event.phase == 'E') {
+                if (depth == 0) {
+                    continue;
+                }
+                --depth;
+            } else {
+                ++depth;
+            }
+
+            fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"pid\":1,\"tid\":%u}",
+                    first ? "" : ",", event.name, event.phase, event.ns / 1000, event.ns % 1000, buffer->thread_id);
+            first = false;
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return true;
+}
+
+} // namespace trace
+
+} // namespace game
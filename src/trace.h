@@ -0,0 +1,120 @@
+#pragma once
+
+#pragma warning(push, 0)
+#include "collection_types.h"
+#include "memory_types.h"
+#include "util.h"
+#include <mutex>
+#include <stdint.h>
+#pragma warning(pop)
+
+namespace game {
+
+// Number of events each thread keeps, older events are overwritten.
+const uint32_t TRACE_BUFFER_EVENTS = 65536;
+
+/**
+ * @brief The beginning or the end of a traced scope.
+ *
+ */
+struct TraceEvent {
+    // The name of the scope, which must outlive the tracer.
+    const char *name;
+
+    // When the event happened, in nanoseconds since the tracer was created.
+    uint64_t ns;
+
+    // 'B' for the beginning of a scope, 'E' for the end.
+    char phase;
+};
+
+/**
+ * @brief The ring buffer of events recorded on one thread.
+ *
+ */
+struct TraceBuffer {
+    // The thread the events were recorded on, numbered in the order threads record their first event.
+    uint32_t thread_id;
+
+    // Number of events recorded, the last TRACE_BUFFER_EVENTS of them are in events.
+    uint64_t count;
+
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+};
+
+/**
+ * @brief Records when traced scopes begin and end on every thread, to be written as Chrome trace event JSON.
+ *
+ * Each thread records into its own buffer without locking, the lock is only taken the first time a thread records.
+ */
+struct Tracer {
+    Tracer(foundation::Allocator &allocator);
+    ~Tracer();
+    DELETE_COPY_AND_MOVE(Tracer)
+
+    foundation::Allocator &allocator;
+
+    // Whether TraceScope records anything.
+    bool enabled;
+
+    // Where the trace is written when the game terminates or the TRACE action is pressed.
+    const char *path;
+
+    // The time events are relative to.
+    uint64_t start_ns;
+
+    // Guards buffers.
+    std::mutex mutex;
+
+    // The buffer of every thread that has recorded an event.
+    foundation::Array<TraceBuffer *> buffers;
+};
+
+/**
+ * @brief Records the beginning of a scope on construction and its end on destruction.
+ *
+ */
+struct TraceScope {
+    TraceScope(Tracer &tracer, const char *name);
+    ~TraceScope();
+    DELETE_COPY_AND_MOVE(TraceScope)
+
+    Tracer &tracer;
+    const char *name;
+
+    // Whether the beginning was recorded, so the end is recorded even if the tracer is disabled in between.
+    bool recording;
+};
+
+namespace trace {
+
+/**
+ * @brief Records the beginning of a scope on the calling thread.
+ *
+ * @param tracer The tracer.
+ * @param name The name of the scope, which must outlive the tracer.
+ */
+void begin(Tracer &tracer, const char *name);
+
+/**
+ * @brief Records the end of a scope on the calling thread.
+ *
+ * @param tracer The tracer.
+ * @param name The name of the scope, which must outlive the tracer.
+ */
+void end(Tracer &tracer, const char *name);
+
+/**
+ * @brief Writes the events of every thread as a Chrome trace event JSON file, for chrome://tracing or Perfetto.
+ *
+ * Must be called while no other thread is recording, such as between frames.
+ *
+ * @param tracer The tracer.
+ * @param path The file to write.
+ * @return bool Whether the file could be written.
+ */
+bool write(Tracer &tracer, const char *path);
+
+} // namespace trace
+
+} // namespace game
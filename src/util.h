@@ -2,7 +2,9 @@
 
 #include <array.h>
 #include <cassert>
+#include <float.h>
 #include <glm/glm.hpp>
+#include <math.h>
 
 // Deletes the copy constructor, the copy assignment operator, the move constructor, and the move assignment operator.
 #define DELETE_COPY_AND_MOVE(T)       \
@@ -40,6 +42,38 @@ inline bool ray_circle_intersection(const glm::vec2 ray_origin, const glm::vec2
     return false;
 }
 
+// Finds the nearest hit of a ray on count circles, stored as arrays of centers and radii, that's within max_distance.
+// A ray starting inside a circle hits it at distance 0. Returns false and leaves distance alone if nothing is hit.
+// The loop body has no branches so it maps onto vector lanes, simd::Kernels::ray_circles has the vectorized versions.
+inline bool ray_circles_intersection(const glm::vec2 ray_origin, const glm::vec2 ray_direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float &distance) {
+    const glm::vec2 ray_dir = glm::normalize(ray_direction);
+    float nearest = FLT_MAX;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const float offset_x = center_x[i] - ray_origin.x;
+        const float offset_y = center_y[i] - ray_origin.y;
+        const float radius_squared = radius[i] * radius[i];
+
+        // Distance along the ray to the point nearest the center, and the squared distance from that point to the center.
+        const float t = offset_x * ray_dir.x + offset_y * ray_dir.y;
+        const float center_squared = offset_x * offset_x + offset_y * offset_y;
+        const float perpendicular_squared = center_squared - t * t;
+
+        const bool inside = center_squared <= radius_squared;
+        const bool hit = inside || (t >= 0.0f && perpendicular_squared <= radius_squared);
+        const float hit_distance = inside ? 0.0f : t - sqrtf(fmaxf(radius_squared - perpendicular_squared, 0.0f));
+
+        nearest = hit && hit_distance <= max_distance && hit_distance < nearest ? hit_distance : nearest;
+    }
+
+    if (nearest == FLT_MAX) {
+        return false;
+    }
+
+    distance = nearest;
+    return true;
+}
+
 inline bool ray_line_intersection(const glm::vec2 ray_origin, const glm::vec2 ray_direction, const glm::vec2 p1, const glm::vec2 p2, glm::vec2 &intersection) {
     const glm::vec2 line_dir = p2 - p1;
     float det = ray_direction.x * (-line_dir.y) - ray_direction.y * (-line_dir.x);
@@ -89,6 +123,15 @@ void swap_pop(Array<T> &a, uint32_t index) {
     array::pop_back(a);
 }
 
+// Swaps the contents of two arrays, including their allocators.
+template <typename T>
+void swap(Array<T> &a, Array<T> &b) {
+    std::swap(a._allocator, b._allocator);
+    std::swap(a._size, b._size);
+    std::swap(a._capacity, b._capacity);
+    std::swap(a._data, b._data);
+}
+
 // Shifts the element at index to the end and pops it.
 // This will retain the order of the remaining elements.
 // This is at worst O(n) complexity.
@@ -5,6 +5,7 @@
 
 #include "game.h"
 #include "memory.h"
+#include "simd.h"
 #include "util.h"
 
 #include <engine/engine.h>
@@ -18,24 +19,48 @@
 #include <glm/gtx/norm.hpp>
 #include <glm/gtx/transform.hpp>
 
+namespace {
+// The allocator behind every allocation made by the Zig script.
+foundation::Allocator *zig_allocator = nullptr;
+} // namespace
+
 extern "C" {
 void script_enter(engine::Engine *engine, game::Game *game);
 void script_leave(engine::Engine *engine, game::Game *game);
 void script_on_input();
 void script_update(engine::Engine *engine, game::Game *game, float t, float dt);
+void script_interpolate(engine::Engine *engine, game::Game *game, float t, float dt, float alpha);
 void script_render(engine::Engine *engine, game::Game *game);
 void script_render_imgui(engine::Engine *engine, game::Game *game);
+void script_hash_state(engine::Engine *engine, game::Game *game);
+void script_bridge_bench(engine::Engine *engine, game::Game *game, uint32_t calls);
 
 void fatal(const char *text) {
     log_fatal(text);
 }
 
+void *Game_allocate(uint32_t size, uint32_t align) {
+    return zig_allocator->allocate(size, align);
+}
+
+void Game_deallocate(void *p) {
+    zig_allocator->deallocate(p);
+}
+
 Rect glfw_window_rect(const void *engine) {
     Rect r;
     memcpy(&r, &((engine::Engine *)engine)->window_rect, sizeof(math::Rect));
     return r;
 }
 
+uint32_t get_random_seed(const void *game) {
+    return ((game::Game *)game)->random_seed;
+}
+
+uint32_t get_initial_giraffes(const void *game) {
+    return ((game::Game *)game)->initial_giraffes;
+}
+
 void *get_sprites(const void *game) {
     return ((game::Game *)game)->sprites;
 }
@@ -44,6 +69,26 @@ void *get_atlas(const void *game) {
     return ((game::Game *)game)->sprites->atlas;
 }
 
+void Game_hash_lion(void *game, const Vector2f position, const Vector2f velocity, float energy) {
+    game::state_hash::lion(((game::Game *)game)->state_hasher, position.x, position.y, velocity.x, velocity.y, energy);
+}
+
+void Game_hash_food(void *game, const Vector2f position) {
+    game::state_hash::food(((game::Game *)game)->state_hasher, position.x, position.y);
+}
+
+void Game_hash_giraffe(void *game, uint32_t id, bool dead, const Vector2f position, const Vector2f velocity) {
+    game::state_hash::giraffe(((game::Game *)game)->state_hasher, id, dead, position.x, position.y, velocity.x, velocity.y);
+}
+
+void Game_bench_begin(void *game) {
+    game::bridge_bench::begin(((game::Game *)game)->bridge_bench);
+}
+
+void Game_bench_end(void *game, const char *primitive, uint32_t calls) {
+    game::bridge_bench::end(((game::Game *)game)->bridge_bench, primitive, calls);
+}
+
 Sprite Engine_add_sprite(void *sprites, const char *sprite_name, const Color4f color) {
     engine::Sprites *p_sprites = (engine::Sprites *)sprites;
     math::Color4f c;
@@ -73,6 +118,10 @@ void Engine_transform_sprite(const void *sprites, uint64_t sprite_id, const stru
     engine::transform_sprite(*(engine::Sprites *)sprites, sprite_id, m);
 }
 
+void Engine_transform_sprites(void *sprites, const uint64_t *sprite_ids, const float *x, const float *y, const float *scale_x, const float *scale_y, const float *z, uint32_t count) {
+    game::transform_sprites(*(engine::Sprites *)sprites, sprite_ids, x, y, scale_x, scale_y, z, count);
+}
+
 const AtlasFrame *Engine_atlas_frame(void *atlas, const char *sprite_name) {
     const engine::AtlasFrame *fr = engine::atlas_frame(*(engine::Atlas *)atlas, sprite_name);
     const AtlasFrame *r = (const AtlasFrame *)fr;
@@ -168,6 +217,10 @@ bool ray_circle_intersection_vec2(const Vector2f ray_origin, const Vector2f ray_
     return success;
 }
 
+bool ray_circles_intersection_vec2(const Vector2f ray_origin, const Vector2f ray_direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance) {
+    return simd::best_kernels().ray_circles(ray_origin.x, ray_origin.y, ray_direction.x, ray_direction.y, center_x, center_y, radius, count, max_distance, distance);
+}
+
 Color4f orange;
 Color4f blue;
 Color4f light_gray;
@@ -180,6 +233,8 @@ namespace zig {
 
 void initialize(foundation::Allocator &allocator) {
     log_info("Initializing Zig");
+
+    zig_allocator = &allocator;
     
     memcpy(&orange, &engine::color::pico8::orange, sizeof(Color4f));
     memcpy(&blue, &engine::color::pico8::blue, sizeof(Color4f));
@@ -196,10 +251,14 @@ void close() {
 namespace game {
 
 void game_state_playing_enter(engine::Engine &engine, Game &game) {
+    TraceScope trace_scope(game.tracer, "zig enter");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
     script_enter(&engine, &game);
 }
 
 void game_state_playing_leave(engine::Engine &engine, Game &game) {
+    TraceScope trace_scope(game.tracer, "zig leave");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
     script_leave(&engine, &game);
 }
 
@@ -207,17 +266,42 @@ void game_state_playing_on_input(engine::Engine &engine, Game &game, engine::Inp
 }
 
 void game_state_playing_update(engine::Engine &engine, Game &game, float t, float dt) {
+    ProfileScope scope(game.profiler, ProfilePhase::Update);
+    TraceScope trace_scope(game.tracer, "zig update");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
     script_update(&engine, &game, t, dt);
 }
 
+void game_state_playing_interpolate(engine::Engine &engine, Game &game, float t, float dt, float alpha) {
+    ProfileScope scope(game.profiler, ProfilePhase::Transforms);
+    TraceScope trace_scope(game.tracer, "zig interpolate");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
+    script_interpolate(&engine, &game, t, dt, alpha);
+}
+
 void game_state_playing_render(engine::Engine &engine, Game &game) {
+    ProfileScope scope(game.profiler, ProfilePhase::Render);
+    TraceScope trace_scope(game.tracer, "zig render");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
     script_render(&engine, &game);
 }
 
 void game_state_playing_render_imgui(engine::Engine &engine, Game &game) {
+    TraceScope trace_scope(game.tracer, "zig render_imgui");
+    ProfileScope script_scope(game.profiler, ProfilePhase::Script);
     script_render_imgui(&engine, &game);
 }
 
+void game_state_playing_hash_state(engine::Engine &engine, Game &game) {
+    TraceScope trace_scope(game.tracer, "zig hash_state");
+    script_hash_state(&engine, &game);
+}
+
+void game_state_playing_bridge_bench(engine::Engine &engine, Game &game, uint32_t calls) {
+    TraceScope trace_scope(game.tracer, "zig bridge_bench");
+    script_bridge_bench(&engine, &game, calls);
+}
+
 } // namespace game
 
 #endif
@@ -56,16 +56,29 @@ zig_extern struct Sprite {
 
 zig_extern void fatal(const char *text);
 
+zig_extern void *Game_allocate(uint32_t size, uint32_t align);
+zig_extern void Game_deallocate(void *p);
+
 zig_extern struct Rect glfw_window_rect(const void *engine);
 
+zig_extern uint32_t get_random_seed(const void *game);
+zig_extern uint32_t get_initial_giraffes(const void *game);
 zig_extern void *get_sprites(const void *game);
 zig_extern void *get_atlas(const void *game);
 
+zig_extern void Game_hash_lion(void *game, const struct Vector2f position, const struct Vector2f velocity, float energy);
+zig_extern void Game_hash_food(void *game, const struct Vector2f position);
+zig_extern void Game_hash_giraffe(void *game, uint32_t id, bool dead, const struct Vector2f position, const struct Vector2f velocity);
+
+zig_extern void Game_bench_begin(void *game);
+zig_extern void Game_bench_end(void *game, const char *primitive, uint32_t calls);
+
 zig_extern struct Sprite Engine_add_sprite(void *sprites, const char *sprite_name, const struct Color4f color);
 zig_extern void Engine_update_sprites(void *sprites, float t, float dt);
 zig_extern void Engine_commit_sprites(void *sprites);
 zig_extern void Engine_render_sprites(const void *engine, const void *sprites);
 zig_extern void Engine_transform_sprite(const void *sprites, uint64_t sprite_id, const struct Matrix4f transform);
+zig_extern void Engine_transform_sprites(void *sprites, const uint64_t *sprite_ids, const float *x, const float *y, const float *scale_x, const float *scale_y, const float *z, uint32_t count);
 
 zig_extern const struct AtlasFrame *Engine_atlas_frame(void *atlas, const char *sprite_name);
 
@@ -83,6 +96,7 @@ zig_extern float length_vec2(const struct Vector2f v);
 zig_extern float length2_vec2(const struct Vector2f v);
 
 zig_extern bool ray_circle_intersection_vec2(const struct Vector2f ray_origin, const struct Vector2f ray_direction, const struct Vector2f circle_center, float circle_radius, struct Vector2f *intersection);
+zig_extern bool ray_circles_intersection_vec2(const struct Vector2f ray_origin, const struct Vector2f ray_direction, const float *center_x, const float *center_y, const float *radius, uint32_t count, float max_distance, float *distance);
 
 zig_extern struct Color4f orange;
 zig_extern struct Color4f blue;